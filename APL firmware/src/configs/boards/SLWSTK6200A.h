@@ -32,7 +32,13 @@
 #define SPI_USART_RX_IEN                  USARTRF0_RX_IRQn
 #define SPI_CLK_ENABLE()                  CMU_ClockEnable(cmuClock_USARTRF0, true)
 #define SPI_CLK_DISABLE()                 CMU_ClockEnable(cmuClock_USARTRF0, false)
+#define SPI_USART_DMAREQ_TX               DMAREQ_USARTRF0_TXBL
+#define SPI_USART_DMAREQ_RX               DMAREQ_USARTRF0_RXDATAV
                                           
+/* AES */
+/*! RAM for the AES key cache, 14 keys of 36 bytes. */
+#define AES_KEY_CACHE_RAM_BUDGET             (512U)
+
 /** Because the wmbus_typedefs.h collides with definitions by EFM32 library,
     wmbus_typedefs.h should prefer using stdint.h. */
 #ifndef USE_STDINT
@@ -38,6 +38,8 @@
 #define SPI_USART_RX_IEN                 USART1_RX_IRQn
 #define SPI_CLK_ENABLE()                 CMU_ClockEnable(cmuClock_USART1, true)
 #define SPI_CLK_DISABLE()                CMU_ClockEnable(cmuClock_USART1, false)      
+#define SPI_USART_DMAREQ_TX              DMAREQ_USART1_TXBL
+#define SPI_USART_DMAREQ_RX              DMAREQ_USART1_RXDATAV
 
 
 /* USE USB exept for APL application, disable UART */
@@ -50,6 +52,10 @@
 #endif
 
 
+/* AES */
+/*! RAM for the AES key cache, 14 keys of 36 bytes. */
+#define AES_KEY_CACHE_RAM_BUDGET             (512U)
+
 /** Because the wmbus_typedefs.h collides with definitions by EFM32 library,
     wmbus_typedefs.h should prefer using stdint.h. */
 #ifndef USE_STDINT
@@ -40,14 +40,22 @@
 #define SPI_USART_RX_IEN                  USART0_RX_IRQn
 #define SPI_CLK_ENABLE()                  CMU_ClockEnable(cmuClock_USART0, true)
 #define SPI_CLK_DISABLE()                 CMU_ClockEnable(cmuClock_USART0, false)    
+#define SPI_USART_DMAREQ_TX               DMAREQ_USART0_TXBL
+#define SPI_USART_DMAREQ_RX               DMAREQ_USART0_RXDATAV
 
 /* UART */
 #define UART_USART_INTERFACE                 LEUART0
 #define UART_USART_PORT                      gpioPortD
 #define UART_USART_RX_PIN                    5
 #define UART_USART_TX_PIN                    4
+#define UART_USART_DMAREQ_RX                 DMAREQ_LEUART0_RXDATAV
+#define UART_USART_DMAREQ_TX                 DMAREQ_LEUART0_TXBL
 
 
+/* AES */
+/*! RAM for the AES key cache, 4 keys of 36 bytes. */
+#define AES_KEY_CACHE_RAM_BUDGET             (144U)
+
 /** Because the wmbus_typedefs.h collides with definitions by EFM32 library,
     wmbus_typedefs.h should prefer using stdint.h. */
 #ifndef USE_STDINT
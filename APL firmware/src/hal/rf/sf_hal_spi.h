@@ -20,6 +20,34 @@
 */
 /**@{*/
 
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+#ifndef SF_HAL_SPI_CTS_STATS_NUM
+/*! Number of commands the CTS statistics are kept for. Set to 0 to disable
+    the statistics. */
+#define SF_HAL_SPI_CTS_STATS_NUM      16U
+#endif /* SF_HAL_SPI_CTS_STATS_NUM */
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! Statistics of the time the transceiver takes to signal CTS (clear to
+    send) after a command, counting at SF_HAL_TMR_TIMESTAMP_FREQ. */
+typedef struct S_SF_HAL_SPI_CTS_STATS_T
+{
+  /*! Command of the entry, the first byte written after the chip select. */
+  uint8_t c_cmd;
+  /*! Number of times the command was followed by CTS. */
+  uint16_t i_count;
+  /*! Number of times the polling of CTS timed out after the command. */
+  uint16_t i_timeouts;
+  /*! Longest time until CTS. */
+  uint16_t i_max;
+  /*! Sum of all times until CTS. */
+  uint32_t l_total;
+
+} s_sf_hal_spi_ctsStats_t;
 
 /*==============================================================================
                          CALLBACKS
@@ -59,8 +87,9 @@ void sf_hal_spi_chipDeselect(void);
           This functions handles a data exchange operation at the SPI. It'll
           transmit _i_len_ bytes located at address _pc_dataWrite_ and
           simultaneously stores _i_len_ bytes received at address location
-          _pc_dataRead_. This function is non-blocking, uses ISRs for
-          handling the exchange and is meant to handle many data bytes.
+          _pc_dataRead_. This function is non-blocking, uses the DMA (or
+          ISRs if SPI_DMA_ENABLED is disabled) for handling the exchange and
+          is meant to handle many data bytes.
   @param  pc_dataWrite  Pointer to the data to be transmitted by writing to SPI.
   @param  pc_dataRead   Pointer where to store received data.
   @param  i_len         Number of bytes to be transmitted or received.
@@ -84,6 +113,29 @@ void sf_hal_spi_xfer(uint8_t *pc_dataWrite, uint8_t* pc_dataRead,
 uint8_t sf_hal_spi_xferBlock(uint8_t *pc_dataWrite, uint8_t *pc_dataRead,
                                  uint16_t i_len);
 
+/**
+  @brief  Counts a timeout of the CTS polling for the command sent last.
+          Called on the critical error of the RF driver.
+*/
+void sf_hal_spi_ctsTimeout(void);
+
+/**
+  @brief  Checks if a transfer of @ref sf_hal_spi_xfer is in progress or the
+          USART is still sending. Neither the DMA nor the USART operate in
+          EM2, see sf_hal_tmr_sleep().
+  @return Returns @c TRUE until the last byte has been shifted out.
+*/
+bool_t sf_hal_spi_isBusy(void);
+
+/**
+  @brief  Returns the CTS statistics of a command. The entries are assigned
+          in the order the commands are sent first.
+  @param  c_idx     Index of the entry.
+  @param  ps_stats  Pointer where to store the statistics.
+  @return Returns @c FALSE if the entry is not used.
+*/
+bool_t sf_hal_spi_getCtsStats(uint8_t c_idx, s_sf_hal_spi_ctsStats_t *ps_stats);
+
 
 
 /**@}*/
@@ -317,6 +317,53 @@
       Tx power from -130dBm (0x0) to 125dBm (0xFE).*/
   #define WMBUS_PHY_DEFAULT_TX_POWER          0x7D
 
+  /* Codecs and chip rates required by each mode. The ones of the modes
+     in WMBUS_MODE_SET are handled at runtime. */
+  /*! Mode S1 */
+  #define WMBUS_MODE_CODEC_S1           (WMBUS_PHY_RX_CODEC_MANCHESTER | \
+                                         WMBUS_PHY_TX_CODEC_NONE)
+  #define WMBUS_MODE_CHIPRATE_S1        (WMBUS_RF_RX_CHIPRATE_32768baud | \
+                                         WMBUS_RF_TX_CHIPRATE_NONE)
+  /*! Mode S2 */
+  #define WMBUS_MODE_CODEC_S2           (WMBUS_PHY_RX_CODEC_MANCHESTER | \
+                                         WMBUS_PHY_TX_CODEC_MANCHESTER)
+  #define WMBUS_MODE_CHIPRATE_S2        (WMBUS_RF_RX_CHIPRATE_32768baud | \
+                                         WMBUS_RF_TX_CHIPRATE_32768baud)
+  /*! Mode T1 */
+  #define WMBUS_MODE_CODEC_T1           (WMBUS_PHY_RX_CODEC_3OUTOF6 | \
+                                         WMBUS_PHY_TX_CODEC_NONE)
+  #define WMBUS_MODE_CHIPRATE_T1        (WMBUS_RF_RX_CHIPRATE_100000baud | \
+                                         WMBUS_RF_TX_CHIPRATE_NONE)
+  /*! Mode T2 */
+  #define WMBUS_MODE_CODEC_T2           (WMBUS_PHY_RX_CODEC_3OUTOF6 | \
+                                         WMBUS_PHY_TX_CODEC_MANCHESTER)
+  #define WMBUS_MODE_CHIPRATE_T2        (WMBUS_RF_RX_CHIPRATE_100000baud | \
+                                         WMBUS_RF_TX_CHIPRATE_32768baud)
+  /*! Mode N1 */
+  #define WMBUS_MODE_CODEC_N1           (WMBUS_PHY_RX_CODEC_NRZ_N | \
+                                         WMBUS_PHY_TX_CODEC_NONE)
+  #define WMBUS_MODE_CHIPRATE_N1        (WMBUS_RF_RX_CHIPRATE_N | \
+                                         WMBUS_RF_TX_CHIPRATE_NONE)
+  /*! Mode N2 */
+  #define WMBUS_MODE_CODEC_N2           (WMBUS_PHY_RX_CODEC_NRZ_N | \
+                                         WMBUS_PHY_TX_CODEC_NRZ_N)
+  #define WMBUS_MODE_CHIPRATE_N2        (WMBUS_RF_RX_CHIPRATE_N | \
+                                         WMBUS_RF_TX_CHIPRATE_N)
+  /*! Mode C1 */
+  #define WMBUS_MODE_CODEC_C1           (WMBUS_PHY_RX_CODEC_NRZ_C | \
+                                         WMBUS_PHY_RX_CODEC_3OUTOF6 | \
+                                         WMBUS_PHY_TX_CODEC_NONE)
+  #define WMBUS_MODE_CHIPRATE_C1        (WMBUS_RF_RX_CHIPRATE_100000baud | \
+                                         WMBUS_RF_TX_CHIPRATE_NONE)
+  /*! Mode C2 */
+  #define WMBUS_MODE_CODEC_C2           (WMBUS_PHY_RX_CODEC_NRZ_C | \
+                                         WMBUS_PHY_RX_CODEC_3OUTOF6 | \
+                                         WMBUS_PHY_TX_CODEC_NRZ_C | \
+                                         WMBUS_PHY_TX_CODEC_MANCHESTER)
+  #define WMBUS_MODE_CHIPRATE_C2        (WMBUS_RF_RX_CHIPRATE_100000baud | \
+                                         WMBUS_RF_TX_CHIPRATE_32768baud | \
+                                         WMBUS_RF_TX_CHIPRATE_50000baud)
+
 #endif /* != MODE_all */
 
 #endif /* __WMBUS_COLLECTOR_CONFIG_H__ */
@@ -0,0 +1,102 @@
+#ifndef __WMBUS_CODEC_API_H__
+#define __WMBUS_CODEC_API_H__
+
+/**
+  @file       wmbus_codec_api.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Line codes of the Wireless M-Bus.
+
+              Include before:
+              - wmbus_typedefs.h
+
+              Table driven encoding and decoding of the 3 out of 6 code of
+              mode T and the Manchester code of mode S, e.g. for drivers or
+              applications handling raw chip data of the radio. The chips
+              are packed MSB first, as sent on air.
+
+              3 out of 6 codes each nibble to 6 chips, thus 2 bytes to 3
+              bytes of chips. The last byte of an odd length takes 12 chips,
+              followed by 4 chips of the postamble. Manchester codes each bit
+              to 2 chips, a 0 to 10 and a 1 to 01.
+
+              None of the functions keeps a state, they may be called from
+              interrupts, e.g. to decode the chips read from the FIFO of the
+              radio. Decoding may be done in place: pc_data may be the same
+              as pc_chips. Longer telegrams can be handled in blocks as long
+              as each block but the last one decodes an even number of bytes
+              for 3 out of 6.
+*/
+
+/*! @defgroup WMBUS_CODEC Line Code Interface Description
+ *  This section describes the API for the STACKFORCE line codes.
+ *  @{
+ */
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! Number of chip bytes of i_len bytes coded 3 out of 6. */
+#define WMBUS_CODEC_3OUTOF6_LEN(i_len)      ((((i_len) * 3U) + 1U) / 2U)
+
+/*! Number of chip bytes of i_len bytes coded Manchester. */
+#define WMBUS_CODEC_MANCHESTER_LEN(i_len)   ((i_len) * 2U)
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+
+/*============================================================================*/
+/*!
+ * @brief  Encodes data using the 3 out of 6 code.
+ * @param pc_chips  Memory to write the chips to,
+ *                  WMBUS_CODEC_3OUTOF6_LEN(i_len) bytes.
+ * @param pc_data   Data to encode. Must not overlap pc_chips.
+ * @param i_len     Number of bytes to encode.
+ */
+/*============================================================================*/
+void wmbus_codec_3outof6_encode(uint8_t *pc_chips, const uint8_t *pc_data,
+                                uint16_t i_len);
+
+/*============================================================================*/
+/*!
+ * @brief  Decodes chips using the 3 out of 6 code.
+ * @param pc_data   Memory to write the data to, i_len bytes.
+ * @param pc_chips  Chips to decode, WMBUS_CODEC_3OUTOF6_LEN(i_len) bytes.
+ * @param i_len     Number of bytes to decode.
+ * @return          @ref FALSE if the chips contain an invalid code. The data
+ *                  is decoded completely anyway, invalid codes as 0x0.
+ */
+/*============================================================================*/
+bool_t wmbus_codec_3outof6_decode(uint8_t *pc_data, const uint8_t *pc_chips,
+                                  uint16_t i_len);
+
+/*============================================================================*/
+/*!
+ * @brief  Encodes data using the Manchester code.
+ * @param pc_chips  Memory to write the chips to,
+ *                  WMBUS_CODEC_MANCHESTER_LEN(i_len) bytes.
+ * @param pc_data   Data to encode. Must not overlap pc_chips.
+ * @param i_len     Number of bytes to encode.
+ */
+/*============================================================================*/
+void wmbus_codec_manchester_encode(uint8_t *pc_chips, const uint8_t *pc_data,
+                                   uint16_t i_len);
+
+/*============================================================================*/
+/*!
+ * @brief  Decodes chips using the Manchester code.
+ * @param pc_data   Memory to write the data to, i_len bytes.
+ * @param pc_chips  Chips to decode, WMBUS_CODEC_MANCHESTER_LEN(i_len) bytes.
+ * @param i_len     Number of bytes to decode.
+ * @return          @ref FALSE if the chips contain an invalid code. The data
+ *                  is decoded completely anyway.
+ */
+/*============================================================================*/
+bool_t wmbus_codec_manchester_decode(uint8_t *pc_data, const uint8_t *pc_chips,
+                                     uint16_t i_len);
+
+/*!@} end of WMBUS_CODEC */
+/******************************************************************************/
+
+#endif /* __WMBUS_CODEC_API_H__ */
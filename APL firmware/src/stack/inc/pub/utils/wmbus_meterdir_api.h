@@ -0,0 +1,130 @@
+#ifndef __WMBUS_METERDIR_API_H__
+#define __WMBUS_METERDIR_API_H__
+
+/**
+  @file       wmbus_meterdir_api.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Hashed directory of meter devices.
+
+              Include before:
+              - wmbus_typedefs.h
+              - wmbus_tlg_api.h
+
+              Resolves the address of a meter device to its id in constant
+              time instead of searching the meter list. The directory is an
+              open addressing hash table over the 8 byte address. It only
+              stores a 16 bit tag of the hash and the id of each meter, in
+              separate arrays. Thus a lookup probes a compact array of tags
+              and the address of a meter is only read back for the candidate
+              with a matching tag, e.g. from the meter list of the stack by
+              wmbus_apl_col_meterGetAddr():
+
+              wmbus_meterdir_init(wmbus_apl_col_meterGetAddr);
+              wmbus_meterdir_add(&s_addr, wmbus_apl_col_meterAdd(...).i_id);
+              i_meterId = wmbus_meterdir_get(&s_addr);
+
+              Each slot takes 4 bytes of RAM. To keep the probe sequences
+              short, METERDIR_SIZE should provide a third more slots than
+              meters are stored.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Stack specific includes */
+#include "wmbus_global.h"
+
+/*! @defgroup WMBUS_METERDIR Meter Directory Interface Description
+ *  This section describes the API for the STACKFORCE meter directory.
+ *  @{
+ */
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+#ifndef METERDIR_SIZE
+  /*! Number of slots of the directory, has to be a power of two. */
+  #define METERDIR_SIZE                 64U
+
+  #if (STZ_INFO && __SUPPORT_WARNINGS__)
+  #warning METERDIR_SIZE set to default value: 64
+  #endif /* STZ_INFO && __SUPPORT_WARNINGS__ */
+#endif /* METERDIR_SIZE */
+
+#if ((METERDIR_SIZE & (METERDIR_SIZE - 1U)) != 0U) || \
+    (METERDIR_SIZE < 2U) || (METERDIR_SIZE > 32768U)
+#error METERDIR_SIZE has to be a power of two in the range of 2 to 32768.
+#endif /* METERDIR_SIZE */
+
+/*! Returned by wmbus_meterdir_get() if the address is not known. */
+#define METERDIR_ID_INVALID             0xFFFFU
+
+/*==============================================================================
+                            TYPEDEFS
+==============================================================================*/
+/*!
+ * Reads the address of a meter device.
+ * @param i_meterId     Id of the meter device.
+ * @param ps_meterAddr  Memory to write the address to.
+ * @return              @ref FALSE if the id is not valid.
+ */
+typedef bool_t (*fp_meterdir_getAddr_t)(uint16_t i_meterId,
+                                        s_wmbus_addr_t *ps_meterAddr);
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+
+/*============================================================================*/
+/*!
+ * @brief  Initializes the directory and removes all entries.
+ * @param fp_getAddr  Function reading the address of a meter device. It is
+ *                    used to compare the candidates found by their tag.
+ */
+/*============================================================================*/
+void wmbus_meterdir_init(fp_meterdir_getAddr_t fp_getAddr);
+
+/*============================================================================*/
+/*!
+ * @brief  Adds a meter device to the directory. An existing entry of the
+ *         address is updated.
+ * @param ps_meterAddr  Address of the meter device.
+ * @param i_meterId     Id of the meter device. fp_getAddr has to return the
+ *                      address for it from now on.
+ * @return              @ref FALSE if the directory is full.
+ */
+/*============================================================================*/
+bool_t wmbus_meterdir_add(s_wmbus_addr_t *ps_meterAddr, uint16_t i_meterId);
+
+/*============================================================================*/
+/*!
+ * @brief  Removes a meter device from the directory. Has to be called before
+ *         the meter is removed from the list fp_getAddr reads from.
+ * @param ps_meterAddr  Address of the meter device.
+ * @return              @ref FALSE if the address is not known.
+ */
+/*============================================================================*/
+bool_t wmbus_meterdir_remove(s_wmbus_addr_t *ps_meterAddr);
+
+/*============================================================================*/
+/*!
+ * @brief  Looks up the id of a meter device.
+ * @param ps_meterAddr  Address of the meter device.
+ * @return              Id of the meter device, @ref METERDIR_ID_INVALID if
+ *                      the address is not known.
+ */
+/*============================================================================*/
+uint16_t wmbus_meterdir_get(s_wmbus_addr_t *ps_meterAddr);
+
+/*============================================================================*/
+/*!
+ * @brief  Returns the number of meter devices in the directory.
+ */
+/*============================================================================*/
+uint16_t wmbus_meterdir_getNum(void);
+
+/*!@} end of WMBUS_METERDIR */
+/******************************************************************************/
+
+#endif /* __WMBUS_METERDIR_API_H__ */
@@ -15,6 +15,8 @@
 #include "inc\prv\cfg\wmbus_config.h"
 #include "inc\pub\utils\wmbus_clock_api.h"
 #include "inc\pub\hal\wmbus_hal.h"
+#include "sf_hal_mem.h"
+#include "sf_hal_tmr.h"
 /* Include common APL API */
 #include "inc\pub\apl\wmbus_apl_api.h"
 /* Include meter device specific APL API functions */
@@ -101,6 +103,16 @@ void main(void)
     {
       /* run the application layer */
       wmbus_apl_mtr_run();
+
+      /* write pending data of the non-volatile memory */
+      sf_hal_mem_process();
+
+      /* sleep until the next timer expires if there is nothing left to do */
+      if(((wmbus_apl_getStatus() & APL_STATUS_BUSY) == 0U) &&
+         (sf_hal_mem_isBusy() == FALSE))
+      {
+        sf_hal_tmr_sleep();
+      } /* if */
     } /* while */
   }/* if */
 } /* main() */
@@ -0,0 +1,345 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @file       wmbus_meterdir.c
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Hashed directory of meter devices.
+
+  @addtogroup WMBUS_METERDIR
+
+  Source implementation of the API in wmbus_meterdir_api.h. The slot of an
+  address is derived from the low bits of its FNV-1a hash, collisions are
+  resolved by linear probing. The upper 16 bits of the hash are stored as
+  tag of the slot, so the address of a meter is only read back by
+  fp_getAddr if the tags match. The tags 0x0000 and 0xFFFF mark empty and
+  removed slots. Removed slots are reused by wmbus_meterdir_add() but do not
+  stop the probing of a lookup. They are emptied again by
+  wmbus_meterdir_remove() once they end a probe sequence, or all at once by
+  a rehash if wmbus_meterdir_add() runs out of empty slots. At least one
+  slot is always kept empty, so the probing of an unknown address
+  terminates.
+*/
+/**@{*/
+
+/*==============================================================================
+                            INCLUDE FILES
+==============================================================================*/
+#include "inc\pub\utils\wmbus_typedefs.h"
+#include "inc\pub\utils\wmbus_tlg_api.h"
+#include "inc\pub\utils\wmbus_meterdir_api.h"
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! Tag of a slot never used. */
+#define METERDIR_TAG_EMPTY                    0x0000U
+/*! Tag of a slot whose meter was removed. */
+#define METERDIR_TAG_REMOVED                  0xFFFFU
+
+/*! Offset basis of the 32 bit FNV-1a hash. */
+#define METERDIR_FNV_OFFSET                   2166136261UL
+/*! Prime of the 32 bit FNV-1a hash. */
+#define METERDIR_FNV_PRIME                    16777619UL
+
+/*! Mask to get the slot from a hash or a probe position. */
+#define METERDIR_MASK                         (METERDIR_SIZE - 1U)
+
+/*==============================================================================
+                            VARIABLES
+==============================================================================*/
+/*! Tags of the slots. */
+static uint16_t gai_meterdir_tag[METERDIR_SIZE];
+/*! Meter ids of the slots. */
+static uint16_t gai_meterdir_id[METERDIR_SIZE];
+/*! Number of slots not empty, including the removed ones. */
+static uint16_t gi_meterdir_used;
+/*! Number of meters in the directory. */
+static uint16_t gi_meterdir_num;
+/*! Reads the address of a meter. */
+static fp_meterdir_getAddr_t gfp_meterdir_getAddr;
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+static uint32_t loc_meterdir_hash(s_wmbus_addr_t *ps_meterAddr);
+static uint16_t loc_meterdir_tag(uint32_t l_hash);
+static bool_t loc_meterdir_match(uint16_t i_slot,
+                                 s_wmbus_addr_t *ps_meterAddr);
+static uint16_t loc_meterdir_find(s_wmbus_addr_t *ps_meterAddr);
+static void loc_meterdir_rehash(void);
+
+/*============================================================================*/
+/* loc_meterdir_hash() */
+/*============================================================================*/
+static uint32_t loc_meterdir_hash(s_wmbus_addr_t *ps_meterAddr)
+{
+  uint8_t *pc_addr = (uint8_t*)ps_meterAddr;
+  uint32_t l_hash = METERDIR_FNV_OFFSET;
+  uint8_t c_i;
+
+  for(c_i = 0U; c_i < sizeof(s_wmbus_addr_t); c_i++)
+  {
+    l_hash ^= pc_addr[c_i];
+    l_hash *= METERDIR_FNV_PRIME;
+  } /* for */
+
+  return l_hash;
+} /* loc_meterdir_hash() */
+
+/*============================================================================*/
+/* loc_meterdir_tag() */
+/*============================================================================*/
+static uint16_t loc_meterdir_tag(uint32_t l_hash)
+{
+  uint16_t i_tag = (uint16_t)(l_hash >> 16U);
+
+  /* Keep the reserved tags free. */
+  if((i_tag == METERDIR_TAG_EMPTY) || (i_tag == METERDIR_TAG_REMOVED))
+  {
+    i_tag = 0x0001U;
+  } /* if */
+
+  return i_tag;
+} /* loc_meterdir_tag() */
+
+/*============================================================================*/
+/* loc_meterdir_match() */
+/*============================================================================*/
+static bool_t loc_meterdir_match(uint16_t i_slot,
+                                 s_wmbus_addr_t *ps_meterAddr)
+{
+  s_wmbus_addr_t s_addr;
+
+  if(gfp_meterdir_getAddr(gai_meterdir_id[i_slot], &s_addr) == FALSE)
+  {
+    return FALSE;
+  } /* if */
+
+  return (MEMCMP(&s_addr, ps_meterAddr, sizeof(s_wmbus_addr_t)) == 0) ?
+         TRUE : FALSE;
+} /* loc_meterdir_match() */
+
+/*============================================================================*/
+/* loc_meterdir_find() */
+/*============================================================================*/
+static uint16_t loc_meterdir_find(s_wmbus_addr_t *ps_meterAddr)
+{
+  uint32_t l_hash;
+  uint16_t i_tag;
+  uint16_t i_slot;
+  uint16_t i_probe;
+
+  if(gfp_meterdir_getAddr == NULL)
+  {
+    return METERDIR_SIZE;
+  } /* if */
+
+  l_hash = loc_meterdir_hash(ps_meterAddr);
+  i_tag = loc_meterdir_tag(l_hash);
+  i_slot = (uint16_t)(l_hash & METERDIR_MASK);
+
+  for(i_probe = 0U; i_probe < METERDIR_SIZE; i_probe++)
+  {
+    if(gai_meterdir_tag[i_slot] == METERDIR_TAG_EMPTY)
+    {
+      break;
+    } /* if */
+
+    if((gai_meterdir_tag[i_slot] == i_tag) &&
+       (loc_meterdir_match(i_slot, ps_meterAddr) == TRUE))
+    {
+      return i_slot;
+    } /* if */
+
+    i_slot = (i_slot + 1U) & METERDIR_MASK;
+  } /* for */
+
+  return METERDIR_SIZE;
+} /* loc_meterdir_find() */
+
+/*============================================================================*/
+/* loc_meterdir_rehash() */
+/*============================================================================*/
+static void loc_meterdir_rehash(void)
+{
+  s_wmbus_addr_t s_addr;
+  uint16_t i_start = 0U;
+  uint16_t i_slot;
+  uint16_t i_new;
+  uint16_t i_tag;
+  uint16_t i_probe;
+
+  /* No probe sequence passes an empty slot, so the meters behind it are
+     moved in order and always find their new slot in front of them. */
+  while(gai_meterdir_tag[i_start] != METERDIR_TAG_EMPTY)
+  {
+    i_start++;
+  } /* while */
+
+  for(i_slot = 0U; i_slot < METERDIR_SIZE; i_slot++)
+  {
+    if(gai_meterdir_tag[i_slot] == METERDIR_TAG_REMOVED)
+    {
+      gai_meterdir_tag[i_slot] = METERDIR_TAG_EMPTY;
+    } /* if */
+  } /* for */
+  gi_meterdir_used = gi_meterdir_num;
+
+  i_slot = i_start;
+  for(i_probe = 1U; i_probe < METERDIR_SIZE; i_probe++)
+  {
+    i_slot = (i_slot + 1U) & METERDIR_MASK;
+    if((gai_meterdir_tag[i_slot] != METERDIR_TAG_EMPTY) &&
+       (gfp_meterdir_getAddr(gai_meterdir_id[i_slot], &s_addr) == TRUE))
+    {
+      i_tag = gai_meterdir_tag[i_slot];
+      gai_meterdir_tag[i_slot] = METERDIR_TAG_EMPTY;
+
+      i_new = (uint16_t)(loc_meterdir_hash(&s_addr) & METERDIR_MASK);
+      while(gai_meterdir_tag[i_new] != METERDIR_TAG_EMPTY)
+      {
+        i_new = (i_new + 1U) & METERDIR_MASK;
+      } /* while */
+      gai_meterdir_tag[i_new] = i_tag;
+      gai_meterdir_id[i_new] = gai_meterdir_id[i_slot];
+    } /* if */
+  } /* for */
+} /* loc_meterdir_rehash() */
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+
+/*============================================================================*/
+/* wmbus_meterdir_init() */
+/*============================================================================*/
+void wmbus_meterdir_init(fp_meterdir_getAddr_t fp_getAddr)
+{
+  MEMSET(gai_meterdir_tag, METERDIR_TAG_EMPTY, sizeof(gai_meterdir_tag));
+  gi_meterdir_used = 0U;
+  gi_meterdir_num = 0U;
+  gfp_meterdir_getAddr = fp_getAddr;
+} /* wmbus_meterdir_init() */
+
+/*============================================================================*/
+/* wmbus_meterdir_add() */
+/*============================================================================*/
+bool_t wmbus_meterdir_add(s_wmbus_addr_t *ps_meterAddr, uint16_t i_meterId)
+{
+  uint32_t l_hash;
+  uint16_t i_slot;
+
+  i_slot = loc_meterdir_find(ps_meterAddr);
+  if(i_slot < METERDIR_SIZE)
+  {
+    gai_meterdir_id[i_slot] = i_meterId;
+    return TRUE;
+  } /* if */
+
+  l_hash = loc_meterdir_hash(ps_meterAddr);
+  i_slot = (uint16_t)(l_hash & METERDIR_MASK);
+
+  /* Take the first removed or empty slot of the probe sequence. */
+  while((gai_meterdir_tag[i_slot] != METERDIR_TAG_EMPTY) &&
+        (gai_meterdir_tag[i_slot] != METERDIR_TAG_REMOVED))
+  {
+    i_slot = (i_slot + 1U) & METERDIR_MASK;
+  } /* while */
+
+  if(gai_meterdir_tag[i_slot] == METERDIR_TAG_EMPTY)
+  {
+    if(gi_meterdir_used >= (METERDIR_SIZE - 1U))
+    {
+      if(gi_meterdir_used == gi_meterdir_num)
+      {
+        /* Keep one slot empty to terminate the lookups. */
+        return FALSE;
+      } /* if */
+
+      /* Only removed slots are left, but none of them is on the probe
+         sequence. Drop them all. */
+      loc_meterdir_rehash();
+      i_slot = (uint16_t)(l_hash & METERDIR_MASK);
+      while(gai_meterdir_tag[i_slot] != METERDIR_TAG_EMPTY)
+      {
+        i_slot = (i_slot + 1U) & METERDIR_MASK;
+      } /* while */
+    } /* if */
+    gi_meterdir_used++;
+  } /* if */
+
+  gai_meterdir_tag[i_slot] = loc_meterdir_tag(l_hash);
+  gai_meterdir_id[i_slot] = i_meterId;
+  gi_meterdir_num++;
+
+  return TRUE;
+} /* wmbus_meterdir_add() */
+
+/*============================================================================*/
+/* wmbus_meterdir_remove() */
+/*============================================================================*/
+bool_t wmbus_meterdir_remove(s_wmbus_addr_t *ps_meterAddr)
+{
+  uint16_t i_slot;
+
+  i_slot = loc_meterdir_find(ps_meterAddr);
+  if(i_slot >= METERDIR_SIZE)
+  {
+    return FALSE;
+  } /* if */
+
+  gai_meterdir_tag[i_slot] = METERDIR_TAG_REMOVED;
+  gi_meterdir_num--;
+
+  /* A removed slot followed by an empty one does not continue any probe
+     sequence. It is emptied again, as well as the removed slots directly
+     before it. */
+  while((gai_meterdir_tag[i_slot] == METERDIR_TAG_REMOVED) &&
+        (gai_meterdir_tag[(i_slot + 1U) & METERDIR_MASK] ==
+         METERDIR_TAG_EMPTY))
+  {
+    gai_meterdir_tag[i_slot] = METERDIR_TAG_EMPTY;
+    gi_meterdir_used--;
+    i_slot = (i_slot - 1U) & METERDIR_MASK;
+  } /* while */
+
+  if(gi_meterdir_num == 0U)
+  {
+    /* Drop the removed slots, they only lengthen the probing. */
+    wmbus_meterdir_init(gfp_meterdir_getAddr);
+  } /* if */
+
+  return TRUE;
+} /* wmbus_meterdir_remove() */
+
+/*============================================================================*/
+/* wmbus_meterdir_get() */
+/*============================================================================*/
+uint16_t wmbus_meterdir_get(s_wmbus_addr_t *ps_meterAddr)
+{
+  uint16_t i_slot;
+
+  i_slot = loc_meterdir_find(ps_meterAddr);
+  if(i_slot >= METERDIR_SIZE)
+  {
+    return METERDIR_ID_INVALID;
+  } /* if */
+
+  return gai_meterdir_id[i_slot];
+} /* wmbus_meterdir_get() */
+
+/*============================================================================*/
+/* wmbus_meterdir_getNum() */
+/*============================================================================*/
+uint16_t wmbus_meterdir_getNum(void)
+{
+  return gi_meterdir_num;
+} /* wmbus_meterdir_getNum() */
+
+/**@}*/
+#ifdef __cplusplus
+}
+#endif
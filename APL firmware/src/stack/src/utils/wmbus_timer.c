@@ -0,0 +1,560 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @file       wmbus_timer.c
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Timer module of the stack based on binary min-heaps.
+
+  @addtogroup WMBUS_TIMER
+
+  Source implementation of the API in wmbus_timer_api.h. Linking this file
+  replaces the timer module of the stack library, which keeps the running
+  timers in a sorted chain and therefore has to walk it on every insert.
+
+  The running timers are kept in a binary min-heap ordered by their expiry
+  instead. Starting and stopping a timer is O(log n), the next timer to
+  expire is always the root of the heap. Timers checked by
+  wmbus_tmr_handleWdtEvents() are kept in a heap of their own, so the tick
+  ISR does not have to search for them.
+
+  The layout of @ref s_tmr_t is kept for the library. The chain pointers are
+  used as follows while a timer is running:
+  - p_tmrPrev points to the slot of the heap holding the timer.
+  - p_tmrNext points to the heap holding the timer.
+*/
+/**@{*/
+
+/*==============================================================================
+                            INCLUDE FILES
+==============================================================================*/
+#define __DECL_TIMER_API_H__
+#include "inc\pub\utils\wmbus_typedefs.h"
+#include "inc\pub\utils\wmbus_timer_api.h"
+#include "inc\pub\hal\wmbus_hal_tmr.h"
+#include "inc\pub\hal\wmbus_hal_mcu.h"
+
+#include "em_device.h"
+
+#ifndef TMR_HEAP_ENABLED
+/*! Set to FALSE to link the timer module of the stack library instead. */
+#define TMR_HEAP_ENABLED                      TRUE
+#endif /* TMR_HEAP_ENABLED */
+
+#if (TMR_HEAP_ENABLED == TRUE)
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+#ifndef TMR_HEAP_STACK_SIZE
+/*! Maximum number of timers of the stack running at the same time. */
+#define TMR_HEAP_STACK_SIZE                   (16U)
+#endif /* TMR_HEAP_STACK_SIZE */
+
+#ifndef TMR_HEAP_APP_SIZE
+/*! Maximum number of timers of the application running at the same time,
+    set by the project configuration. */
+#define TMR_HEAP_APP_SIZE                     (0U)
+#endif /* TMR_HEAP_APP_SIZE */
+
+#ifndef TMR_HEAP_SIZE
+/*! Maximum number of timers running at the same time. */
+#define TMR_HEAP_SIZE                 (TMR_HEAP_STACK_SIZE + TMR_HEAP_APP_SIZE)
+#endif /* TMR_HEAP_SIZE */
+
+#ifndef TMR_HEAP_WDT_SIZE
+/*! Maximum number of WDT timers running at the same time. */
+#define TMR_HEAP_WDT_SIZE                     (4U)
+#endif /* TMR_HEAP_WDT_SIZE */
+
+#ifndef TOT2_CRITICAL_START
+/*! Protects the heaps, WDT timers expire from the tick interrupt while the
+    main loop sets timers. The interrupt mask is restored by
+    TOT2_CRITICAL_END, so the section may be entered with the interrupts
+    disabled already. */
+#define TOT2_CRITICAL_START   { uint32_t l_primask = __get_PRIMASK();        \
+                                __disable_irq()
+#endif /* TOT2_CRITICAL_START */
+
+#ifndef TOT2_CRITICAL_END
+/*! Counterpart of TOT2_CRITICAL_START. */
+#define TOT2_CRITICAL_END       __set_PRIMASK(l_primask); }
+#endif /* TOT2_CRITICAL_END */
+
+#ifndef TMR_HEAP_FULL
+/*! Called if a timer is set while its heap is full. A timer silently not
+    running stalls the stack, so the device is reset. TMR_HEAP_STACK_SIZE
+    or TMR_HEAP_APP_SIZE has to be increased. */
+#define TMR_HEAP_FULL()       wmbus_hal_mcu_reset()
+#endif /* TMR_HEAP_FULL */
+
+/*! Checks if the tick counter reached the given expiry. */
+#define TMR_IS_DUE(l_ticks)                                                   \
+  ((sint32_t)(gs_tmr_ctx.gl_tmr_tickCnt - (l_ticks)) >= 0)
+
+/*! Checks if a timer expires before another one. */
+#define TMR_IS_BEFORE(ps_a, ps_b)                                             \
+  ((sint32_t)((ps_a)->l_ticks - (ps_b)->l_ticks) < 0)
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! Binary min-heap of running timers. */
+typedef struct S_TMR_HEAP_T
+{
+  /*! Timers ordered by their expiry, the root expires first. */
+  s_tmr_t** pps_tmr;
+  /*! Number of slots of the heap. */
+  uint16_t i_size;
+  /*! Number of timers in the heap. */
+  uint16_t i_cnt;
+} s_tmr_heap_t;
+
+/*==============================================================================
+                            VARIABLES
+==============================================================================*/
+/*! Context of the timer module. */
+s_tmr_ctx_t gs_tmr_ctx;
+/*! Pointer to the context of the timer module. */
+s_tmr_ctx_t* gps_tmr_ctx_ptr = &gs_tmr_ctx;
+
+/*! State of an initialised timer. */
+static const s_tmr_t rs_timeoutDefault = {E_TMR_STATUS_EXPIRED, 0U, NULL,
+                                          NULL, NULL, NULL, FALSE};
+
+/*! Slots of the heaps. */
+static s_tmr_t* gaps_tmr_heap[TMR_HEAP_SIZE];
+static s_tmr_t* gaps_tmr_heapWdt[TMR_HEAP_WDT_SIZE];
+
+/*! Heap of the timers. */
+static s_tmr_heap_t gs_tmr_heap = {gaps_tmr_heap, TMR_HEAP_SIZE, 0U};
+/*! Heap of the WDT timers. */
+static s_tmr_heap_t gs_tmr_heapWdt = {gaps_tmr_heapWdt, TMR_HEAP_WDT_SIZE, 0U};
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/* loc_tmr_heapPlace() */
+/*============================================================================*/
+static void loc_tmr_heapPlace(s_tmr_heap_t* ps_heap, uint16_t i_idx,
+                              s_tmr_t* ps_tmr)
+{
+  ps_heap->pps_tmr[i_idx] = ps_tmr;
+  ps_tmr->p_tmrPrev = &ps_heap->pps_tmr[i_idx];
+  ps_tmr->p_tmrNext = ps_heap;
+} /* loc_tmr_heapPlace() */
+
+/*============================================================================*/
+/* loc_tmr_heapUp() */
+/*============================================================================*/
+static void loc_tmr_heapUp(s_tmr_heap_t* ps_heap, uint16_t i_idx,
+                           s_tmr_t* ps_tmr)
+{
+  uint16_t i_parent;
+
+  /* Move the later parents down until the slot for the timer is found. */
+  while(i_idx > 0U)
+  {
+    i_parent = (i_idx - 1U) >> 1U;
+    if(!TMR_IS_BEFORE(ps_tmr, ps_heap->pps_tmr[i_parent]))
+    {
+      break;
+    } /* if */
+    loc_tmr_heapPlace(ps_heap, i_idx, ps_heap->pps_tmr[i_parent]);
+    i_idx = i_parent;
+  } /* while */
+
+  loc_tmr_heapPlace(ps_heap, i_idx, ps_tmr);
+} /* loc_tmr_heapUp() */
+
+/*============================================================================*/
+/* loc_tmr_heapDown() */
+/*============================================================================*/
+static void loc_tmr_heapDown(s_tmr_heap_t* ps_heap, uint16_t i_idx,
+                             s_tmr_t* ps_tmr)
+{
+  uint16_t i_child;
+
+  /* Move the earlier child up until the slot for the timer is found. */
+  while((i_child = (i_idx << 1U) + 1U) < ps_heap->i_cnt)
+  {
+    if(((i_child + 1U) < ps_heap->i_cnt) &&
+       TMR_IS_BEFORE(ps_heap->pps_tmr[i_child + 1U],
+                     ps_heap->pps_tmr[i_child]))
+    {
+      i_child++;
+    } /* if */
+
+    if(!TMR_IS_BEFORE(ps_heap->pps_tmr[i_child], ps_tmr))
+    {
+      break;
+    } /* if */
+    loc_tmr_heapPlace(ps_heap, i_idx, ps_heap->pps_tmr[i_child]);
+    i_idx = i_child;
+  } /* while */
+
+  loc_tmr_heapPlace(ps_heap, i_idx, ps_tmr);
+} /* loc_tmr_heapDown() */
+
+/*============================================================================*/
+/* loc_tmr_heapOf() */
+/*============================================================================*/
+static s_tmr_heap_t* loc_tmr_heapOf(s_tmr_t* ps_tmr)
+{
+  s_tmr_heap_t* ps_heap = NULL;
+  s_tmr_t** pps_slot;
+
+  /* The timer might not be initialised, so its pointers are verified
+     against the heaps before being used. */
+  if((ps_tmr->p_tmrNext == &gs_tmr_heap) ||
+     (ps_tmr->p_tmrNext == &gs_tmr_heapWdt))
+  {
+    ps_heap = (s_tmr_heap_t*)ps_tmr->p_tmrNext;
+    pps_slot = (s_tmr_t**)ps_tmr->p_tmrPrev;
+    if((pps_slot < ps_heap->pps_tmr) ||
+       (pps_slot >= &ps_heap->pps_tmr[ps_heap->i_cnt]) ||
+       (*pps_slot != ps_tmr))
+    {
+      ps_heap = NULL;
+    } /* if */
+  } /* if */
+
+  return ps_heap;
+} /* loc_tmr_heapOf() */
+
+/*============================================================================*/
+/* loc_tmr_heapRemove() */
+/*============================================================================*/
+static void loc_tmr_heapRemove(s_tmr_heap_t* ps_heap, s_tmr_t* ps_tmr)
+{
+  uint16_t i_idx;
+  s_tmr_t* ps_last;
+
+  i_idx = (uint16_t)((s_tmr_t**)ps_tmr->p_tmrPrev - ps_heap->pps_tmr);
+  ps_tmr->p_tmrPrev = NULL;
+  ps_tmr->p_tmrNext = NULL;
+
+  /* Fill the gap with the last timer of the heap. */
+  ps_heap->i_cnt--;
+  if(i_idx < ps_heap->i_cnt)
+  {
+    ps_last = ps_heap->pps_tmr[ps_heap->i_cnt];
+    if((i_idx > 0U) &&
+       TMR_IS_BEFORE(ps_last, ps_heap->pps_tmr[(i_idx - 1U) >> 1U]))
+    {
+      loc_tmr_heapUp(ps_heap, i_idx, ps_last);
+    }
+    else
+    {
+      loc_tmr_heapDown(ps_heap, i_idx, ps_last);
+    } /* if ... else */
+  } /* if */
+} /* loc_tmr_heapRemove() */
+
+/*============================================================================*/
+/* loc_tmr_updateFirst() */
+/*============================================================================*/
+static void loc_tmr_updateFirst(void)
+{
+  s_tmr_t* ps_first = NULL;
+  s_tmr_t* ps_firstWdt = NULL;
+
+  if(gs_tmr_heap.i_cnt > 0U)
+  {
+    ps_first = gs_tmr_heap.pps_tmr[0];
+  } /* if */
+  if(gs_tmr_heapWdt.i_cnt > 0U)
+  {
+    ps_firstWdt = gs_tmr_heapWdt.pps_tmr[0];
+  } /* if */
+
+  /* The context points to the timer expiring next, as the chain did. */
+  if((ps_first == NULL) ||
+     ((ps_firstWdt != NULL) && TMR_IS_BEFORE(ps_firstWdt, ps_first)))
+  {
+    ps_first = ps_firstWdt;
+  } /* if */
+  gs_tmr_ctx.ps_tmrFirst = ps_first;
+} /* loc_tmr_updateFirst() */
+
+/*============================================================================*/
+/* loc_tmr_remove() */
+/*============================================================================*/
+static void loc_tmr_remove(s_tmr_t* ps_tmr)
+{
+  s_tmr_heap_t* ps_heap;
+
+  TOT2_CRITICAL_START;
+  ps_heap = loc_tmr_heapOf(ps_tmr);
+  if(ps_heap != NULL)
+  {
+    loc_tmr_heapRemove(ps_heap, ps_tmr);
+    loc_tmr_updateFirst();
+  } /* if */
+  TOT2_CRITICAL_END;
+} /* loc_tmr_remove() */
+
+/*============================================================================*/
+/* loc_tmr_expire() */
+/*============================================================================*/
+static void loc_tmr_expire(s_tmr_t* ps_tmr)
+{
+  pf_tmr_Callback_t* pf_cbFunc;
+  uint32_t l_ms;
+
+  loc_tmr_remove(ps_tmr);
+  ps_tmr->e_tmrState = E_TMR_STATUS_EXPIRED;
+
+  pf_cbFunc = ps_tmr->pf_Callback;
+  if(pf_cbFunc != NULL)
+  {
+    /* The callback returns the delay to restart the timer with. */
+    l_ms = pf_cbFunc();
+    if(l_ms > 0U)
+    {
+      wmbus_tmr_set(ps_tmr, l_ms, pf_cbFunc);
+    } /* if */
+  } /* if */
+} /* loc_tmr_expire() */
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/* wmbus_tmr_init() */
+/*============================================================================*/
+void wmbus_tmr_init(void)
+{
+  gps_tmr_ctx_ptr = &gs_tmr_ctx;
+  gs_tmr_ctx.ps_tmrFirst = NULL;
+  gs_tmr_ctx.gl_tmr_tickCnt = 0U;
+  gs_tmr_ctx.gl_tmr_tickCntB = 0U;
+  gs_tmr_ctx.gl_tmrWdt = 0U;
+
+  gs_tmr_heap.i_cnt = 0U;
+  gs_tmr_heapWdt.i_cnt = 0U;
+
+  wmbus_hal_tmr_setCallback(wmbus_tmr_tick);
+} /* wmbus_tmr_init() */
+
+/*============================================================================*/
+/* wmbus_tmr_handleEvents() */
+/*============================================================================*/
+void wmbus_tmr_handleEvents(void)
+{
+  s_tmr_t* ps_tmr = gs_tmr_ctx.ps_tmrFirst;
+
+  /* A single timer is handled per call, as before. */
+  if((ps_tmr != NULL) && TMR_IS_DUE(ps_tmr->l_ticks))
+  {
+    loc_tmr_expire(ps_tmr);
+  } /* if */
+} /* wmbus_tmr_handleEvents() */
+
+/*============================================================================*/
+/* wmbus_tmr_handleWdtEvents() */
+/*============================================================================*/
+void wmbus_tmr_handleWdtEvents(void)
+{
+  s_tmr_t* ps_tmr;
+
+  if(gs_tmr_heapWdt.i_cnt > 0U)
+  {
+    ps_tmr = gs_tmr_heapWdt.pps_tmr[0];
+    if(TMR_IS_DUE(ps_tmr->l_ticks) && (ps_tmr->pf_Callback != NULL))
+    {
+      loc_tmr_expire(ps_tmr);
+    } /* if */
+  } /* if */
+} /* wmbus_tmr_handleWdtEvents() */
+
+/*============================================================================*/
+/* wmbus_tmr_set() */
+/*============================================================================*/
+void wmbus_tmr_set(s_tmr_t* ps_tmr, uint32_t l_ms, pf_tmr_Callback_t pf_cbFunc)
+{
+  s_tmr_heap_t* ps_heap;
+  bool_t b_full = FALSE;
+
+  if(ps_tmr != NULL)
+  {
+    loc_tmr_remove(ps_tmr);
+
+    ps_tmr->l_ticks = gs_tmr_ctx.gl_tmr_tickCnt + (l_ms * TMR_TICKS_DIVIDER);
+    ps_tmr->pr_desc = NULL;
+    ps_tmr->pf_Callback = pf_cbFunc;
+
+    ps_heap = (ps_tmr->b_isWdt == TRUE) ? &gs_tmr_heapWdt : &gs_tmr_heap;
+
+    TOT2_CRITICAL_START;
+    if(ps_heap->i_cnt < ps_heap->i_size)
+    {
+      ps_tmr->e_tmrState = E_TMR_STATUS_RUNNING;
+      ps_heap->i_cnt++;
+      loc_tmr_heapUp(ps_heap, ps_heap->i_cnt - 1U, ps_tmr);
+      loc_tmr_updateFirst();
+    }
+    else
+    {
+      /* TMR_HEAP_SIZE is too small for the application. */
+      ps_tmr->e_tmrState = E_TMR_STATUS_NOEXIST;
+      b_full = TRUE;
+    } /* if ... else */
+    TOT2_CRITICAL_END;
+
+    if(b_full)
+    {
+      TMR_HEAP_FULL();
+    } /* if */
+  } /* if */
+} /* wmbus_tmr_set() */
+
+/*============================================================================*/
+/* wmbus_tmr_reset() */
+/*============================================================================*/
+void wmbus_tmr_reset(s_tmr_t* ps_tmr)
+{
+  if(ps_tmr != NULL)
+  {
+    loc_tmr_remove(ps_tmr);
+    ps_tmr->e_tmrState = E_TMR_STATUS_NOEXIST;
+  } /* if */
+} /* wmbus_tmr_reset() */
+
+/*============================================================================*/
+/* wmbus_tmr_initDefault() */
+/*============================================================================*/
+void wmbus_tmr_initDefault(s_tmr_t* ps_tmr, bool_t b_isWdt)
+{
+  if(ps_tmr != NULL)
+  {
+    if(loc_tmr_heapOf(ps_tmr) != NULL)
+    {
+      wmbus_tmr_reset(ps_tmr);
+    }
+    else
+    {
+      *ps_tmr = rs_timeoutDefault;
+    } /* if ... else */
+    ps_tmr->b_isWdt = b_isWdt;
+  } /* if */
+} /* wmbus_tmr_initDefault() */
+
+/*============================================================================*/
+/* wmbus_tmr_getStatus() */
+/*============================================================================*/
+E_TMR_STATUS_t wmbus_tmr_getStatus(s_tmr_t* ps_tmr)
+{
+  E_TMR_STATUS_t e_ret = E_TMR_STATUS_EXPIRED;
+
+  if((ps_tmr != NULL) && (ps_tmr->e_tmrState == E_TMR_STATUS_RUNNING) &&
+     !TMR_IS_DUE(ps_tmr->l_ticks))
+  {
+    e_ret = E_TMR_STATUS_RUNNING;
+  } /* if */
+
+  return e_ret;
+} /* wmbus_tmr_getStatus() */
+
+/*============================================================================*/
+/* wmbus_tmr_enable() */
+/*============================================================================*/
+void wmbus_tmr_enable(void)
+{
+  wmbus_hal_tmr_enable();
+} /* wmbus_tmr_enable() */
+
+/*============================================================================*/
+/* wmbus_tmr_disable() */
+/*============================================================================*/
+void wmbus_tmr_disable(void)
+{
+  wmbus_hal_tmr_disable();
+} /* wmbus_tmr_disable() */
+
+/*============================================================================*/
+/* wmbus_tmr_getTimeout() */
+/*============================================================================*/
+uint32_t wmbus_tmr_getTimeout(uint32_t l_ms)
+{
+  return gs_tmr_ctx.gl_tmr_tickCnt + (l_ms * TMR_TICKS_DIVIDER);
+} /* wmbus_tmr_getTimeout() */
+
+/*============================================================================*/
+/* wmbus_tmr_ticksToExpire() */
+/*============================================================================*/
+uint32_t wmbus_tmr_ticksToExpire(uint32_t l_timeTicks)
+{
+  uint32_t l_ret = 0U;
+
+  if(!TMR_IS_DUE(l_timeTicks))
+  {
+    l_ret = l_timeTicks - gs_tmr_ctx.gl_tmr_tickCnt;
+  } /* if */
+
+  return l_ret;
+} /* wmbus_tmr_ticksToExpire() */
+
+/*============================================================================*/
+/* wmbus_tmr_tick() */
+/*============================================================================*/
+void wmbus_tmr_tick(void)
+{
+  gs_tmr_ctx.gl_tmr_tickCnt++;
+} /* wmbus_tmr_tick() */
+
+/*============================================================================*/
+/* wmbus_tmr_ticksToExpireB() */
+/*============================================================================*/
+uint32_t wmbus_tmr_ticksToExpireB(uint32_t l_timeTicks)
+{
+  uint32_t l_ret = 0U;
+
+  if((sint32_t)(gs_tmr_ctx.gl_tmr_tickCntB - l_timeTicks) < 0)
+  {
+    l_ret = l_timeTicks - gs_tmr_ctx.gl_tmr_tickCntB;
+  } /* if */
+
+  return l_ret;
+} /* wmbus_tmr_ticksToExpireB() */
+
+/*============================================================================*/
+/* wmbus_tmr_tickB() */
+/*============================================================================*/
+void wmbus_tmr_tickB(void)
+{
+  gs_tmr_ctx.gl_tmr_tickCntB++;
+} /* wmbus_tmr_tickB() */
+
+/*============================================================================*/
+/* wmbus_tmr_getTicksB() */
+/*============================================================================*/
+uint32_t wmbus_tmr_getTicksB(void)
+{
+  return gs_tmr_ctx.gl_tmr_tickCntB;
+} /* wmbus_tmr_getTicksB() */
+
+/*============================================================================*/
+/* wmbus_tmr_getRandomNumber() */
+/*============================================================================*/
+uint32_t wmbus_tmr_getRandomNumber(uint32_t l_min, uint32_t l_max)
+{
+  uint32_t l_ret = l_min;
+
+  /* An empty range returns l_min instead of dividing by zero. */
+  if(l_max > l_min)
+  {
+    l_ret += gs_tmr_ctx.gl_tmr_tickCnt % (l_max - l_min);
+  } /* if */
+
+  return l_ret;
+} /* wmbus_tmr_getRandomNumber() */
+
+#endif /* TMR_HEAP_ENABLED */
+
+/**@}*/
+#ifdef __cplusplus
+}
+#endif
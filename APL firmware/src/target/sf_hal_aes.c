@@ -20,6 +20,7 @@ extern "C" {
                             INCLUDE FILES
 ==============================================================================*/
 #include "inc\pub\utils\wmbus_typedefs.h"
+#include "sf_hal_aes.h"
 #include "em_cmu.h"
 #include "em_aes.h"
 
@@ -36,11 +37,111 @@ extern "C" {
     @warning This value is fixed for AES and must not be changed! */
 #define EFM_AES_BLOCK_LEN   (16U)
 
+/*! Number of bytes passed at once to the hardware while calculating a CMAC.
+    The input is copied into a word aligned buffer of this size on the
+    stack. Must be a multiple of EFM_AES_BLOCK_LEN. */
+#define AES_CMAC_CHUNK_LEN  (4U * EFM_AES_BLOCK_LEN)
+
+#ifndef AES_KEY_CACHE_RAM_BUDGET
+/*! RAM in bytes spent for caching the expanded keys. Collectors serving many
+    meters switch the key for nearly every received telegram. Keeping the
+    keys of the recently used meters avoids expanding them again.
+    The budget must at least hold a single entry (the active key). It is set
+    per board, the default of 4 keys fits the devices with 4 KB of RAM. */
+#define AES_KEY_CACHE_RAM_BUDGET   (144U)
+#endif /* AES_KEY_CACHE_RAM_BUDGET */
+
+/*! Size of a single entry of the key cache, see s_aes_keyCacheEntry_t. */
+#define AES_KEY_CACHE_ENTRY_LEN    (2U * EFM_AES_KEY_LEN + 4U)
+
+/*! Number of keys fitting into the RAM budget. */
+#define AES_KEY_CACHE_ENTRIES      (AES_KEY_CACHE_RAM_BUDGET / \
+                                    AES_KEY_CACHE_ENTRY_LEN)
+
+#if (AES_KEY_CACHE_ENTRIES < 1U)
+  #error AES_KEY_CACHE_RAM_BUDGET is too small to hold a single key.
+#endif
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! Entry of the key cache. The meter keys are handed over by the stack
+    without any meter reference, therefore the key itself identifies the
+    entry. */
+typedef struct S_AES_KEYCACHEENTRY_T
+{
+  /*! Encryption key as set by wmbus_hal_aes_setKey(). */
+  uint8_t ac_enkey[EFM_AES_KEY_LEN];
+  /*! Decryption key derived from the encryption key. */
+  uint8_t ac_dekey[EFM_AES_KEY_LEN];
+  /*! Time of the last use, 0 if the entry is unused. */
+  uint32_t l_lastUse;
+
+} s_aes_keyCacheEntry_t;
+
 /*==============================================================================
                             VARIABLES
 ==============================================================================*/
-/** Module global variable for storing the encryption key. */
-static uint8_t gac_enkey[EFM_AES_KEY_LEN];
+/** Cache of the recently used keys. */
+static s_aes_keyCacheEntry_t gas_aes_keyCache[AES_KEY_CACHE_ENTRIES];
+
+/** Entry of the key cache holding the active key. */
+static s_aes_keyCacheEntry_t* gps_aes_key;
+
+/** Counter used for tracking the least recently used entry. */
+static uint32_t gl_aes_keyCacheTime;
+
+/** Statistics of the key cache. */
+static s_sf_hal_aes_cacheStats_t gs_aes_keyCacheStats;
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/**
+  @brief  Looks up a key within the key cache.
+          On a cache miss the least recently used entry is replaced by the
+          given key and its decryption key is derived.
+  @param  pc_key    Key to be looked up.
+  @return Cache entry holding the key.
+*/
+/*============================================================================*/
+static s_aes_keyCacheEntry_t* loc_aes_keyCacheGet(const uint8_t* pc_key)
+{
+  s_aes_keyCacheEntry_t* ps_entry = NULL;
+  s_aes_keyCacheEntry_t* ps_lru = &gas_aes_keyCache[0];
+  uint16_t i;
+
+  for(i = 0U; (i < AES_KEY_CACHE_ENTRIES) && (ps_entry == NULL); i++)
+  {
+    if((gas_aes_keyCache[i].l_lastUse != 0U) &&
+       (MEMCMP(gas_aes_keyCache[i].ac_enkey, pc_key, EFM_AES_KEY_LEN) == 0))
+    {
+      ps_entry = &gas_aes_keyCache[i];
+    }
+    else if(gas_aes_keyCache[i].l_lastUse < ps_lru->l_lastUse)
+    {
+      ps_lru = &gas_aes_keyCache[i];
+    } /* if ... else if */
+  } /* for */
+
+  if(ps_entry != NULL)
+  {
+    gs_aes_keyCacheStats.l_hit++;
+  }
+  else
+  {
+    /* Replace the least recently used entry. */
+    gs_aes_keyCacheStats.l_miss++;
+    ps_entry = ps_lru;
+    MEMCPY(ps_entry->ac_enkey, pc_key, EFM_AES_KEY_LEN);
+    AES_DecryptKey128(ps_entry->ac_dekey, ps_entry->ac_enkey);
+  } /* if ... else */
+
+  ps_entry->l_lastUse = ++gl_aes_keyCacheTime;
+
+  return ps_entry;
+} /* loc_aes_keyCacheGet() */
 
 /*==============================================================================
                             FUNCTIONS
@@ -50,8 +151,15 @@ static uint8_t gac_enkey[EFM_AES_KEY_LEN];
 /*============================================================================*/
 bool_t wmbus_hal_aes_init(void)
 {
-  MEMSET(gac_enkey, 0U, EFM_AES_KEY_LEN);
+  MEMSET(gas_aes_keyCache, 0U, sizeof(gas_aes_keyCache));
+  MEMSET(&gs_aes_keyCacheStats, 0U, sizeof(gs_aes_keyCacheStats));
+  gl_aes_keyCacheTime = 0U;
   CMU_ClockEnable (cmuClock_AES, true);
+
+  /* Until a key is set the zero key is active, as before the cache. Its
+     decryption key is derived here, the entry stays unused for lookups. */
+  gps_aes_key = &gas_aes_keyCache[0];
+  AES_DecryptKey128(gps_aes_key->ac_dekey, gps_aes_key->ac_enkey);
   return TRUE;
 } /* wmbus_hal_aes_init */
 
@@ -64,7 +172,8 @@ bool_t wmbus_hal_aes_setKey(const uint8_t* pc_key)
 
   if(pc_key)
   {
-    MEMCPY(gac_enkey, pc_key, EFM_AES_KEY_LEN);
+    /* The decryption key is derived only if the key is not cached yet. */
+    gps_aes_key = loc_aes_keyCacheGet(pc_key);
     b_ret = TRUE;
   } /* if */
 
@@ -77,19 +186,18 @@ bool_t wmbus_hal_aes_setKey(const uint8_t* pc_key)
 bool_t wmbus_hal_aes_cbcDecrypt(const uint8_t* pc_in, uint8_t* pc_out,
                                  uint16_t n_block, uint8_t* pc_iv)
 {
-  bool_t b_ret = FALSE; 
-  uint8_t ac_dekey[EFM_AES_KEY_LEN];
-  uint8_t ac_out[EFM_AES_BLOCK_LEN];
+  bool_t b_ret = FALSE;
 
-  if(pc_in && pc_out && pc_iv)
+  if(pc_in && pc_out && pc_iv && (n_block > 0U))
   {
-    AES_DecryptKey128(ac_dekey, gac_enkey);
-    AES_CBC128(ac_out, pc_in, EFM_AES_KEY_LEN, ac_dekey, pc_iv, 0);
-    MEMCPY(pc_out, ac_out, EFM_AES_BLOCK_LEN);
+    /* The IV is chained from block to block by the hardware. The output may
+       overwrite the input, as the previous ciphertext block is buffered. */
+    AES_CBC128(pc_out, pc_in, (unsigned int)n_block * EFM_AES_BLOCK_LEN,
+               gps_aes_key->ac_dekey, pc_iv, false);
     b_ret = TRUE;
   } /* if */
-  
-  return b_ret;  
+
+  return b_ret;
 } /* wmbus_hal_aes_cbcDecrypt */
 
 /*============================================================================*/
@@ -99,27 +207,214 @@ bool_t wmbus_hal_aes_cbcEncrypt(const uint8_t* pc_in, uint8_t* pc_out,
                                  uint16_t n_block, uint8_t* pc_iv)
 {
   bool_t b_ret = FALSE;
-  uint8_t ac_out[EFM_AES_BLOCK_LEN];
 
-  if(pc_in && pc_out && pc_iv)
+  if(pc_in && pc_out && pc_iv && (n_block > 0U))
   {
-    AES_CBC128(ac_out, pc_in, EFM_AES_KEY_LEN, gac_enkey, pc_iv, 1);
-    MEMCPY(pc_out, ac_out, EFM_AES_BLOCK_LEN);
-    wmbus_hal_aes_cbcDecrypt(pc_out, ac_out,1, pc_iv);
+    AES_CBC128(pc_out, pc_in, (unsigned int)n_block * EFM_AES_BLOCK_LEN,
+               gps_aes_key->ac_enkey, pc_iv, true);
     b_ret = TRUE;
-  } /* if */ 
-  
+  } /* if */
 
   return b_ret;
 } /* wmbus_hal_aes_cbcEncrypt */
 
+/*============================================================================*/
+/* wmbus_hal_aes_ctrEncrypt() */
+/*============================================================================*/
+bool_t wmbus_hal_aes_ctrEncrypt(const uint8_t* pc_in, uint8_t* pc_out,
+                                 uint8_t c_len, uint8_t* pc_iv)
+{
+  bool_t b_ret = FALSE;
+  uint8_t c_full;
+  uint8_t i;
+  uint32_t al_stream[EFM_AES_BLOCK_LEN / 4U];
+
+  if(pc_in && pc_out && pc_iv)
+  {
+    /* All the complete blocks are processed at once by the hardware. The
+       counter block is incremented in place, so consecutive calls continue
+       the key stream. */
+    c_full = c_len - (c_len % EFM_AES_BLOCK_LEN);
+    if(c_full > 0U)
+    {
+      AES_CTR128(pc_out, pc_in, c_full, gps_aes_key->ac_enkey, pc_iv,
+                 AES_CTRUpdate32Bit);
+    } /* if */
+
+    /* A trailing partial block uses the beginning of the next key stream
+       block only. */
+    if(c_full < c_len)
+    {
+      AES_ECB128((uint8_t*)al_stream, pc_iv, EFM_AES_BLOCK_LEN,
+                 gps_aes_key->ac_enkey, true);
+      AES_CTRUpdate32Bit(pc_iv);
+      for(i = c_full; i < c_len; i++)
+      {
+        pc_out[i] = pc_in[i] ^ ((uint8_t*)al_stream)[i - c_full];
+      } /* for */
+    } /* if */
+
+    b_ret = TRUE;
+  } /* if */
+
+  return b_ret;
+} /* wmbus_hal_aes_ctrEncrypt */
+
+/*============================================================================*/
+/* wmbus_hal_aes_ctrDecrypt() */
+/*============================================================================*/
+bool_t wmbus_hal_aes_ctrDecrypt(const uint8_t* pc_in, uint8_t* pc_out,
+                                 uint8_t c_len, uint8_t* pc_iv)
+{
+  /* CTR decryption is identical to the encryption. */
+  return wmbus_hal_aes_ctrEncrypt(pc_in, pc_out, c_len, pc_iv);
+} /* wmbus_hal_aes_ctrDecrypt */
+
 /*============================================================================*/
 /* wmbus_hal_aes_encrypt() */
 /*============================================================================*/
 bool_t wmbus_hal_aes_encrypt(const uint8_t* pc_in, uint8_t* pc_out)
 {
-  return FALSE;
-}
+  bool_t b_ret = FALSE;
+
+  if(pc_in && pc_out)
+  {
+    AES_ECB128(pc_out, pc_in, EFM_AES_BLOCK_LEN, gps_aes_key->ac_enkey, true);
+    b_ret = TRUE;
+  } /* if */
+
+  return b_ret;
+} /* wmbus_hal_aes_encrypt */
+
+/*============================================================================*/
+/* wmbus_hal_aes_decrypt() */
+/*============================================================================*/
+bool_t wmbus_hal_aes_decrypt(const uint8_t* pc_in, uint8_t* pc_out)
+{
+  bool_t b_ret = FALSE;
+
+  if(pc_in && pc_out)
+  {
+    AES_ECB128(pc_out, pc_in, EFM_AES_BLOCK_LEN, gps_aes_key->ac_dekey, false);
+    b_ret = TRUE;
+  } /* if */
+
+  return b_ret;
+} /* wmbus_hal_aes_decrypt */
+
+/*============================================================================*/
+/* sf_hal_aes_cmac() */
+/*============================================================================*/
+bool_t sf_hal_aes_cmac(const uint8_t* pc_in, uint16_t i_len, uint8_t* pc_mac)
+{
+  bool_t b_ret = FALSE;
+  /* Word aligned buffers, as required by the EFM32LIB AES functions. */
+  uint32_t al_subkey[EFM_AES_BLOCK_LEN / 4U];
+  uint32_t al_block[EFM_AES_BLOCK_LEN / 4U];
+  uint8_t* pc_subkey = (uint8_t*)al_subkey;
+  uint8_t* pc_block = (uint8_t*)al_block;
+  uint32_t al_chunk[AES_CMAC_CHUNK_LEN / 4U];
+  uint8_t* pc_chunk = (uint8_t*)al_chunk;
+  uint16_t i_chunk;
+  uint8_t c_lastLen;
+  uint8_t c_msb;
+  uint8_t c_run;
+  uint8_t i;
+
+  if((pc_in || (i_len == 0U)) && pc_mac)
+  {
+    /* Derive subkey K1 from L = AES(K, 0) as described in RFC 4493. */
+    MEMSET(pc_block, 0U, EFM_AES_BLOCK_LEN);
+    AES_ECB128(pc_subkey, pc_block, EFM_AES_BLOCK_LEN,
+               gps_aes_key->ac_enkey, true);
+    /* The last block is complete unless the message is empty or not a
+       multiple of the block length. In that case it is padded and subkey
+       K2 is used, which requires a second doubling. */
+    c_lastLen = (uint8_t)(i_len % EFM_AES_BLOCK_LEN);
+    if((c_lastLen == 0U) && (i_len > 0U))
+    {
+      c_lastLen = EFM_AES_BLOCK_LEN;
+      c_run = 1U;
+    }
+    else
+    {
+      c_run = 2U;
+    } /* if ... else */
+    while(c_run-- > 0U)
+    {
+      c_msb = pc_subkey[0] & 0x80U;
+      for(i = 0U; i < (EFM_AES_BLOCK_LEN - 1U); i++)
+      {
+        pc_subkey[i] = (uint8_t)((pc_subkey[i] << 1U) |
+                                 (pc_subkey[i + 1U] >> 7U));
+      } /* for */
+      pc_subkey[EFM_AES_BLOCK_LEN - 1U] <<= 1U;
+      if(c_msb)
+      {
+        pc_subkey[EFM_AES_BLOCK_LEN - 1U] ^= 0x87U;
+      } /* if */
+    } /* while */
+
+    /* CBC-MAC over all but the last block, done by the hardware with a zero
+       IV. The input is copied chunk wise into a word aligned buffer, the
+       last encrypted block of a chunk is the IV of the next one. */
+    while(i_len > c_lastLen)
+    {
+      i_chunk = i_len - c_lastLen;
+      if(i_chunk > AES_CMAC_CHUNK_LEN)
+      {
+        i_chunk = AES_CMAC_CHUNK_LEN;
+      } /* if */
+      MEMCPY(pc_chunk, pc_in, i_chunk);
+      AES_CBC128(pc_chunk, pc_chunk, i_chunk, gps_aes_key->ac_enkey,
+                 pc_block, true);
+      MEMCPY(pc_block, &pc_chunk[i_chunk - EFM_AES_BLOCK_LEN],
+             EFM_AES_BLOCK_LEN);
+      pc_in += i_chunk;
+      i_len -= i_chunk;
+    } /* while */
+
+    /* Last block, padded if required and masked with the subkey. */
+    for(i = 0U; i < EFM_AES_BLOCK_LEN; i++)
+    {
+      if(i < c_lastLen)
+      {
+        pc_block[i] ^= pc_in[i];
+      }
+      else if(i == c_lastLen)
+      {
+        pc_block[i] ^= 0x80U;
+      } /* if ... else if */
+      pc_block[i] ^= pc_subkey[i];
+    } /* for */
+    AES_ECB128(pc_block, pc_block, EFM_AES_BLOCK_LEN,
+               gps_aes_key->ac_enkey, true);
+
+    MEMCPY(pc_mac, pc_block, EFM_AES_BLOCK_LEN);
+    b_ret = TRUE;
+  } /* if */
+
+  return b_ret;
+} /* sf_hal_aes_cmac() */
+
+/*============================================================================*/
+/* sf_hal_aes_getCacheStats() */
+/*============================================================================*/
+void sf_hal_aes_getCacheStats(s_sf_hal_aes_cacheStats_t* ps_stats)
+{
+  if(ps_stats)
+  {
+    MEMCPY(ps_stats, &gs_aes_keyCacheStats, sizeof(s_sf_hal_aes_cacheStats_t));
+  } /* if */
+} /* sf_hal_aes_getCacheStats() */
+
+/*============================================================================*/
+/* sf_hal_aes_resetCacheStats() */
+/*============================================================================*/
+void sf_hal_aes_resetCacheStats(void)
+{
+  MEMSET(&gs_aes_keyCacheStats, 0U, sizeof(s_sf_hal_aes_cacheStats_t));
+} /* sf_hal_aes_resetCacheStats() */
 
 /**@}*/
 #ifdef __cplusplus
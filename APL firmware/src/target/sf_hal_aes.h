@@ -0,0 +1,64 @@
+#ifndef __SF_HAL_AES_H__
+#define __SF_HAL_AES_H__
+
+/**
+  @file       sf_hal_aes.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Target specific extensions of the AES HAL module.
+
+  @addtogroup WMBUS_HAL_AES
+
+  The AES HAL module caches the keys handed over by wmbus_hal_aes_setKey()
+  together with the derived decryption keys. The size of the cache is set by
+  AES_KEY_CACHE_RAM_BUDGET in bytes. The functions below provide the
+  statistics of the cache, e.g. to tune the budget for a collector.
+
+  Additionally the module provides the AES-CMAC (RFC 4493) required for the
+  key derivation and the authentication of OMS security profile B (mode 7).
+*/
+/**@{*/
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! Statistics of the key cache. */
+typedef struct S_SF_HAL_AES_CACHESTATS_T
+{
+  /*! Number of keys found within the cache. */
+  uint32_t l_hit;
+  /*! Number of keys which had to be derived. */
+  uint32_t l_miss;
+
+} s_sf_hal_aes_cacheStats_t;
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/**
+  @brief  Returns the statistics of the key cache.
+  @param  ps_stats  Pointer where to store the statistics.
+*/
+void sf_hal_aes_getCacheStats(s_sf_hal_aes_cacheStats_t* ps_stats);
+
+/**
+  @brief  Resets the hit and miss counters of the key cache.
+*/
+void sf_hal_aes_resetCacheStats(void);
+
+/**
+  @brief  Calculates the AES-CMAC of a message.
+          The CMAC is calculated using the key that is currently stored within
+          the HAL module, see wmbus_hal_aes_setKey().
+  @param  pc_in     Pointer to the message. May be NULL if i_len is zero.
+  @param  i_len     Length of the message in bytes.
+  @param  pc_mac    Pointer where to store the 16 bytes CMAC. The caller may
+                    truncate it as required, e.g. to 8 bytes for mode 7.
+  @return Returns @c TRUE if the CMAC has been calculated, @c FALSE in case
+          of invalid parameters.
+*/
+bool_t sf_hal_aes_cmac(const uint8_t* pc_in, uint16_t i_len, uint8_t* pc_mac);
+
+/**@}*/
+#endif /* __SF_HAL_AES_H__ */
@@ -0,0 +1,55 @@
+#ifndef __SF_HAL_LEUART_H__
+#define __SF_HAL_LEUART_H__
+
+/**
+  @file       sf_hal_leuart.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Target specific extensions of the LEUART HAL.
+
+  @addtogroup WMBUS_HAL_UART
+
+  By default the LEUART driver receives and transmits using the DMA. The
+  baud rate and the sizes of the ring buffers may be set by the board
+  configuration using UART_BAUDRATE, UART_BUFFER_RX_LEN and
+  UART_BUFFER_TX_LEN. The functions below provide the statistics of the
+  driver, e.g. to verify the buffers are sized for the traffic.
+*/
+/**@{*/
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! Statistics of the LEUART driver. */
+typedef struct S_SF_HAL_LEUART_STATS_T
+{
+  /*! Number of bytes read by the stack. */
+  uint32_t l_rxBytes;
+  /*! Number of bytes transmitted. */
+  uint32_t l_txBytes;
+  /*! Number of Rx buffer overflows detected. */
+  uint32_t l_rxOverflow;
+  /*! Number of received bytes lost due to Rx buffer overflows. */
+  uint32_t l_rxLost;
+  /*! Number of bytes rejected due to a full Tx buffer. */
+  uint32_t l_txRejected;
+
+} s_sf_hal_leuart_stats_t;
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/**
+  @brief  Returns the statistics of the LEUART driver.
+  @param  ps_stats  Pointer where to store the statistics.
+*/
+void sf_hal_leuart_getStats(s_sf_hal_leuart_stats_t* ps_stats);
+
+/**
+  @brief  Resets all counters of the LEUART driver statistics.
+*/
+void sf_hal_leuart_resetStats(void);
+
+/**@}*/
+#endif /* __SF_HAL_LEUART_H__ */
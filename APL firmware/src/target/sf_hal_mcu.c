@@ -19,6 +19,7 @@ extern "C" {
                             INCLUDE FILES
 ==============================================================================*/
 #include "inc\pub\utils\wmbus_typedefs.h"
+#include "sf_hal_mem.h"
 
 /*! Includes required by the EFM librarry */
 /**@{*/
@@ -87,6 +88,9 @@ bool_t wmbus_hal_mcu_init(void)
 /*============================================================================*/
 void wmbus_hal_mcu_reset(void)
 {
+  /** Data still pending, of the application included, is written first. */
+  sf_hal_mem_prepareReset();
+
   /** Forcing a system reset by using the system reset request provided by the
       EFM library. */
   NVIC_SystemReset();
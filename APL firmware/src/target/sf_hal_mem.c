@@ -7,11 +7,36 @@ extern "C" {
   @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
   @author     STACKFORCE
   @brief      HAL for access to non-volatile memory.
- 
+
   @addtogroup WMBUS_HAL_MEM
-  
+
   All these functions are implemented in `/src/target/`sf_hal_mem.c
 
+  The non-volatile memory is organized as an append-only log spread over
+  MEM_LOG_PAGES flash pages at the end of the flash. Each write appends
+  records holding the written bytes together with their offset, therefore
+  a page is only erased once it is completely used. A RAM mirror of the
+  memory is kept to serve the reads.
+
+  Layout of a page:
+  - Page header: magic, sequence number and page type.
+  - Records: header (offset, length and check byte), data padded to a
+    multiple of words and a commit marker.
+
+  The commit marker of a record is written last. Records without a commit
+  marker, e.g. due to a power failure, are ignored on startup.
+  The pages in use form a chain of consecutive sequence numbers, starting
+  with a base page. A base page holds a complete snapshot of the memory and
+  is valid only if its page type has been written after the snapshot.
+  As soon as all but one page are used, a new base page is written into the
+  remaining erased page and all other pages are erased afterwards.
+
+  The flash is not written by wmbus_hal_mem_write() itself. It updates the
+  RAM mirror and marks the changed blocks only. The records are written by
+  sf_hal_mem_process() in the background, one flash operation per call, and
+  without disabling the interrupts. Pages are erased only while the radio is
+  not busy, as the RF interrupt handlers located in the flash are stalled
+  by an erase.
 */
 /**@{*/
 
@@ -20,7 +45,10 @@ extern "C" {
                             INCLUDE FILES
 ==============================================================================*/
 #include "inc\pub\utils\wmbus_typedefs.h"
+#include "inc\pub\utils\wmbus_api.h"
 #include "inc\pub\hal\wmbus_hal_mem.h"
+#include "sf_hal_mem.h"
+#include "sf_hal_rf.h"
 
 #include "em_device.h"
 #include "em_msc.h"
@@ -43,11 +71,153 @@ extern "C" {
     can be specified by setting the MEM_FLASH_WRITE_RETRIES macro. */
 #define MEM_FLASH_WRITE_RETRIES   (3U)
 
+#ifndef MEM_SIZE
+/*! Size of the non-volatile memory as seen by the stack. The stack stores
+    its context and the meter list within the first 203 bytes. */
+#define MEM_SIZE                  (256U)
+#endif /* MEM_SIZE */
+
+#ifndef MEM_ASYNC_ENABLED
+/*! Writes the flash in the background by sf_hal_mem_process(). If disabled,
+    wmbus_hal_mem_write() returns after the data has been written. */
+#define MEM_ASYNC_ENABLED         TRUE
+#endif /* MEM_ASYNC_ENABLED */
+
+/*! Maximum number of data bytes of a single record. */
+#define MEM_LOG_RECORD_MAX_LEN    (64U)
+
+/*! Granularity of tracking the changes of the RAM mirror. */
+#define MEM_DIRTY_BLOCK_LEN       (8U)
+/*! Number of blocks of the RAM mirror. */
+#define MEM_DIRTY_BLOCKS          (MEM_SIZE / MEM_DIRTY_BLOCK_LEN)
+
 /** Setting macro for start address of flash to be used as non-volatile memory
-    for the stack. Usually using the very last flash page is preferred. */
-#define MEM_START_ADDR      (FLASH_SIZE - FLASH_PAGE_SIZE)
+    for the stack. Usually using the very last flash pages is preferred. */
+#define MEM_START_ADDR      (FLASH_SIZE - (MEM_LOG_PAGES * FLASH_PAGE_SIZE))
 /*! Setting macro for end address of flash. */
-#define MEM_END_ADDR        (MEM_START_ADDR + FLASH_PAGE_SIZE)
+#define MEM_END_ADDR        (FLASH_SIZE)
+/*! Start address of a page of the log. */
+#define MEM_PAGE_ADDR(x)    (MEM_START_ADDR + ((uint32_t)(x) * FLASH_PAGE_SIZE))
+
+/*! Content of an erased flash word. */
+#define MEM_LOG_ERASED            (0xFFFFFFFFU)
+/*! Marks a page as used by the log. */
+#define MEM_LOG_PAGE_MAGIC        (0x4D564E53U)
+/*! Page type of a page holding a complete snapshot of the memory. */
+#define MEM_LOG_PAGE_BASE         (0x45534142U)
+/*! Page type of a page continuing the log of the previous page. */
+#define MEM_LOG_PAGE_CONT         (0x544E4F43U)
+/*! Marker written after the data of a record. */
+#define MEM_LOG_RECORD_COMMIT     (0x544D4D43U)
+
+/*! Word index of the magic within the page header. */
+#define MEM_LOG_HDR_MAGIC         (0U)
+/*! Word index of the sequence number within the page header. */
+#define MEM_LOG_HDR_SEQ           (1U)
+/*! Word index of the page type within the page header. */
+#define MEM_LOG_HDR_TYPE          (2U)
+/*! Length of the page header in bytes. */
+#define MEM_LOG_HDR_LEN           (12U)
+
+/*! Number of words of a record carrying c_len data bytes, including the
+    record header and the commit marker. */
+#define MEM_LOG_RECORD_WORDS(c_len)   (2U + (((c_len) + 3U) / 4U))
+
+/*! Number of bytes required for a snapshot of the whole memory. */
+#define MEM_LOG_SNAPSHOT_LEN      (MEM_LOG_HDR_LEN + MEM_SIZE + \
+                                   (((MEM_SIZE + MEM_LOG_RECORD_MAX_LEN - 1U) \
+                                     / MEM_LOG_RECORD_MAX_LEN) * 8U))
+
+#if (MEM_LOG_PAGES < 2U)
+  #error At least two pages are required for the non-volatile memory.
+#endif
+
+#if ((MEM_SIZE % MEM_DIRTY_BLOCK_LEN) != 0U)
+  #error MEM_SIZE must be a multiple of MEM_DIRTY_BLOCK_LEN.
+#endif
+
+#if (MEM_SIZE > 0xFFFFU)
+  #error MEM_SIZE exceeds the offset range of the records.
+#endif
+
+/** A base page must leave space for further records after the snapshot. */
+#if ((MEM_LOG_SNAPSHOT_LEN + (MEM_LOG_RECORD_WORDS(MEM_LOG_RECORD_MAX_LEN) * \
+      4U)) > FLASH_PAGE_SIZE)
+  #error MEM_SIZE is too large for the flash page size.
+#endif
+
+/*==============================================================================
+                            ENUMS
+==============================================================================*/
+/*! States of the background processing. */
+typedef enum
+{
+  /*! Writes records of the changed blocks, if any. */
+  E_MEM_STATE_IDLE,
+  /*! Erases the page to write the new base page into. */
+  E_MEM_STATE_COMPACT_START,
+  /*! Copies the RAM mirror into the new base page. */
+  E_MEM_STATE_COMPACT_COPY,
+  /*! Erases the pages made obsolete by the new base page. */
+  E_MEM_STATE_COMPACT_CLEAN
+
+} E_MEM_STATE_t;
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! State of the log. */
+typedef struct S_MEM_LOG_T
+{
+  /*! State of the background processing. */
+  E_MEM_STATE_t e_state;
+  /*! Page the records are currently appended to. */
+  uint8_t c_page;
+  /*! Number of pages in use, starting with the base page. */
+  uint8_t c_used;
+  /*! Sequence number of the current page. */
+  uint32_t l_seq;
+  /*! Offset within the current page where to append the next record. */
+  uint16_t i_pos;
+  /*! Offset within the memory to be copied next into a new base page. */
+  uint16_t i_copy;
+  /*! Next page to be erased after a new base page has been written. */
+  uint8_t c_clean;
+  /*! Current page when starting to write a new base page. */
+  uint8_t c_prevPage;
+  /*! Sequence number of the current page when starting to write a new base
+      page. */
+  uint32_t l_prevSeq;
+  /*! Set if any flash operation failed since the last callback. */
+  bool_t b_error;
+
+} s_mem_log_t;
+
+/*==============================================================================
+                            LOCAL VARIABLES
+==============================================================================*/
+/*! RAM mirror of the non-volatile memory. */
+static uint8_t gac_mem_mirror[MEM_SIZE];
+
+/*! State of the log. */
+static s_mem_log_t gs_mem_log;
+
+/*! Buffer to assemble a record, word aligned as required by the MSC. */
+static uint32_t gal_mem_record[MEM_LOG_RECORD_WORDS(MEM_LOG_RECORD_MAX_LEN)];
+
+/*! Blocks of the RAM mirror not yet written to the flash, one bit each. */
+static uint8_t gac_mem_dirty[(MEM_DIRTY_BLOCKS + 7U) / 8U];
+
+/*! Called as soon as all the data has been written to the flash. */
+static fp_sf_hal_mem_done_t gfp_mem_done = NULL;
+
+/*! Called before a reset to write further data to the flash. */
+static fp_sf_hal_mem_reset_t gfp_mem_reset = NULL;
+
+/*! Statistics of the flash erases. */
+static s_sf_hal_mem_stats_t gs_mem_stats;
+/*! Set while an erase is deferred, to count it once. */
+static bool_t gb_mem_eraseDeferred = FALSE;
 
 /*==============================================================================
                             LOCAL FUNCTIONS
@@ -55,60 +225,332 @@ extern "C" {
 /*============================================================================*/
 /**
   @brief  Handles writing of data.
-          This function handles the write procedure to the flash.
-  @param  l_addr      Address within flash where to write data.
-  @param  pc_data     Pointer to the data to be written into flash.
-  @param  i_len       Number of bytes to copied from pc_data to l_addr.
-  @return Returns the number of written bytes.
-  @retval (0)         Returns zero in case write operation has failed.
+          This function handles the write procedure to the flash. The
+          interrupts are left enabled, MSC_WriteWord() is interrupt safe.
+  @param  l_addr      Word aligned address within flash where to write data.
+  @param  pl_data     Pointer to the data to be written into flash.
+  @param  i_len       Number of bytes to write, a multiple of four.
+  @return Returns @c TRUE if the data has been written.
 */
 /*============================================================================*/
-uint16_t loc_datamemory_writeData(uint32_t l_addr, uint8_t *pc_data, uint16_t i_len)
+static bool_t loc_mem_flashWrite(uint32_t l_addr, const uint32_t *pl_data,
+                                 uint16_t i_len)
 {
-  uint8_t c_retry_count;
-  msc_Return_TypeDef msc_ret;
-
-  /* disable interrupts */
-  __disable_irq();
-
-  /* init */
-  MSC_Init();
-  c_retry_count = 0;
-  msc_ret = mscReturnUnaligned;
+  uint8_t c_retry_count = 0U;
+  msc_Return_TypeDef msc_ret = mscReturnUnaligned;
 
-  /* Erase the page */
   while((c_retry_count < MEM_FLASH_WRITE_RETRIES) && (msc_ret != mscReturnOk))
   {
-    /* erase segment */
-    msc_ret = MSC_ErasePage((uint32_t *) l_addr);
+    MSC_Init();
+    msc_ret = MSC_WriteWord((uint32_t *) l_addr, (void const *) pl_data, i_len);
+    MSC_Deinit();
     c_retry_count++;
   } /* while */
 
-  /* reset counter */
-  c_retry_count = 0U;
-  msc_ret = mscReturnUnaligned;
+  return (bool_t)(msc_ret == mscReturnOk);
+} /* loc_mem_flashWrite() */
 
-  /* Write data to the userpage */
-  while((c_retry_count < MEM_FLASH_WRITE_RETRIES) && (msc_ret != mscReturnOk))
+/*============================================================================*/
+/**
+  @brief  Erases a page of the log.
+  @param  c_page      Page of the log to erase.
+  @return Returns @c TRUE if the page has been erased.
+*/
+/*============================================================================*/
+static bool_t loc_mem_flashErase(uint8_t c_page)
+{
+  return sf_hal_mem_erasePage((uint32_t *) MEM_PAGE_ADDR(c_page));
+} /* loc_mem_flashErase() */
+
+/*============================================================================*/
+/**
+  @brief  Checks a record header.
+  @param  l_hdr       Record header as read from the flash.
+  @param  pi_offset   Returns the offset of the record.
+  @param  pc_len      Returns the number of data bytes of the record.
+  @return Returns @c TRUE if the header is valid.
+*/
+/*============================================================================*/
+static bool_t loc_mem_recordHdrParse(uint32_t l_hdr, uint16_t *pi_offset,
+                                     uint8_t *pc_len)
+{
+  uint16_t i_offset = (uint16_t)(l_hdr & 0xFFFFU);
+  uint8_t c_len = (uint8_t)((l_hdr >> 16U) & 0xFFU);
+  uint8_t c_chk = (uint8_t)((l_hdr >> 24U) & 0xFFU);
+
+  *pi_offset = i_offset;
+  *pc_len = c_len;
+
+  return (bool_t)((c_chk == (uint8_t)~(i_offset ^ (i_offset >> 8U) ^ c_len)) &&
+                  (c_len > 0U) && (c_len <= MEM_LOG_RECORD_MAX_LEN) &&
+                  (((uint32_t)i_offset + c_len) <= MEM_SIZE));
+} /* loc_mem_recordHdrParse() */
+
+/*============================================================================*/
+/**
+  @brief  Appends a record to the current page.
+          The commit marker is written after the record, so the record is
+          taken into account on startup only if it has been written
+          completely.
+  @param  i_offset    Offset of the data within the memory.
+  @param  c_len       Number of bytes, at most MEM_LOG_RECORD_MAX_LEN.
+  @return Returns @c TRUE if the record has been written.
+*/
+/*============================================================================*/
+static bool_t loc_mem_recordWrite(uint16_t i_offset, uint8_t c_len)
+{
+  bool_t b_ret;
+  uint16_t i_words = MEM_LOG_RECORD_WORDS(c_len);
+  uint32_t l_addr = MEM_PAGE_ADDR(gs_mem_log.c_page) + gs_mem_log.i_pos;
+  uint32_t l_commit = MEM_LOG_RECORD_COMMIT;
+
+  /* Assemble header and data, the padding is left erased. */
+  MEMSET(gal_mem_record, 0xFFU, sizeof(gal_mem_record));
+  gal_mem_record[0] = (uint32_t)i_offset | ((uint32_t)c_len << 16U) |
+     ((uint32_t)(uint8_t)~(i_offset ^ (i_offset >> 8U) ^ c_len) << 24U);
+  MEMCPY(&gal_mem_record[1], &gac_mem_mirror[i_offset], c_len);
+
+  b_ret = loc_mem_flashWrite(l_addr, gal_mem_record, (i_words - 1U) * 4U);
+  if(b_ret)
   {
-    msc_ret = MSC_WriteWord((uint32_t *) l_addr, (void *) pc_data, i_len);
-    c_retry_count++;
+    b_ret = loc_mem_flashWrite(l_addr + ((i_words - 1U) * 4U), &l_commit, 4U);
+  } /* if */
+
+  /* The space is consumed even in case of an error. */
+  gs_mem_log.i_pos += i_words * 4U;
+
+  return b_ret;
+} /* loc_mem_recordWrite() */
+
+/*============================================================================*/
+/**
+  @brief  Writes the header of a page.
+  @param  c_page      Page of the log.
+  @param  l_seq       Sequence number of the page.
+  @param  l_type      Page type, MEM_LOG_ERASED to write it later on.
+  @return Returns @c TRUE if the header has been written.
+*/
+/*============================================================================*/
+static bool_t loc_mem_pageOpen(uint8_t c_page, uint32_t l_seq, uint32_t l_type)
+{
+  uint32_t al_hdr[MEM_LOG_HDR_LEN / 4U];
+
+  al_hdr[MEM_LOG_HDR_MAGIC] = MEM_LOG_PAGE_MAGIC;
+  al_hdr[MEM_LOG_HDR_SEQ] = l_seq;
+  al_hdr[MEM_LOG_HDR_TYPE] = l_type;
+
+  gs_mem_log.c_page = c_page;
+  gs_mem_log.l_seq = l_seq;
+  gs_mem_log.i_pos = MEM_LOG_HDR_LEN;
+
+  return loc_mem_flashWrite(MEM_PAGE_ADDR(c_page), al_hdr, MEM_LOG_HDR_LEN);
+} /* loc_mem_pageOpen() */
+
+/*============================================================================*/
+/**
+  @brief  Performs a single step of writing a new base page.
+          The whole RAM mirror is written into the erased page following the
+          current one. Once the snapshot is complete, all other pages are
+          erased.
+  @return Returns @c TRUE if the step has been performed successfully.
+*/
+/*============================================================================*/
+static bool_t loc_mem_compactStep(void)
+{
+  bool_t b_ret = TRUE;
+  uint32_t l_type = MEM_LOG_PAGE_BASE;
+  uint8_t c_page;
+  uint8_t c_len;
+
+  switch(gs_mem_log.e_state)
+  {
+    case E_MEM_STATE_COMPACT_START:
+      /* The snapshot contains all the changes made so far. */
+      MEMSET(gac_mem_dirty, 0U, sizeof(gac_mem_dirty));
+      gs_mem_log.c_prevPage = gs_mem_log.c_page;
+      gs_mem_log.l_prevSeq = gs_mem_log.l_seq;
+      c_page = (uint8_t)((gs_mem_log.c_page + 1U) % MEM_LOG_PAGES);
+      /* The page is erased unless a previous compaction has been
+         interrupted. */
+      b_ret = loc_mem_flashErase(c_page);
+      if(b_ret)
+      {
+        b_ret = loc_mem_pageOpen(c_page, gs_mem_log.l_seq + 1U,
+                                 MEM_LOG_ERASED);
+      } /* if */
+      gs_mem_log.i_copy = 0U;
+      gs_mem_log.e_state = E_MEM_STATE_COMPACT_COPY;
+      break;
+
+    case E_MEM_STATE_COMPACT_COPY:
+      c_len = MEM_LOG_RECORD_MAX_LEN;
+      if((MEM_SIZE - gs_mem_log.i_copy) < c_len)
+      {
+        c_len = (uint8_t)(MEM_SIZE - gs_mem_log.i_copy);
+      } /* if */
+      b_ret = loc_mem_recordWrite(gs_mem_log.i_copy, c_len);
+      gs_mem_log.i_copy += c_len;
+
+      if(b_ret && (gs_mem_log.i_copy >= MEM_SIZE))
+      {
+        /* Validate the snapshot. From now on the other pages are
+           obsolete. */
+        b_ret = loc_mem_flashWrite(MEM_PAGE_ADDR(gs_mem_log.c_page) +
+                                   (MEM_LOG_HDR_TYPE * 4U), &l_type, 4U);
+        if(b_ret)
+        {
+          gs_mem_log.c_used = 1U;
+          gs_mem_log.c_clean = 0U;
+          gs_mem_log.e_state = E_MEM_STATE_COMPACT_CLEAN;
+        } /* if */
+      } /* if */
+      break;
+
+    case E_MEM_STATE_COMPACT_CLEAN:
+      if(gs_mem_log.c_clean == gs_mem_log.c_page)
+      {
+        gs_mem_log.c_clean++;
+      } /* if */
+      if(gs_mem_log.c_clean < MEM_LOG_PAGES)
+      {
+        b_ret = loc_mem_flashErase(gs_mem_log.c_clean);
+        gs_mem_log.c_clean++;
+      } /* if */
+      if(gs_mem_log.c_clean >= MEM_LOG_PAGES)
+      {
+        gs_mem_log.e_state = E_MEM_STATE_IDLE;
+      } /* if */
+      break;
+
+    default:
+      gs_mem_log.e_state = E_MEM_STATE_IDLE;
+      break;
+  } /* switch */
+
+  if((b_ret == FALSE) && (gs_mem_log.e_state != E_MEM_STATE_COMPACT_CLEAN))
+  {
+    /* Start over writing the base page into the same page again. The
+       former pages are still valid. */
+    gs_mem_log.c_page = gs_mem_log.c_prevPage;
+    gs_mem_log.l_seq = gs_mem_log.l_prevSeq;
+    gs_mem_log.e_state = E_MEM_STATE_COMPACT_START;
+  } /* if */
+
+  return b_ret;
+} /* loc_mem_compactStep() */
+
+/*============================================================================*/
+/**
+  @brief  Writes the next record of changed blocks.
+          Consecutive changed blocks are combined into a single record.
+  @return Returns @c TRUE if the record has been written.
+*/
+/*============================================================================*/
+static bool_t loc_mem_recordNext(void)
+{
+  bool_t b_ret = TRUE;
+  uint16_t i_block = 0U;
+  uint16_t i_end;
+  uint8_t c_len;
+
+  while((i_block < MEM_DIRTY_BLOCKS) &&
+        ((gac_mem_dirty[i_block / 8U] & (1U << (i_block % 8U))) == 0U))
+  {
+    i_block++;
   } /* while */
 
-  if (mscReturnOk != msc_ret)
+  if(i_block < MEM_DIRTY_BLOCKS)
   {
-    i_len = 0;
-  }
+    i_end = i_block;
+    while((i_end < MEM_DIRTY_BLOCKS) &&
+          (((i_end - i_block) * MEM_DIRTY_BLOCK_LEN) < MEM_LOG_RECORD_MAX_LEN) &&
+          ((gac_mem_dirty[i_end / 8U] & (1U << (i_end % 8U))) != 0U))
+    {
+      i_end++;
+    } /* while */
+    c_len = (uint8_t)((i_end - i_block) * MEM_DIRTY_BLOCK_LEN);
+
+    if((gs_mem_log.i_pos + (MEM_LOG_RECORD_WORDS(c_len) * 4U)) >
+       FLASH_PAGE_SIZE)
+    {
+      if(gs_mem_log.c_used < (MEM_LOG_PAGES - 1U))
+      {
+        /* Continue the log on the next page. */
+        b_ret = loc_mem_pageOpen(
+                  (uint8_t)((gs_mem_log.c_page + 1U) % MEM_LOG_PAGES),
+                  gs_mem_log.l_seq + 1U, MEM_LOG_PAGE_CONT);
+        gs_mem_log.c_used++;
+      }
+      else
+      {
+        /* The snapshot contains the changed blocks as well. */
+        gs_mem_log.e_state = E_MEM_STATE_COMPACT_START;
+        c_len = 0U;
+      } /* if ... else */
+    } /* if */
+
+    if(b_ret && (c_len > 0U))
+    {
+      for(i_end = i_block;
+          i_end < (i_block + (c_len / MEM_DIRTY_BLOCK_LEN)); i_end++)
+      {
+        gac_mem_dirty[i_end / 8U] &= (uint8_t)~(1U << (i_end % 8U));
+      } /* for */
+      b_ret = loc_mem_recordWrite(i_block * MEM_DIRTY_BLOCK_LEN, c_len);
+    } /* if */
+
+    if(b_ret == FALSE)
+    {
+      /* Rewrite all the data into a new base page. */
+      gs_mem_log.e_state = E_MEM_STATE_COMPACT_START;
+    } /* if */
+  } /* if */
+
+  return b_ret;
+} /* loc_mem_recordNext() */
+
+/*============================================================================*/
+/**
+  @brief  Replays the records of a page into the RAM mirror.
+  @param  c_page      Page of the log.
+  @return Offset within the page behind the last record.
+*/
+/*============================================================================*/
+static uint16_t loc_mem_pageReplay(uint8_t c_page)
+{
+  const uint32_t *pl_page = (const uint32_t *) MEM_PAGE_ADDR(c_page);
+  uint16_t i_pos = MEM_LOG_HDR_LEN;
+  uint16_t i_words;
+  uint16_t i_offset;
+  uint8_t c_len;
 
-  /* de-init */
-  MSC_Deinit();
+  while((i_pos + 4U) <= FLASH_PAGE_SIZE)
+  {
+    if(pl_page[i_pos / 4U] == MEM_LOG_ERASED)
+    {
+      /* End of the log. */
+      break;
+    } /* if */
 
-  /* reenable interrupts*/
-  __enable_irq();
+    if((loc_mem_recordHdrParse(pl_page[i_pos / 4U], &i_offset, &c_len)
+        == FALSE) ||
+       ((i_pos + (MEM_LOG_RECORD_WORDS(c_len) * 4U)) > FLASH_PAGE_SIZE))
+    {
+      /* The rest of the page is unusable, continue on the next one. */
+      i_pos = FLASH_PAGE_SIZE;
+      break;
+    } /* if */
 
-  return i_len;
-} /* loc_datamemory_writeData() */
+    i_words = MEM_LOG_RECORD_WORDS(c_len);
+    if(pl_page[(i_pos / 4U) + i_words - 1U] == MEM_LOG_RECORD_COMMIT)
+    {
+      MEMCPY(&gac_mem_mirror[i_offset], &pl_page[(i_pos / 4U) + 1U], c_len);
+    } /* if */
+    i_pos += i_words * 4U;
+  } /* while */
 
+  return i_pos;
+} /* loc_mem_pageReplay() */
 
 /*==============================================================================
                             FUNCTIONS
@@ -118,114 +560,334 @@ uint16_t loc_datamemory_writeData(uint32_t l_addr, uint8_t *pc_data, uint16_t i_
 /*============================================================================*/
 bool_t wmbus_hal_mem_init(void)
 {
-  return TRUE;
+  bool_t b_ret = TRUE;
+  bool_t b_found = FALSE;
+  uint8_t c_base = 0U;
+  uint8_t c_page;
+  uint8_t i;
+  const uint32_t *pl_page;
+
+  MEMSET(gac_mem_mirror, 0xFFU, MEM_SIZE);
+  MEMSET(gac_mem_dirty, 0U, sizeof(gac_mem_dirty));
+  MEMSET(&gs_mem_log, 0U, sizeof(gs_mem_log));
+  gs_mem_log.e_state = E_MEM_STATE_IDLE;
+
+  /* Find the most recent base page. */
+  for(i = 0U; i < MEM_LOG_PAGES; i++)
+  {
+    pl_page = (const uint32_t *) MEM_PAGE_ADDR(i);
+    if((pl_page[MEM_LOG_HDR_MAGIC] == MEM_LOG_PAGE_MAGIC) &&
+       (pl_page[MEM_LOG_HDR_TYPE] == MEM_LOG_PAGE_BASE) &&
+       ((b_found == FALSE) ||
+        ((int32_t)(pl_page[MEM_LOG_HDR_SEQ] - gs_mem_log.l_seq) > 0)))
+    {
+      b_found = TRUE;
+      c_base = i;
+      gs_mem_log.l_seq = pl_page[MEM_LOG_HDR_SEQ];
+    } /* if */
+  } /* for */
+
+  if(b_found)
+  {
+    /* Replay the base page and all the pages continuing it. */
+    gs_mem_log.c_page = c_base;
+    gs_mem_log.i_pos = loc_mem_pageReplay(c_base);
+    gs_mem_log.c_used = 1U;
+
+    for(i = 1U; i < MEM_LOG_PAGES; i++)
+    {
+      c_page = (uint8_t)((c_base + i) % MEM_LOG_PAGES);
+      pl_page = (const uint32_t *) MEM_PAGE_ADDR(c_page);
+      if((pl_page[MEM_LOG_HDR_MAGIC] == MEM_LOG_PAGE_MAGIC) &&
+         (pl_page[MEM_LOG_HDR_SEQ] == (gs_mem_log.l_seq + 1U)) &&
+         (pl_page[MEM_LOG_HDR_TYPE] == MEM_LOG_PAGE_CONT))
+      {
+        gs_mem_log.c_page = c_page;
+        gs_mem_log.l_seq++;
+        gs_mem_log.i_pos = loc_mem_pageReplay(c_page);
+        gs_mem_log.c_used++;
+      }
+      else
+      {
+        break;
+      } /* if ... else */
+    } /* for */
+
+    /* Pages not belonging to the chain are obsolete, e.g. an interrupted
+       compaction. Erase them to keep the following page available. */
+    for(i = gs_mem_log.c_used; (i < MEM_LOG_PAGES) && b_ret; i++)
+    {
+      b_ret = loc_mem_flashErase((uint8_t)((c_base + i) % MEM_LOG_PAGES));
+    } /* for */
+  }
+  else
+  {
+    pl_page = (const uint32_t *)(FLASH_SIZE - FLASH_PAGE_SIZE);
+    if(pl_page[MEM_LOG_HDR_MAGIC] != MEM_LOG_PAGE_MAGIC)
+    {
+      /* Take over the data written by former firmware versions, which used
+         the very last flash page without any log structure. It is kept
+         until the first base page has been written. */
+      MEMCPY(gac_mem_mirror, (const uint8_t *)(FLASH_SIZE - FLASH_PAGE_SIZE),
+             MEM_SIZE);
+    } /* if */
+    gs_mem_log.c_page = MEM_LOG_PAGES - 1U;
+    gs_mem_log.e_state = E_MEM_STATE_COMPACT_START;
+    b_ret = sf_hal_mem_flush();
+  } /* if ... else */
+
+  return b_ret;
 } /* wmbus_hal_mem_init() */
 
 /*============================================================================*/
 /* wmbus_hal_mem_write() */
 /*============================================================================*/
-uint16_t wmbus_hal_mem_write(uint8_t *pu8_data, uint16_t u16_len, 
+uint16_t wmbus_hal_mem_write(uint8_t *pu8_data, uint16_t u16_len,
                           uint32_t u32_addr)
 {
   uint16_t u16_ret = 0;
   /* Counter variable. */
   uint16_t i;
-  /* Start of the segment to write into. */
-  uint8_t *pu8_memory;
-  /* Number of written bytes. */
-  uint16_t u16_tmpLen;
-  /* Address of the first segment. */
-  uint32_t l_addrSegmStart;
+  uint16_t i_block;
+  uint8_t c_data;
 
-  uint32_t l_addrSegmStartShortMemory;
-  /* Temporary data buffer. */
-  static uint8_t u8_segment[FLASH_PAGE_SIZE];
+  if((u32_addr + u16_len) <= MEM_SIZE)
+  {
+    /* Update the mirror. Unchanged data does not need to be written. */
+    for(i = 0U; i < u16_len; i++)
+    {
+      c_data = (pu8_data == NULL) ? 0U : pu8_data[i];
+      if(gac_mem_mirror[u32_addr + i] != c_data)
+      {
+        gac_mem_mirror[u32_addr + i] = c_data;
+        i_block = (uint16_t)((u32_addr + i) / MEM_DIRTY_BLOCK_LEN);
+        gac_mem_dirty[i_block / 8U] |= (uint8_t)(1U << (i_block % 8U));
+      } /* if */
+    } /* for */
+    u16_ret = u16_len;
+
+    #if !MEM_ASYNC_ENABLED
+    if(sf_hal_mem_flush() == FALSE)
+    {
+      u16_ret = 0U;
+    } /* if */
+    #endif /* !MEM_ASYNC_ENABLED */
+  } /* if */
 
-  u32_addr += MEM_START_ADDR;
+  return u16_ret;
+} /* wmbus_hal_mem_write() */
 
-  if((u32_addr + u16_len) <= FLASH_SIZE)
+/*============================================================================*/
+/* wmbus_hal_mem_read() */
+/*============================================================================*/
+uint16_t wmbus_hal_mem_read(uint8_t *pu8_data, uint16_t u16_len, uint32_t u32_addr)
+{
+  uint16_t u16_ret = 0;
+
+  if((pu8_data != NULL) && ((u32_addr + u16_len) <= MEM_SIZE))
+  {
+    /* The mirror always reflects the content of the flash. */
+    MEMCPY(pu8_data, &gac_mem_mirror[u32_addr], u16_len);
+    u16_ret = u16_len;
+  } /* if */
+
+  return u16_ret;
+} /* wmbus_hal_mem_read() */
+
+/*============================================================================*/
+/* sf_hal_mem_process() */
+/*============================================================================*/
+bool_t sf_hal_mem_process(void)
+{
+  bool_t b_busy = sf_hal_mem_isBusy();
+  bool_t b_ret = TRUE;
+
+  if(b_busy && (gs_mem_log.e_state != E_MEM_STATE_IDLE) &&
+     (gs_mem_log.e_state != E_MEM_STATE_COMPACT_COPY) &&
+     (sf_hal_mem_eraseAllowed() == FALSE))
   {
-    l_addrSegmStart = u32_addr; /* Start of flash memory. */
+    /* The step erases a page, wait for the radio to get idle. */
+    return b_busy;
+  } /* if */
 
-    while((l_addrSegmStart % FLASH_PAGE_SIZE) != 0U)
+  if(b_busy)
+  {
+    if(gs_mem_log.e_state == E_MEM_STATE_IDLE)
     {
-      l_addrSegmStart--;
-    } /* while */
+      b_ret = loc_mem_recordNext();
+    }
+    else
+    {
+      b_ret = loc_mem_compactStep();
+    } /* if ... else */
 
-    /* Calculates the start to overwrite of the first segment. */
-    u32_addr %= FLASH_PAGE_SIZE;
+    if(b_ret == FALSE)
+    {
+      gs_mem_log.b_error = TRUE;
+    } /* if */
 
-    u16_tmpLen = 0;
-    /* Copies p_data into the flash. Allows overwriting of several segments. */
-    while(u16_tmpLen < u16_len)
+    b_busy = sf_hal_mem_isBusy();
+    if((b_busy == FALSE) && (gfp_mem_done != NULL))
     {
-      l_addrSegmStartShortMemory = l_addrSegmStart & 0xFFFFFFFFU;
-      pu8_memory = (uint8_t*) l_addrSegmStartShortMemory;
+      gfp_mem_done((bool_t)(gs_mem_log.b_error == FALSE));
+    } /* if */
+    if(b_busy == FALSE)
+    {
+      gs_mem_log.b_error = FALSE;
+    } /* if */
+  } /* if */
 
-      /* Copies the current memory content into a temporary buffer. */
-      for(i = 0;i < FLASH_PAGE_SIZE;i++)
-      {
-        u8_segment[i] = pu8_memory[i];
-      } /* for */
+  return b_busy;
+} /* sf_hal_mem_process() */
 
-      /* Updates the current segment. */
-      for(i = 0;
-          u16_tmpLen < u16_len && (u32_addr + i) < FLASH_PAGE_SIZE;
-          i++)
-      {
-        if(pu8_data == NULL)
-        {
-          u8_segment[u32_addr + i] = 0U;
-        }
-        else
-        {
-          u8_segment[u32_addr + i] = pu8_data[u16_tmpLen];
-        } /* if ... else */
-        u16_tmpLen++;
-      } /* for */
+/*============================================================================*/
+/* sf_hal_mem_flush() */
+/*============================================================================*/
+bool_t sf_hal_mem_flush(void)
+{
+  bool_t b_ret = TRUE;
 
-      /* Writes the data to the flash memory. */
+  /* Stop on errors, the remaining data is retried in the background. */
+  while(sf_hal_mem_isBusy() && b_ret)
+  {
+    if(gs_mem_log.e_state == E_MEM_STATE_IDLE)
+    {
+      b_ret = loc_mem_recordNext();
+    }
+    else
+    {
+      b_ret = loc_mem_compactStep();
+    } /* if ... else */
+  } /* while */
 
-      u16_ret = loc_datamemory_writeData(l_addrSegmStart, u8_segment, FLASH_PAGE_SIZE);
-      if(FLASH_PAGE_SIZE == u16_ret)
-      {
-        u16_ret = u16_len;
-      }/* if */
-      l_addrSegmStart += FLASH_PAGE_SIZE;
-      u32_addr = 0U;
-    } /* while */
-  }
-  return u16_ret;
-} /* wmbus_hal_mem_write() */
+  return b_ret;
+} /* sf_hal_mem_flush() */
 
 /*============================================================================*/
-/* wmbus_hal_mem_read() */
+/* sf_hal_mem_isBusy() */
 /*============================================================================*/
-uint16_t wmbus_hal_mem_read(uint8_t *pu8_data, uint16_t u16_len, uint32_t u32_addr)
+bool_t sf_hal_mem_isBusy(void)
 {
-  uint16_t u16_ret = 0;
-  uint16_t i;
-  uint8_t* pc_nvm_addr;
+  bool_t b_busy = (bool_t)(gs_mem_log.e_state != E_MEM_STATE_IDLE);
+  uint8_t i;
+
+  for(i = 0U; (i < sizeof(gac_mem_dirty)) && (b_busy == FALSE); i++)
+  {
+    b_busy = (bool_t)(gac_mem_dirty[i] != 0U);
+  } /* for */
+
+  return b_busy;
+} /* sf_hal_mem_isBusy() */
+
+/*============================================================================*/
+/* sf_hal_mem_setCallback() */
+/*============================================================================*/
+void sf_hal_mem_setCallback(fp_sf_hal_mem_done_t fp_done)
+{
+  gfp_mem_done = fp_done;
+} /* sf_hal_mem_setCallback() */
+
+/*============================================================================*/
+/* sf_hal_mem_setResetCallback() */
+/*============================================================================*/
+void sf_hal_mem_setResetCallback(fp_sf_hal_mem_reset_t fp_reset)
+{
+  gfp_mem_reset = fp_reset;
+} /* sf_hal_mem_setResetCallback() */
+
+/*============================================================================*/
+/* sf_hal_mem_prepareReset() */
+/*============================================================================*/
+bool_t sf_hal_mem_prepareReset(void)
+{
+  bool_t b_ret = TRUE;
+
+  if(gfp_mem_reset != NULL)
+  {
+    b_ret = gfp_mem_reset();
+  } /* if */
+
+  /* The data of the non-volatile memory is written in any case. */
+  if(sf_hal_mem_flush() == FALSE)
+  {
+    b_ret = FALSE;
+  } /* if */
+
+  return b_ret;
+} /* sf_hal_mem_prepareReset() */
+
+/*============================================================================*/
+/* sf_hal_mem_eraseAllowed() */
+/*============================================================================*/
+bool_t sf_hal_mem_eraseAllowed(void)
+{
+  bool_t b_ret = (bool_t)(sf_hal_rf_isBusy() == FALSE);
 
-  u32_addr += MEM_START_ADDR;
+  if(b_ret)
+  {
+    gb_mem_eraseDeferred = FALSE;
+  }
+  else if(gb_mem_eraseDeferred == FALSE)
+  {
+    /* Counted once, the erase is polled until the radio is idle. */
+    gb_mem_eraseDeferred = TRUE;
+    gs_mem_stats.l_deferred++;
+  } /* if ... else if */
 
-  /* disable interrupts */
-  __disable_irq();
+  return b_ret;
+} /* sf_hal_mem_eraseAllowed() */
 
-  /* set address to read */
-  pc_nvm_addr = (uint8_t*)(u32_addr);
+/*============================================================================*/
+/* sf_hal_mem_erasePage() */
+/*============================================================================*/
+bool_t sf_hal_mem_erasePage(uint32_t *pl_page)
+{
+  uint8_t c_retry_count = 0U;
+  msc_Return_TypeDef msc_ret = mscReturnOk;
+  bool_t b_rfBusy;
+  uint16_t i;
 
-  for(i = 0; i < u16_len; i++)
+  /* Erasing takes a while, avoid it if the page is erased already. All the
+     words are checked, an interrupted erase may leave any of them set. */
+  for(i = 0U; (i < (FLASH_PAGE_SIZE / 4U)) && (msc_ret == mscReturnOk); i++)
   {
-    *pu8_data++ = *pc_nvm_addr++;
+    if(pl_page[i] != MEM_LOG_ERASED)
+    {
+      msc_ret = mscReturnUnaligned;
+    } /* if */
   } /* for */
 
-  /* reenable interrupts*/
-  __enable_irq();
+  if(msc_ret != mscReturnOk)
+  {
+    b_rfBusy = sf_hal_rf_isBusy();
+    gs_mem_stats.l_erases++;
 
-  u16_ret = u16_len;
-  return u16_ret;
-} /* wmbus_hal_mem_read() */
+    while((c_retry_count < MEM_FLASH_WRITE_RETRIES) &&
+          (msc_ret != mscReturnOk))
+    {
+      MSC_Init();
+      msc_ret = MSC_ErasePage(pl_page);
+      MSC_Deinit();
+      c_retry_count++;
+    } /* while */
+
+    if(!b_rfBusy && sf_hal_rf_isBusy())
+    {
+      /* A telegram started while the CPU was stalled. */
+      gs_mem_stats.l_radioStalls++;
+    } /* if */
+  } /* if */
+
+  return (bool_t)(msc_ret == mscReturnOk);
+} /* sf_hal_mem_erasePage() */
+
+/*============================================================================*/
+/* sf_hal_mem_getStats() */
+/*============================================================================*/
+void sf_hal_mem_getStats(s_sf_hal_mem_stats_t* ps_stats)
+{
+  *ps_stats = gs_mem_stats;
+} /* sf_hal_mem_getStats() */
 
 /**@}*/
 #ifdef __cplusplus
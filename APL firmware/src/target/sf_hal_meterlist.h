@@ -0,0 +1,146 @@
+#ifndef __SF_HAL_METERLIST_H__
+#define __SF_HAL_METERLIST_H__
+
+/**
+  @file       sf_hal_meterlist.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Persistent meter table for large meter lists.
+
+  @addtogroup WMBUS_HAL_MEM
+
+  The meter list of the stack is kept in the non-volatile memory and limited
+  to a few meters. Collectors managing more meters, e.g. installed by the
+  host, store them in this table instead. Each change of an entry is
+  appended to the flash as a record of its own, so adding or updating a
+  meter neither rewrites the other entries nor erases a page. Pages are
+  erased only once the space is used up and the entries still valid have
+  been moved out of the oldest page.
+
+  The entries are read directly from the flash. In RAM only the location of
+  the latest record of each meter is kept, 2 bytes per meter, which is
+  rebuilt by a single pass over the flash on startup.
+
+  The table is enabled by setting METERLIST_ENABLED to TRUE. Its pages are
+  located below the pages of the non-volatile memory. Other users of the
+  flash, e.g. the telegram log of the APL collector demo, have to be placed
+  below METERLIST_PAGES + MEM_LOG_PAGES pages from the end of the flash.
+  sf_hal_meterlist_getAddr() may be passed to wmbus_meterdir_init() to look
+  up meters by their address.
+*/
+/**@{*/
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+#ifndef METERLIST_ENABLED
+/*! Set to TRUE to provide the persistent meter table. */
+#define METERLIST_ENABLED             FALSE
+#endif /* METERLIST_ENABLED */
+
+#ifndef METERLIST_PAGES
+/*! Number of flash pages used for the table. */
+#define METERLIST_PAGES               (8U)
+#endif /* METERLIST_PAGES */
+
+#ifndef METERLIST_ENTRY_LEN
+/*! Length of an entry, the size of s_apl_meterEntry_t by default. An entry
+    has to start with the address of the meter. */
+#define METERLIST_ENTRY_LEN           (33U)
+#endif /* METERLIST_ENTRY_LEN */
+
+/*! Id returned if a meter could not be added. */
+#define METERLIST_ID_INVALID          (0xFFFFU)
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! Statistics of the meter table. */
+typedef struct S_SF_HAL_METERLIST_STATS_T
+{
+  /*! Number of records written, including the ones moved. */
+  uint32_t l_records;
+  /*! Number of records moved out of a page before erasing it. */
+  uint32_t l_moved;
+  /*! Number of pages erased. */
+  uint32_t l_erases;
+
+} s_sf_hal_meterlist_stats_t;
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/**
+  @brief  Restores the table from the flash. Has to be called once on
+          startup, before any other function of the table.
+  @return Returns @c FALSE if any of the flash operations failed.
+*/
+bool_t sf_hal_meterlist_init(void);
+
+/**
+  @brief  Adds a meter using the lowest free id. The caller has to make sure
+          the meter is not in the table already.
+  @param  pc_entry  Entry of the meter, METERLIST_ENTRY_LEN bytes.
+  @return Id of the meter, METERLIST_ID_INVALID if the table is full or the
+          entry could not be written.
+*/
+uint16_t sf_hal_meterlist_add(uint8_t *pc_entry);
+
+/**
+  @brief  Writes the entry of a meter, e.g. to update its key. The id may
+          be unused so far.
+  @param  i_meterId Id of the meter.
+  @param  pc_entry  Entry of the meter, METERLIST_ENTRY_LEN bytes.
+  @return Returns @c FALSE if the id is out of range or the entry could not
+          be written.
+*/
+bool_t sf_hal_meterlist_set(uint16_t i_meterId, uint8_t *pc_entry);
+
+/**
+  @brief  Removes a meter.
+  @param  i_meterId Id of the meter.
+  @return Returns @c FALSE if the id is not in use or the flash could not
+          be written.
+*/
+bool_t sf_hal_meterlist_remove(uint16_t i_meterId);
+
+/**
+  @brief  Reads the entry of a meter.
+  @param  i_meterId Id of the meter.
+  @param  pc_entry  Memory to write the entry to, METERLIST_ENTRY_LEN bytes.
+  @return Returns @c FALSE if the id is not in use.
+*/
+bool_t sf_hal_meterlist_get(uint16_t i_meterId, uint8_t *pc_entry);
+
+/**
+  @brief  Reads the address of a meter.
+  @param  i_meterId     Id of the meter.
+  @param  ps_meterAddr  Memory to write the address to.
+  @return Returns @c FALSE if the id is not in use.
+*/
+bool_t sf_hal_meterlist_getAddr(uint16_t i_meterId,
+                                s_wmbus_addr_t *ps_meterAddr);
+
+/**
+  @brief  Returns the number of meters in the table.
+*/
+uint16_t sf_hal_meterlist_getNum(void);
+
+/**
+  @brief  Performs the background processing of the table. Each call moves
+          a single record or erases a single page at most. Should be called
+          periodically, e.g. from the main loop of the application,
+          otherwise the work is done when writing an entry.
+  @return Returns @c TRUE as long as pages have to be freed.
+*/
+bool_t sf_hal_meterlist_process(void);
+
+/**
+  @brief  Returns the statistics of the table.
+  @param  ps_stats  Pointer where to store the statistics.
+*/
+void sf_hal_meterlist_getStats(s_sf_hal_meterlist_stats_t* ps_stats);
+
+/**@}*/
+#endif /* __SF_HAL_METERLIST_H__ */
@@ -14,6 +14,33 @@ extern "C" {
   delivery is designed for Silabs products only, all the RF driver interfaces
   are simply forwarded to the Si446x RF driver library.
   The implementation can be found in `/src/target/`sf_hal_rf.c.
+
+  The first interrupt of the radio after the reception has been (re)started
+  is the detection of the sync word. Its time is taken in the GPIO ISR and
+  assigned to the telegram once the driver reports the reception, see
+  sf_hal_rf_getRxTimestamp().
+
+  Images receiving with the 3 out of 6 and the NRZ mode C codecs, e.g. the
+  mode C collectors, listen for mode T and mode C meters at the same time.
+  Both use the same sync word at 100 kchip/s and the radio is kept in the
+  same RX configuration, thus no retuning is required. A mode C telegram
+  starts with HAL_RF_MODE_C_PREAMBLE_FIRST followed by the frame type,
+  whereas 0x54 is no valid start of a 3 out of 6 coded telegram. The first
+  two bytes read by the stack are used to detect the mode of each telegram,
+  see sf_hal_rf_getRxMode().
+
+  Switching between reception and transmission reprograms the radio with
+  the register settings of the other direction, which takes most of the
+  time between a received telegram and the response. The time spent in
+  wmbus_hal_rf_txInit() and in restarting the reception is measured, see
+  sf_hal_rf_getTurnaround().
+
+  The driver reports a critical error if the radio does not signal CTS in
+  time. The radio is then reset and the reception restarted from
+  wmbus_hal_rf_run(), outside of the driver. At most RF_RECOVERY_MAX resets
+  are done in a row, i.e. without a call of wmbus_hal_rf_run() in between
+  that found no new error. The stack is not informed, a transmission or
+  reception in progress is lost.
 */
 /**@{*/
 
@@ -26,7 +53,181 @@ extern "C" {
 #include "inc\pub\hal\wmbus_hal_rf.h"
 #include "sf_rf.h"
 #include "sf_hal_gpio.h"
+#include "sf_hal_spi.h"
+#include "sf_hal_rf.h"
+#include "sf_hal_tmr.h"
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! Set if the image receives mode T and mode C telegrams. */
+#define RF_RX_MODE_TC     (WMBUS_CHECK_RX_CODEC_or(WMBUS_PHY_RX_CODEC_3OUTOF6) \
+                           && WMBUS_CHECK_RX_CODEC_or(WMBUS_PHY_RX_CODEC_NRZ_C))
+
+/*! Number of bytes required to detect the mode of a telegram. */
+#define RF_RX_MODE_HEAD_LEN   2U
+
+#ifndef RF_RECOVERY_MAX
+/*! Number of resets done in a row to recover from critical errors. */
+#define RF_RECOVERY_MAX       3U
+#endif /* RF_RECOVERY_MAX */
+
+/*==============================================================================
+                            VARIABLES
+==============================================================================*/
+/*! Reception callback of the stack. */
+static fp_hal_rf_evt_rx gfp_rf_evtRx = NULL;
+/*! Timestamp of the first interrupt since the reception was started. */
+static uint32_t gl_rf_irqTimestamp;
+/*! Set if gl_rf_irqTimestamp has been taken. */
+static bool_t gb_rf_irqTimestampValid = FALSE;
+/*! Timestamp of the sync word of the telegram received last. */
+static uint32_t gl_rf_rxTimestamp;
+/*! Mode of the telegram received last. */
+static E_WMBUS_MODE_t ge_rf_rxMode = E_WMBUS_MODE_UNKNOWN;
+/*! Mode statistics of the received telegrams. */
+static s_sf_hal_rf_rxStats_t gs_rf_rxStats;
+#if RF_RX_MODE_TC
+/*! Number of bytes of the current telegram checked so far. */
+static uint8_t gc_rf_rxHeadLen = RF_RX_MODE_HEAD_LEN;
+/*! Mode the stack requested to tune the receiver for. */
+static E_WMBUS_MODE_t ge_rf_rxSenseTuning = E_WMBUS_MODE_C;
+#endif /* RF_RX_MODE_TC */
+/*! Measured times of switching between reception and transmission. */
+static s_sf_hal_rf_turnaround_t gs_rf_turnaround;
+/*! Set after a transmission until the reception is restarted. */
+static bool_t gb_rf_txDone = FALSE;
+/*! Set on a critical error of the driver until the radio is reset. */
+static volatile bool_t gb_rf_recover = FALSE;
+/*! Number of resets done in a row. */
+static uint8_t gc_rf_recoveries;
+/*! Statistics of the critical errors and the recoveries. */
+static s_sf_hal_rf_recoveryStats_t gs_rf_recoveryStats;
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+/**
+  @brief  Takes the timestamp of the first interrupt of the radio.
+          Called on entry of the GPIO ISRs.
+*/
+static void loc_rf_irqTimestamp(void)
+{
+  if(!gb_rf_irqTimestampValid)
+  {
+    gl_rf_irqTimestamp = sf_hal_tmr_getTimestamp();
+    gb_rf_irqTimestampValid = TRUE;
+  } /* if */
+} /* loc_rf_irqTimestamp() */
+
+/**
+  @brief  Stores a measured switching time.
+  @param  l_start       Timestamp taken before the switch.
+  @param  pi_last       Time of the last switch.
+  @param  pi_max        Longest time of a switch.
+*/
+static void loc_rf_turnaround(uint32_t l_start, uint16_t *pi_last,
+                              uint16_t *pi_max)
+{
+  uint32_t l_time = sf_hal_tmr_getTimestamp() - l_start;
+
+  if(l_time > 0xFFFFU)
+  {
+    l_time = 0xFFFFU;
+  } /* if */
+
+  *pi_last = (uint16_t)l_time;
+  if(*pi_last > *pi_max)
+  {
+    *pi_max = *pi_last;
+  } /* if */
+} /* loc_rf_turnaround() */
+
+/**
+  @brief  Measures the switch back to reception if the reception was
+          restarted after a transmission.
+  @param  l_start       Timestamp taken before restarting the reception.
+*/
+static void loc_rf_rxRestarted(uint32_t l_start)
+{
+  if(gb_rf_txDone)
+  {
+    gb_rf_txDone = FALSE;
+    loc_rf_turnaround(l_start, &gs_rf_turnaround.i_txRxLast,
+                      &gs_rf_turnaround.i_txRxMax);
+  } /* if */
+} /* loc_rf_rxRestarted() */
+
+#if RF_RX_MODE_TC
+/**
+  @brief  Detects the mode of the current telegram from its first bytes.
+          Called with each block of data read by the stack.
+  @param  pc_data       Data read from the radio.
+  @param  i_len         Length of the data.
+*/
+static void loc_rf_rxMode(uint8_t *pc_data, uint16_t i_len)
+{
+  while((gc_rf_rxHeadLen < RF_RX_MODE_HEAD_LEN) && (i_len > 0U))
+  {
+    if(gc_rf_rxHeadLen == 0U)
+    {
+      if(*pc_data != HAL_RF_MODE_C_PREAMBLE_FIRST)
+      {
+        ge_rf_rxMode = E_WMBUS_MODE_T;
+        gs_rf_rxStats.l_modeT++;
+        gc_rf_rxHeadLen = RF_RX_MODE_HEAD_LEN;
+        return;
+      } /* if */
+    }
+    else if(*pc_data == HAL_RF_MODE_C_FRAMETYPE_A)
+    {
+      ge_rf_rxMode = E_WMBUS_MODE_C;
+      gs_rf_rxStats.l_modeC_A++;
+    }
+    else if(*pc_data == HAL_RF_MODE_C_FRAMETYPE_B)
+    {
+      ge_rf_rxMode = E_WMBUS_MODE_C;
+      gs_rf_rxStats.l_modeC_B++;
+    }
+    else
+    {
+      /* Neither a valid mode T nor a valid mode C telegram. */
+      ge_rf_rxMode = E_WMBUS_MODE_UNKNOWN;
+      gs_rf_rxStats.l_invalid++;
+    } /* if ... else */
+
+    gc_rf_rxHeadLen++;
+    pc_data++;
+    i_len--;
+  } /* while */
+} /* loc_rf_rxMode() */
+#endif /* RF_RX_MODE_TC */
+
+/**
+  @brief  Reception callback of the driver. Assigns the timestamp of the
+          sync word to the telegram and forwards the event to the stack.
+  @param  i_len         Length of the received data.
+  @param  e_frameType   Specifying the type of Wireless M-Bus frame.
+*/
+static void loc_rf_evtRx(uint16_t i_len, E_WMBUS_FRAME_t e_frameType)
+{
+  gl_rf_rxTimestamp = gb_rf_irqTimestampValid ? gl_rf_irqTimestamp :
+                      sf_hal_tmr_getTimestamp();
+
+#if RF_RX_MODE_TC
+  if(i_len == HAL_RF_NEW_TLG)
+  {
+    /* The driver does not know the mode, detect it from the data. */
+    gc_rf_rxHeadLen = 0U;
+    ge_rf_rxMode = E_WMBUS_MODE_UNKNOWN;
+  } /* if */
+#endif /* RF_RX_MODE_TC */
 
+  if(gfp_rf_evtRx != NULL)
+  {
+    gfp_rf_evtRx(i_len, e_frameType);
+  } /* if */
+} /* loc_rf_evtRx() */
 
 /*==============================================================================
                             FUNCTIONS
@@ -72,7 +273,11 @@ void wmbus_hal_rf_powerOn(void)
 /*============================================================================*/
 void wmbus_hal_rf_start(void)
 {
+  uint32_t l_start = sf_hal_tmr_getTimestamp();
+
+  gb_rf_irqTimestampValid = FALSE;
   sf_rf_start();
+  loc_rf_rxRestarted(l_start);
 } /* wmbus_hal_rf_start() */
 
 /*============================================================================*/
@@ -81,7 +286,14 @@ void wmbus_hal_rf_start(void)
 bool_t wmbus_hal_rf_txInit(uint16_t i_len, E_WMBUS_FRAME_t e_frameType,
                             E_WMBUS_MODE_t e_mode)
 {
-  return sf_rf_txInit(i_len, e_frameType, e_mode);
+  uint32_t l_start = sf_hal_tmr_getTimestamp();
+  bool_t b_ret = sf_rf_txInit(i_len, e_frameType, e_mode);
+
+  loc_rf_turnaround(l_start, &gs_rf_turnaround.i_rxTxLast,
+                    &gs_rf_turnaround.i_rxTxMax);
+  gb_rf_txDone = b_ret;
+
+  return b_ret;
 } /* wmbus_hal_rf_txInit() */
 
 /*============================================================================*/
@@ -113,7 +325,16 @@ bool_t wmbus_hal_rf_rxInit(uint8_t *pc_quality, uint8_t c_len)
 /*============================================================================*/
 bool_t wmbus_hal_rf_rxData(uint8_t *pc_data, uint16_t i_len)
 {
-  return sf_rf_rxData(pc_data, i_len);
+  bool_t b_ret = sf_rf_rxData(pc_data, i_len);
+
+#if RF_RX_MODE_TC
+  if(b_ret)
+  {
+    loc_rf_rxMode(pc_data, i_len);
+  } /* if */
+#endif /* RF_RX_MODE_TC */
+
+  return b_ret;
 } /* wmbus_hal_rf_rxData() */
 
 /*============================================================================*/
@@ -121,7 +342,15 @@ bool_t wmbus_hal_rf_rxData(uint8_t *pc_data, uint16_t i_len)
 /*============================================================================*/
 bool_t wmbus_hal_rf_rxFinish(E_HAL_RF_MODE_t e_mode)
 {
-  return sf_rf_rxFinish((E_RF_MODE_t) e_mode);
+  uint32_t l_start = sf_hal_tmr_getTimestamp();
+  bool_t b_ret;
+
+  /* The reception is restarted, take the timestamp of the next sync word. */
+  gb_rf_irqTimestampValid = FALSE;
+  b_ret = sf_rf_rxFinish((E_RF_MODE_t) e_mode);
+  loc_rf_rxRestarted(l_start);
+
+  return b_ret;
 } /* wmbus_hal_rf_rxFinish() */
 
 /*============================================================================*/
@@ -129,6 +358,7 @@ bool_t wmbus_hal_rf_rxFinish(E_HAL_RF_MODE_t e_mode)
 /*============================================================================*/
 bool_t wmbus_hal_rf_reset(E_HAL_RF_CALIBRATE_t e_calibrate)
 {
+  gb_rf_irqTimestampValid = FALSE;
   return sf_rf_reset((E_RF_CALIBRATE_t) e_calibrate);
 } /* wmbus_hal_rf_reset() */
 
@@ -185,6 +415,11 @@ uint8_t wmbus_hal_rf_getSignalStrength(void)
 /*============================================================================*/
 void wmbus_hal_rf_sleep(void)
 {
+  /* Neither a reception nor a transmission is finished by the radio now.
+     E.g. meters sleep after a transmission without restarting the
+     reception. */
+  gb_rf_irqTimestampValid = FALSE;
+  gb_rf_txDone = FALSE;
   sf_rf_sleep();
 } /* wmbus_hal_rf_sleep() */
 
@@ -202,6 +437,29 @@ void wmbus_hal_rf_wake(void)
 void wmbus_hal_rf_run(void)
 {
   sf_rf_run();
+
+  if(!gb_rf_recover)
+  {
+    gc_rf_recoveries = 0U;
+  }
+  else if(gc_rf_recoveries < RF_RECOVERY_MAX)
+  {
+    /* A reset failing again sets gb_rf_recover for the next call. */
+    gb_rf_recover = FALSE;
+    gc_rf_recoveries++;
+    gs_rf_recoveryStats.l_resets++;
+    if(wmbus_hal_rf_reset(E_HAL_RF_CALIB_LOAD))
+    {
+      wmbus_hal_rf_start();
+    } /* if */
+  }
+  else
+  {
+    /* Give up until the radio works again, e.g. after a reset requested
+       by the stack. */
+    gb_rf_recover = FALSE;
+    gs_rf_recoveryStats.l_abandoned++;
+  } /* if ... else if ... else */
 } /* wmbus_hal_rf_run() */
 
 /*============================================================================*/
@@ -217,7 +475,9 @@ uint16_t wmbus_hal_rf_getTelegramDelay(void)
 /*============================================================================*/
 bool_t wmbus_hal_rf_setCallback(fp_hal_rf_evt_tx fp_tx, fp_hal_rf_evt_rx fp_rx)
 {
-  return sf_rf_setCallback(fp_tx, fp_rx);
+  /* Receptions are reported through loc_rf_evtRx() to timestamp them. */
+  gfp_rf_evtRx = fp_rx;
+  return sf_rf_setCallback(fp_tx, (fp_rx != NULL) ? loc_rf_evtRx : NULL);
 } /* wmbus_hal_rf_setCallback() */
 
 /*============================================================================*/
@@ -228,14 +488,109 @@ bool_t wmbus_hal_rf_setFrequencyOffset(sint16_t si_freqOffset)
   return FALSE;
 } /* wmbus_hal_rf_setFrequencyOffset() */
 
+/*============================================================================*/
+/* wmbus_hal_rf_setRxSenseTuning() */
+/*============================================================================*/
+bool_t wmbus_hal_rf_setRxSenseTuning(E_WMBUS_MODE_t e_mode)
+{
+  bool_t b_ret = FALSE;
+
+#if RF_RX_MODE_TC
+  /* Both modes are received with the current configuration, the requested
+     mode is only kept to be returned by wmbus_hal_rf_getRxSenseTuning(). */
+  if((e_mode == E_WMBUS_MODE_T) || (e_mode == E_WMBUS_MODE_C))
+  {
+    ge_rf_rxSenseTuning = e_mode;
+    b_ret = TRUE;
+  } /* if */
+#endif /* RF_RX_MODE_TC */
+
+  return b_ret;
+} /* wmbus_hal_rf_setRxSenseTuning() */
 
 /*============================================================================*/
-/* wmbus_rf_evt_criticalError() */
+/* wmbus_hal_rf_getRxSenseTuning() */
+/*============================================================================*/
+E_WMBUS_MODE_t wmbus_hal_rf_getRxSenseTuning(void)
+{
+#if RF_RX_MODE_TC
+  return ge_rf_rxSenseTuning;
+#else
+  return E_WMBUS_MODE_UNKNOWN;
+#endif /* RF_RX_MODE_TC */
+} /* wmbus_hal_rf_getRxSenseTuning() */
+
+/*============================================================================*/
+/* sf_hal_rf_getRxTimestamp() */
+/*============================================================================*/
+uint32_t sf_hal_rf_getRxTimestamp(void)
+{
+  return gl_rf_rxTimestamp;
+} /* sf_hal_rf_getRxTimestamp() */
+
+/*============================================================================*/
+/* sf_hal_rf_isRxActive() */
+/*============================================================================*/
+bool_t sf_hal_rf_isRxActive(void)
+{
+  return gb_rf_irqTimestampValid;
+} /* sf_hal_rf_isRxActive() */
+
+/*============================================================================*/
+/* sf_hal_rf_isBusy() */
+/*============================================================================*/
+bool_t sf_hal_rf_isBusy(void)
+{
+  return (bool_t)(gb_rf_irqTimestampValid || gb_rf_txDone);
+} /* sf_hal_rf_isBusy() */
+
+/*============================================================================*/
+/* sf_hal_rf_getRxMode() */
+/*============================================================================*/
+E_WMBUS_MODE_t sf_hal_rf_getRxMode(void)
+{
+  return ge_rf_rxMode;
+} /* sf_hal_rf_getRxMode() */
+
+/*============================================================================*/
+/* sf_hal_rf_getTurnaround() */
+/*============================================================================*/
+void sf_hal_rf_getTurnaround(s_sf_hal_rf_turnaround_t* ps_turnaround)
+{
+  *ps_turnaround = gs_rf_turnaround;
+} /* sf_hal_rf_getTurnaround() */
+
+/*============================================================================*/
+/* sf_hal_rf_getRxStats() */
+/*============================================================================*/
+void sf_hal_rf_getRxStats(s_sf_hal_rf_rxStats_t* ps_stats)
+{
+  *ps_stats = gs_rf_rxStats;
+} /* sf_hal_rf_getRxStats() */
+
+
+/*============================================================================*/
+/* sf_hal_rf_getRecoveryStats() */
+/*============================================================================*/
+void sf_hal_rf_getRecoveryStats(s_sf_hal_rf_recoveryStats_t* ps_stats)
+{
+  *ps_stats = gs_rf_recoveryStats;
+} /* sf_hal_rf_getRecoveryStats() */
+
+/*============================================================================*/
+/* sf_rf_evt_criticalError() */
 /*============================================================================*/
 void sf_rf_evt_criticalError(E_RF_ERROR_t e_err)
 {
-  return;
-} /* wmbus_hal_rf_fifoEmpty() */
+  if(e_err == E_RF_ERROR_CTS)
+  {
+    sf_hal_spi_ctsTimeout();
+  } /* if */
+
+  /* The driver may be in any state, thus the radio is reset later on. */
+  gs_rf_recoveryStats.l_errors++;
+  gb_rf_recover = TRUE;
+} /* sf_rf_evt_criticalError() */
 
 
 /*========================= ODD GPIO ISR =====================================*/
@@ -245,6 +600,9 @@ void GPIO_ODD_IRQHandler(void)
   /* rf interrupts */
   if(sf_hal_gpio_irqFlagIsSetGPIO0() || sf_hal_gpio_irqFlagIsSetGPIO1())
   {
+    /* take the time first, e.g. of the sync word detection */
+    loc_rf_irqTimestamp();
+
     /* run rf isr handler */
     sf_rf_isr();
 
@@ -263,6 +621,9 @@ void GPIO_EVEN_IRQHandler(void)
   /* rf interrupts */
   if(sf_hal_gpio_irqFlagIsSetGPIO0() || sf_hal_gpio_irqFlagIsSetGPIO1())
   {
+    /* take the time first, e.g. of the sync word detection */
+    loc_rf_irqTimestamp();
+
     /* run rf isr handler */
     sf_rf_isr();
 
@@ -0,0 +1,131 @@
+#ifndef __SF_HAL_RF_H__
+#define __SF_HAL_RF_H__
+
+/**
+  @file       sf_hal_rf.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Target specific extensions of the RF HAL.
+
+  @addtogroup WMBUS_HAL_RF
+*/
+/**@{*/
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! Mode statistics of the received telegrams, counted by images receiving
+    mode T and mode C at the same time. */
+typedef struct S_SF_HAL_RF_RXSTATS_T
+{
+  /*! Number of mode T telegrams. */
+  uint32_t l_modeT;
+  /*! Number of mode C telegrams using frame format A. */
+  uint32_t l_modeC_A;
+  /*! Number of mode C telegrams using frame format B. */
+  uint32_t l_modeC_B;
+  /*! Number of telegrams starting with the mode C preamble followed by an
+      unknown frame type. */
+  uint32_t l_invalid;
+
+} s_sf_hal_rf_rxStats_t;
+
+/*! Measured times of switching the radio between reception and
+    transmission, counting at SF_HAL_TMR_TIMESTAMP_FREQ. */
+typedef struct S_SF_HAL_RF_TURNAROUND_T
+{
+  /*! Time of the last switch from reception to transmission, spent in
+      wmbus_hal_rf_txInit(). */
+  uint16_t i_rxTxLast;
+  /*! Longest time of a switch from reception to transmission. */
+  uint16_t i_rxTxMax;
+  /*! Time of the last restart of the reception after a transmission. */
+  uint16_t i_txRxLast;
+  /*! Longest time of a restart of the reception after a transmission. */
+  uint16_t i_txRxMax;
+
+} s_sf_hal_rf_turnaround_t;
+
+/*! Statistics of the critical errors reported by the RF driver. */
+typedef struct S_SF_HAL_RF_RECOVERYSTATS_T
+{
+  /*! Number of critical errors, e.g. CTS timeouts. */
+  uint32_t l_errors;
+  /*! Number of resets done to recover. */
+  uint32_t l_resets;
+  /*! Number of times the recovery was given up after RF_RECOVERY_MAX
+      resets in a row. */
+  uint32_t l_abandoned;
+
+} s_sf_hal_rf_recoveryStats_t;
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/**
+  @brief  Returns the time the sync word of the telegram received last was
+          detected.
+          The timestamp is taken from sf_hal_tmr_getTimestamp() in the GPIO
+          ISR of the radio, thus it counts at SF_HAL_TMR_TIMESTAMP_FREQ. It is
+          valid from the time the reception is reported to the stack until
+          the next telegram is received, e.g. within the callbacks of the
+          stack indicating a new telegram.
+  @return Timestamp of the sync word.
+*/
+uint32_t sf_hal_rf_getRxTimestamp(void);
+
+/**
+  @brief  Checks if the radio signalled the reception of a telegram since
+          the reception was restarted last, e.g. to stay on the channel of
+          a scanning receiver until the telegram is complete.
+  @return Returns @c TRUE from the first interrupt of the radio until the
+          reception is restarted.
+*/
+bool_t sf_hal_rf_isRxActive(void);
+
+/**
+  @brief  Checks if the radio is receiving or transmitting a telegram, e.g.
+          to defer operations stalling the CPU for longer than the FIFO of
+          the radio lasts.
+  @return Returns @c TRUE from the first interrupt of a reception or the
+          start of a transmission until the reception is restarted or the
+          radio is put to sleep.
+*/
+bool_t sf_hal_rf_isBusy(void);
+
+/**
+  @brief  Returns the mode of the telegram received last.
+          The mode is detected by images receiving mode T and mode C at the
+          same time. It is valid within the same period as the timestamp of
+          sf_hal_rf_getRxTimestamp().
+  @return E_WMBUS_MODE_T or E_WMBUS_MODE_C, E_WMBUS_MODE_UNKNOWN if the mode
+          is not detected by the image or the telegram was invalid.
+*/
+E_WMBUS_MODE_t sf_hal_rf_getRxMode(void);
+
+/**
+  @brief  Returns the mode statistics of the received telegrams.
+  @param  ps_stats  Pointer where to store the statistics.
+*/
+void sf_hal_rf_getRxStats(s_sf_hal_rf_rxStats_t* ps_stats);
+
+/**
+  @brief  Returns the measured times of switching between reception and
+          transmission, e.g. to check them against the response delay of
+          the mode. The times include programming the register settings of
+          the radio, but not the processing of the stack.
+  @param  ps_turnaround Pointer where to store the times.
+*/
+void sf_hal_rf_getTurnaround(s_sf_hal_rf_turnaround_t* ps_turnaround);
+
+/**
+  @brief  Returns the statistics of the critical errors of the RF driver and
+          the resets done to recover from them. The time the radio took to
+          signal CTS per command is available from sf_hal_spi_getCtsStats().
+  @param  ps_stats  Pointer where to store the statistics.
+*/
+void sf_hal_rf_getRecoveryStats(s_sf_hal_rf_recoveryStats_t* ps_stats);
+
+/**@}*/
+#endif /* __SF_HAL_RF_H__ */
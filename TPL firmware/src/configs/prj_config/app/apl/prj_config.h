@@ -9,6 +9,10 @@
 
 #define  WMBUS_APP_APL
 
+/* Timers of the demo applications running at the same time, e.g. the
+   scheduler timers of main_collector.c */
+#define  TMR_HEAP_APP_SIZE  (4U)
+
 /* include the pin settings-file for the selected board  */
 #ifdef STK3600
   #include "STK3600.h"
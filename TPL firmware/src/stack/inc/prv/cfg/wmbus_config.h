@@ -151,6 +151,44 @@
   /*! RF TX chiprate all */
   #define WMBUS_RF_TX_CHIPRATE_all        0xFF00U
 
+  /*! Codecs or chip rates X of mode M if the image provides it. */
+  #define WMBUS_MODE_SET_GET(X, M)        (((WMBUS_MODE_SET & \
+                                             WMBUS_MODE_##M) != 0U) ? \
+                                           WMBUS_MODE_##X##_##M : 0U)
+  /*! Codecs or chip rates X of all modes the image provides. S1-m uses the
+      ones of S1. */
+  #define WMBUS_MODE_SET_MAP(X)           (WMBUS_MODE_SET_GET(X, S1) | \
+                                           (((WMBUS_MODE_SET & \
+                                              WMBUS_MODE_S1M) != 0U) ? \
+                                            WMBUS_MODE_##X##_S1 : 0U) | \
+                                           WMBUS_MODE_SET_GET(X, S2) | \
+                                           WMBUS_MODE_SET_GET(X, T1) | \
+                                           WMBUS_MODE_SET_GET(X, T2) | \
+                                           WMBUS_MODE_SET_GET(X, N1) | \
+                                           WMBUS_MODE_SET_GET(X, N2) | \
+                                           WMBUS_MODE_SET_GET(X, C1) | \
+                                           WMBUS_MODE_SET_GET(X, C2))
+
+  #if (WMBUS_MODE_SET == WMBUS_MODE_all)
+    /*! Codecs of the modes the image provides. */
+    #define WMBUS_CODEC_SET               0xFFFFU
+    /*! Chip rates of the modes the image provides. */
+    #define WMBUS_CHIPRATE_SET            0xFFFFU
+  #else
+    /*! Codecs of the modes the image provides. */
+    #define WMBUS_CODEC_SET               WMBUS_MODE_SET_MAP(CODEC)
+    /*! Chip rates of the modes the image provides. */
+    #define WMBUS_CHIPRATE_SET            WMBUS_MODE_SET_MAP(CHIPRATE)
+  #endif /* (WMBUS_MODE_SET == WMBUS_MODE_all) */
+
+  /*! TRUE if the image provides any of the modes, codecs or chip rates A
+      of SET. Evaluates to a constant, so the runtime check of A is dropped
+      if it is FALSE. */
+  #define WMBUS_SET_or(SET, A)            (((SET) & (A)) != 0U)
+  /*! TRUE if the image provides all of the modes, codecs or chip rates A
+      of SET. */
+  #define WMBUS_SET_and(SET, A)           (((SET) & (A)) == (A))
+
 #else
   /* List of all codecs required by the PHY on reception. */
   /*! RX codec none */
@@ -333,34 +371,36 @@
   #define WMBUS_CHECK_DEVICE_and(A)         (A)
 
   /*! Checks if the chosen mode is compatible to A. */
-  #define WMBUS_CHECK_MODE_or(A)            TRUE
+  #define WMBUS_CHECK_MODE_or(A)            WMBUS_SET_or(WMBUS_MODE_SET, A)
   /*! Checks if the chosen mode is compatible to A. */
-  #define WMBUS_CHECK_MODE_and(A)           TRUE
+  #define WMBUS_CHECK_MODE_and(A)           WMBUS_SET_and(WMBUS_MODE_SET, A)
   /*! Checks if the chosen mode is compatible to A. */
-  #define WMBUS_CHECK_UNIDIRECTIONAL()      TRUE
+  #define WMBUS_CHECK_UNIDIRECTIONAL()      WMBUS_SET_or(WMBUS_MODE_SET, \
+                                              WMBUS_MODE_UNIDIRECTIONAL)
   /*! Checks if the chosen mode is compatible to A. */
-  #define WMBUS_CHECK_BIDIRECTIONAL()       TRUE
+  #define WMBUS_CHECK_BIDIRECTIONAL()       WMBUS_SET_or(WMBUS_MODE_SET, \
+                                              WMBUS_MODE_BIDIRECTIONAL)
 
   /*! Checks if the chosen chiprate is compatible to A. */
-  #define WMBUS_CHECK_CHIPRATE_or(A)        TRUE
+  #define WMBUS_CHECK_CHIPRATE_or(A)        WMBUS_SET_or(WMBUS_CHIPRATE_SET, A)
 
   /*! Rx codec */
-  #define WMBUS_CHECK_RX_CODEC_or(A)         TRUE
-  #define WMBUS_CHECK_RX_CODEC_and(A)        TRUE
+  #define WMBUS_CHECK_RX_CODEC_or(A)         WMBUS_SET_or(WMBUS_CODEC_SET, A)
+  #define WMBUS_CHECK_RX_CODEC_and(A)        WMBUS_SET_and(WMBUS_CODEC_SET, A)
 
   /*! Checks if Rx chiprate A is supported. */
-  #define WMBUS_CHECK_RX_CHIPRATE_or(A)      TRUE
+  #define WMBUS_CHECK_RX_CHIPRATE_or(A)      WMBUS_SET_or(WMBUS_CHIPRATE_SET, A)
   /*! Checks if Rx chiprate A is exclusively supported. */
-  #define WMBUS_CHECK_RX_CHIPRATE_and(A)     TRUE
+  #define WMBUS_CHECK_RX_CHIPRATE_and(A)     WMBUS_SET_and(WMBUS_CHIPRATE_SET,A)
 
   /*! Tx codec */
-  #define WMBUS_CHECK_TX_CODEC_or(A)         TRUE
-  #define WMBUS_CHECK_TX_CODEC_and(A)        TRUE
+  #define WMBUS_CHECK_TX_CODEC_or(A)         WMBUS_SET_or(WMBUS_CODEC_SET, A)
+  #define WMBUS_CHECK_TX_CODEC_and(A)        WMBUS_SET_and(WMBUS_CODEC_SET, A)
 
   /*! Checks if Rx chiprate A is supported. */
-  #define WMBUS_CHECK_TX_CHIPRATE_or(A)      TRUE
+  #define WMBUS_CHECK_TX_CHIPRATE_or(A)      WMBUS_SET_or(WMBUS_CHIPRATE_SET, A)
   /*! Checks if Rx chiprate A is exclusively supported. */
-  #define WMBUS_CHECK_TX_CHIPRATE_and(A)     TRUE
+  #define WMBUS_CHECK_TX_CHIPRATE_and(A)     WMBUS_SET_and(WMBUS_CHIPRATE_SET,A)
 
 
   /*! Checks if the chosen device and mode are compatible to A. */
@@ -426,17 +466,21 @@
                             SOFT-IFS
 ==============================================================================*/
 #if ((WMBUS_MODE == WMBUS_MODE_all) && (WMBUS_DEVICE != WMBUS_DEVICE_all))
+/* Each runtime check is preceded by the check of the modes, codecs or chip
+   rates the image provides (WMBUS_MODE_SET). The compiler drops the
+   branches of those not provided, so an image of a few modes only tests
+   for these. */
 /* --- MODE --- */
-#define _IF_MODE_and(A)                         if((gi_wmbus_mode & (A)) == (A)){
+#define _IF_MODE_and(A)                         if(WMBUS_SET_and(WMBUS_MODE_SET, (A)) && ((gi_wmbus_mode & (A)) == (A))){
 #define _ELSE_                                  }else{
 #define _ENDIF_                                 }
-#define _IF_MODE_BIDIRECTIONAL()                if(gi_wmbus_mode & (WMBUS_MODE_BIDIRECTIONAL)){
-#define _IF_MODE_or(A)                          if(gi_wmbus_mode & (A)) {
-#define _ELIF_MODE_or(A)                        } else if(gi_wmbus_mode & (A)) {
-#define _ELIF_MODE_and(A)                       } else if((gi_wmbus_mode & (A)) == (A)) {
-#define _IF_MODE_UNIDIRECTIONAL()               if(gi_wmbus_mode & (WMBUS_MODE_UNIDIRECTIONAL)) {
-#define _ELIF_MODE_UNIDIRECTIONAL()             } else if(gi_wmbus_mode & (WMBUS_MODE_UNIDIRECTIONAL)) {
-#define _ELIF_MODE_BIDIRECTIONAL()              } else if(gi_wmbus_mode & (WMBUS_MODE_BIDIRECTIONAL)) {
+#define _IF_MODE_BIDIRECTIONAL()                if(WMBUS_SET_or(WMBUS_MODE_SET, (WMBUS_MODE_BIDIRECTIONAL)) && (gi_wmbus_mode & (WMBUS_MODE_BIDIRECTIONAL))){
+#define _IF_MODE_or(A)                          if(WMBUS_SET_or(WMBUS_MODE_SET, (A)) && (gi_wmbus_mode & (A))) {
+#define _ELIF_MODE_or(A)                        } else if(WMBUS_SET_or(WMBUS_MODE_SET, (A)) && (gi_wmbus_mode & (A))) {
+#define _ELIF_MODE_and(A)                       } else if(WMBUS_SET_and(WMBUS_MODE_SET, (A)) && ((gi_wmbus_mode & (A)) == (A))) {
+#define _IF_MODE_UNIDIRECTIONAL()               if(WMBUS_SET_or(WMBUS_MODE_SET, (WMBUS_MODE_UNIDIRECTIONAL)) && (gi_wmbus_mode & (WMBUS_MODE_UNIDIRECTIONAL))) {
+#define _ELIF_MODE_UNIDIRECTIONAL()             } else if(WMBUS_SET_or(WMBUS_MODE_SET, (WMBUS_MODE_UNIDIRECTIONAL)) && (gi_wmbus_mode & (WMBUS_MODE_UNIDIRECTIONAL))) {
+#define _ELIF_MODE_BIDIRECTIONAL()              } else if(WMBUS_SET_or(WMBUS_MODE_SET, (WMBUS_MODE_BIDIRECTIONAL)) && (gi_wmbus_mode & (WMBUS_MODE_BIDIRECTIONAL))) {
 #define _IF_DEVICE_or(A)                        if(A) {
 #define _IF_DEVICE_and(A)                       if(A){
 #define _ELIF_DEVICE_or(A)                      } else if(A) {
@@ -444,23 +488,23 @@
 #define _IF_DEVICE_MODE_and(A,B)                if(A){
 #define _ELIF_DEVICE_MODE_and(A,B)              } else if(A){
 /* --- Chiprate ---*/
-#define _IF_CHIPRATE_or(A)                      if(gi_wmbus_chiprate & (A)) {
+#define _IF_CHIPRATE_or(A)                      if(WMBUS_SET_or(WMBUS_CHIPRATE_SET, (A)) && (gi_wmbus_chiprate & (A))) {
 /* Chiprate TX */
-#define _ELIF_TX_CHIPRATE_or(A)                 } else if(gi_wmbus_chiprate & (A)) {
-#define _IF_TX_CHIPRATE_or(A)                   if(gi_wmbus_chiprate & (A)) {
-#define _IF_TX_CHIPRATE_and(A)                  if((gi_wmbus_chiprate & WMBUS_RF_TX_CHIPRATE_all) == (A)) { /* all ???? */
-#define _ELIF_TX_CHIPRATE_and(A)                } else if((gi_wmbus_chiprate & WMBUS_RF_TX_CHIPRATE_all) == (A)) { /* all ???? */
+#define _ELIF_TX_CHIPRATE_or(A)                 } else if(WMBUS_SET_or(WMBUS_CHIPRATE_SET, (A)) && (gi_wmbus_chiprate & (A))) {
+#define _IF_TX_CHIPRATE_or(A)                   if(WMBUS_SET_or(WMBUS_CHIPRATE_SET, (A)) && (gi_wmbus_chiprate & (A))) {
+#define _IF_TX_CHIPRATE_and(A)                  if(WMBUS_SET_and(WMBUS_CHIPRATE_SET, (A)) && ((gi_wmbus_chiprate & WMBUS_RF_TX_CHIPRATE_all) == (A))) { /* all ???? */
+#define _ELIF_TX_CHIPRATE_and(A)                } else if(WMBUS_SET_and(WMBUS_CHIPRATE_SET, (A)) && ((gi_wmbus_chiprate & WMBUS_RF_TX_CHIPRATE_all) == (A))) { /* all ???? */
 /* Chiprate RX */
-#define _IF_RX_CHIPRATE_and(A)                  if((gi_wmbus_chiprate & WMBUS_RF_RX_CHIPRATE_all) == (A)) {
-#define _ELIF_RX_CHIPRATE_and(A)                } else if((gi_wmbus_chiprate & WMBUS_RF_RX_CHIPRATE_all) == (A)) {
+#define _IF_RX_CHIPRATE_and(A)                  if(WMBUS_SET_and(WMBUS_CHIPRATE_SET, (A)) && ((gi_wmbus_chiprate & WMBUS_RF_RX_CHIPRATE_all) == (A))) {
+#define _ELIF_RX_CHIPRATE_and(A)                } else if(WMBUS_SET_and(WMBUS_CHIPRATE_SET, (A)) && ((gi_wmbus_chiprate & WMBUS_RF_RX_CHIPRATE_all) == (A))) {
 /* --- Codec TX --- */
-#define _ELIF_CHECK_TX_CODEC_or(A)              } else if(gi_wmbus_codec & (A)) {
-#define _IF_CHECK_TX_CODEC_and(A)               if((gi_wmbus_codec & WMBUS_PHY_TX_CODEC_all) == (A)) {
-#define _ELIF_CHECK_TX_CODEC_and(A)             } else if((gi_wmbus_codec & WMBUS_PHY_TX_CODEC_all) == (A)) {
+#define _ELIF_CHECK_TX_CODEC_or(A)              } else if(WMBUS_SET_or(WMBUS_CODEC_SET, (A)) && (gi_wmbus_codec & (A))) {
+#define _IF_CHECK_TX_CODEC_and(A)               if(WMBUS_SET_and(WMBUS_CODEC_SET, (A)) && ((gi_wmbus_codec & WMBUS_PHY_TX_CODEC_all) == (A))) {
+#define _ELIF_CHECK_TX_CODEC_and(A)             } else if(WMBUS_SET_and(WMBUS_CODEC_SET, (A)) && ((gi_wmbus_codec & WMBUS_PHY_TX_CODEC_all) == (A))) {
 /* --- Codec RX --- */
-#define _IF_CHECK_RX_CODEC_and(A)               if((gi_wmbus_codec & WMBUS_PHY_RX_CODEC_all) == (A)) {
-#define _ELIF_CHECK_RX_CODEC_and(A)             } else if((gi_wmbus_codec & WMBUS_PHY_RX_CODEC_all) == (A)) {
-#define _ELIF_CHECK_RX_CODEC_or(A)              } else if(gi_wmbus_codec & (A)) {                                            
+#define _IF_CHECK_RX_CODEC_and(A)               if(WMBUS_SET_and(WMBUS_CODEC_SET, (A)) && ((gi_wmbus_codec & WMBUS_PHY_RX_CODEC_all) == (A))) {
+#define _ELIF_CHECK_RX_CODEC_and(A)             } else if(WMBUS_SET_and(WMBUS_CODEC_SET, (A)) && ((gi_wmbus_codec & WMBUS_PHY_RX_CODEC_all) == (A))) {
+#define _ELIF_CHECK_RX_CODEC_or(A)              } else if(WMBUS_SET_or(WMBUS_CODEC_SET, (A)) && (gi_wmbus_codec & (A))) {
 
 #else
                                             
@@ -565,7 +609,7 @@ typedef struct S_WMBUS_CFG_CTX_T
 /*! Allowed Wireless M-Bus modes: WMBUS_MODE_x */
 __DECL_WMBUS_CONFIG_H__ uint16_t gi_wmbus_mode
 #ifdef __WMBUS_CONFIG_INIT_VAR__
- = WMBUS_MODE
+ = WMBUS_MODE_SET
 #endif
 ;
 
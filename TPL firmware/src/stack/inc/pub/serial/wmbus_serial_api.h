@@ -132,6 +132,62 @@
   #endif /* STZ_INFO && __SUPPORT_WARNINGS__ */
 #endif /* SERIAL_OPEN_ENABLED */
 
+#ifndef SERIAL_RF_DATA_BATCH_ENABLED
+  /*! By default RF DATA BATCH frames are disabled. Applications forwarding
+      the telegrams by wmbus_serial_rfdataBatch_add() have to enable them. */
+  #define SERIAL_RF_DATA_BATCH_ENABLED  FALSE
+
+  #if (STZ_INFO && __SUPPORT_WARNINGS__)
+  #warning SERIAL_RF_DATA_BATCH_ENABLED set to default value: FALSE
+  #endif /* STZ_INFO && __SUPPORT_WARNINGS__ */
+#endif /* SERIAL_RF_DATA_BATCH_ENABLED */
+
+#ifndef SERIAL_RF_DATA_BATCH_SIZE
+  /*! Number of bytes buffered for the telegrams of a RF DATA BATCH frame.
+      Each telegram requires SERIAL_RF_DATA_BATCH_ENTRY_HDR_LEN bytes in
+      addition to its data. The whole frame, i.e. these bytes and
+      SERIAL_RF_DATA_BATCH_FRAME_OVERHEAD, has to fit into the Tx buffer of
+      the UART, e.g. 128 bytes of the LEUART. */
+  #define SERIAL_RF_DATA_BATCH_SIZE     96U
+
+  #if (STZ_INFO && __SUPPORT_WARNINGS__)
+  #warning SERIAL_RF_DATA_BATCH_SIZE set to default value: 96
+  #endif /* STZ_INFO && __SUPPORT_WARNINGS__ */
+#endif /* SERIAL_RF_DATA_BATCH_SIZE */
+
+#ifndef SERIAL_RF_DATA_BATCH_FRAME_OVERHEAD
+  /*! Number of bytes a RF DATA BATCH frame takes in the Tx buffer of the
+      UART in addition to the buffered telegrams, i.e. the framing, the
+      number of telegrams and the CRC. */
+  #define SERIAL_RF_DATA_BATCH_FRAME_OVERHEAD   16U
+
+  #if (STZ_INFO && __SUPPORT_WARNINGS__)
+  #warning SERIAL_RF_DATA_BATCH_FRAME_OVERHEAD set to default value: 16
+  #endif /* STZ_INFO && __SUPPORT_WARNINGS__ */
+#endif /* SERIAL_RF_DATA_BATCH_FRAME_OVERHEAD */
+
+#ifndef SERIAL_RF_DATA_BATCH_CNT
+  /*! Number of telegrams after which a RF DATA BATCH frame is flushed. */
+  #define SERIAL_RF_DATA_BATCH_CNT      16U
+
+  #if (STZ_INFO && __SUPPORT_WARNINGS__)
+  #warning SERIAL_RF_DATA_BATCH_CNT set to default value: 16
+  #endif /* STZ_INFO && __SUPPORT_WARNINGS__ */
+#endif /* SERIAL_RF_DATA_BATCH_CNT */
+
+#ifndef SERIAL_RF_DATA_BATCH_LATENCY
+  /*! Maximum time in ms a telegram is delayed in a RF DATA BATCH frame. */
+  #define SERIAL_RF_DATA_BATCH_LATENCY  100U
+
+  #if (STZ_INFO && __SUPPORT_WARNINGS__)
+  #warning SERIAL_RF_DATA_BATCH_LATENCY set to default value: 100
+  #endif /* STZ_INFO && __SUPPORT_WARNINGS__ */
+#endif /* SERIAL_RF_DATA_BATCH_LATENCY */
+
+#if (SERIAL_RF_DATA_BATCH_CNT == 0U) || (SERIAL_RF_DATA_BATCH_CNT > 255U)
+#error SERIAL_RF_DATA_BATCH_CNT has to be in the range of 1 to 255.
+#endif /* SERIAL_RF_DATA_BATCH_CNT */
+
 /*========================== SERIAL FRAME TYPES ==============================*/
 /*! Confirm command type */
 #define SERIAL_CMD_TYPE_CONFIRM                (uint8_t)0x00U
@@ -139,6 +195,8 @@
 #define SERIAL_CMD_TYPE_RF_DATA                (uint8_t)0x01U
 /*! Local data command type */
 #define SERIAL_CMD_TYPE_LOCAL_DATA             (uint8_t)0x02U
+/*! RF data batch command type, see wmbus_serial_rfdataBatch_add() */
+#define SERIAL_CMD_TYPE_RF_DATA_BATCH          (uint8_t)0x03U
 /*! Set config command type */
 #define SERIAL_CMD_TYPE_SET_CONFIG             (uint8_t)0x05U
 /*! Get config command type */
@@ -483,6 +541,11 @@
 /*! DLL state telegram available overflow */
 #define SERIAL_DLL_TLG_AVAILABLE_OVERFLOW      0x03U
 
+/*========================== RF DATA BATCH FRAMES ============================*/
+/*! Number of bytes preceding the data of each telegram in a RF DATA BATCH
+    frame: length (2 bytes), RSSI, LQI and timestamp (4 bytes). */
+#define SERIAL_RF_DATA_BATCH_ENTRY_HDR_LEN     8U
+
 /*============================ INTERNAL EVENTS ===============================*/
 /*! Internal message state event timeout */
 #define SERIAL_INTERNAL_EVENT_TIMEOUT          0x01U
@@ -663,6 +726,68 @@ void wmbus_serial_rfdata(uint8_t *pc_data, uint8_t c_len);
 /*============================================================================*/
 void wmbus_serial_rfdata_finish(void);
 
+#if SERIAL_RF_DATA_BATCH_ENABLED
+/*============================================================================*/
+/*!
+ * @brief  Resets the buffer of the RF DATA BATCH frame. Buffered telegrams
+ *         are dropped.
+ */
+/*============================================================================*/
+void wmbus_serial_rfdataBatch_init(void);
+
+/*============================================================================*/
+/*!
+ * @brief  Adds a telegram to the RF DATA BATCH frame.
+ *
+ *         Instead of one RF DATA frame per telegram, the telegrams are
+ *         collected and transmitted in a single frame of the type
+ *         @ref SERIAL_CMD_TYPE_RF_DATA_BATCH. Its payload consists of the
+ *         number of telegrams (1 byte) followed by the telegrams. Each
+ *         telegram is preceded by its length (2 bytes), the RSSI, the LQI and
+ *         the timestamp (4 bytes). Multi byte fields are sent MSB first.
+ *
+ *         The frame is transmitted if SERIAL_RF_DATA_BATCH_CNT telegrams
+ *         are collected, if the next telegram does not fit into the buffer
+ *         or if the first telegram was delayed for
+ *         SERIAL_RF_DATA_BATCH_LATENCY ms. A frame is only started once the
+ *         Tx buffer of the UART has room for all of it, see
+ *         wmbus_serial_rfdataBatch_flush().
+ *
+ * @param c_rssi       RSSI value.
+ * @param c_lqi        LQI value.
+ * @param l_timestamp  Timestamp of the reception.
+ * @param pc_data      Data of the telegram.
+ * @param i_len        Number of data bytes.
+ * @return  @ref TRUE if the telegram was added.
+ *          @ref FALSE if the telegram exceeds SERIAL_RF_DATA_BATCH_SIZE or
+ *          does not fit as the pending frame could not be transmitted yet.
+ */
+/*============================================================================*/
+bool_t wmbus_serial_rfdataBatch_add(uint8_t c_rssi, uint8_t c_lqi,
+                                    uint32_t l_timestamp, uint8_t *pc_data,
+                                    uint16_t i_len);
+
+/*============================================================================*/
+/*!
+ * @brief  Transmits the buffered telegrams of the RF DATA BATCH frame, if any.
+ *         The serial framing has no flow control, bytes not fitting into the
+ *         Tx buffer of the UART are lost. Thus the frame is kept until
+ *         wmbus_hal_uart_cntTxBytes() reports room for all of it.
+ * @return  @ref FALSE if the frame is still pending, it is transmitted by
+ *          a later call or by wmbus_serial_rfdataBatch_run().
+ */
+/*============================================================================*/
+bool_t wmbus_serial_rfdataBatch_flush(void);
+
+/*============================================================================*/
+/*!
+ * @brief  Transmits the RF DATA BATCH frame if its latency expired.
+ *         This function has to be called as often as possible.
+ */
+/*============================================================================*/
+void wmbus_serial_rfdataBatch_run(void);
+#endif /* SERIAL_RF_DATA_BATCH_ENABLED */
+
 /*============================================================================*/
 /*!
  * @brief  Transmits LOCAL DATA.
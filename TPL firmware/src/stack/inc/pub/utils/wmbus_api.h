@@ -281,8 +281,12 @@
 /*! Provide all Wireless M-Bus modes */
 #define WMBUS_CFG_MODE_all                0xFFFFU
 
-
-#if (WMBUS_CFG_MODE != WMBUS_CFG_MODE_all)
+/* WMBUS_CFG_MODE may also combine several modes, e.g.
+   (WMBUS_CFG_MODE_T1 | WMBUS_CFG_MODE_C1). The image then switches between
+   these modes at runtime like WMBUS_CFG_MODE_all, but the checks for all
+   other modes are resolved at compile time. */
+#if ((WMBUS_CFG_MODE != WMBUS_CFG_MODE_all) && \
+     ((WMBUS_CFG_MODE & (WMBUS_CFG_MODE - 1U)) == 0U))
   #if (WMBUS_CFG_MODE == WMBUS_CFG_MODE_S2)
     #define WMBUS_MODE_S2                 TRUE
   #elif (WMBUS_CFG_MODE == WMBUS_CFG_MODE_S1)
@@ -360,6 +364,9 @@
   #define WMBUS_MODE_all                0xFFFFU
 
   #define WMBUS_MODE                    WMBUS_MODE_all
+
+  /*! Modes provided by the image. */
+  #define WMBUS_MODE_SET                (WMBUS_CFG_MODE)
 #endif /* (WMBUS_CFG_MODE != WMBUS_CFG_MODE_all) */
 
 /*@}*/
@@ -0,0 +1,351 @@
+#ifndef __WMBUS_RECORD_API_H__
+#define __WMBUS_RECORD_API_H__
+
+/**
+  @file       wmbus_record_api.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Decoder of the data records of a telegram.
+
+              Include before:
+              - wmbus_typedefs.h
+
+              Iterates over the data records (DIB, VIB and data) of the
+              application data of a telegram as specified by EN 13757-3.
+              The records are decoded in place, nothing is copied. A record
+              refers to its VIFEs, plain text unit and data by their offsets
+              within the buffer, which are read by wmbus_record_getByte()
+              or converted by wmbus_record_getValue() and
+              wmbus_record_getReal().
+
+              s_wmbus_record_iter_t s_iter;
+              s_wmbus_record_t s_record;
+
+              wmbus_record_init(&s_iter, pc_data, i_len, TRUE);
+              while(wmbus_record_next(&s_iter, &s_record) ==
+                    E_WMBUS_RECORD_OK)
+              {
+                ...
+              }
+
+              Telegrams held by the stack are read by
+              wmbus_record_initRead() instead. The bytes are then fetched
+              through wmbus_apl_readData() into a window of
+              WMBUS_RECORD_WINDOW_LEN bytes within the iteration, so
+              telegrams of any length are decoded without a copy of their
+              own.
+
+              Idle fillers are skipped. Manufacturer specific data (DIF 0x0F
+              or 0x1F) is returned as a last record holding all remaining
+              bytes.
+*/
+
+/*==============================================================================
+                            INCLUDES
+==============================================================================*/
+/* Stack specific includes */
+#include "wmbus_global.h"
+
+/*! @defgroup WMBUS_RECORD Record Decoder Interface Description
+ *  This section describes the API for the STACKFORCE record decoder.
+ *  @{
+ */
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! Maximum number of DIFEs or VIFEs of a record. */
+#define WMBUS_RECORD_EXT_MAX            10U
+/*! Number of bytes read at once by an iteration started with
+    wmbus_record_initRead(). */
+#define WMBUS_RECORD_WINDOW_LEN         16U
+
+/*==============================================================================
+                            TYPEDEF ENUMS
+==============================================================================*/
+/*! Return values of wmbus_record_next(). */
+typedef enum
+{
+  /*! A record has been decoded. */
+  E_WMBUS_RECORD_OK,
+  /*! There are no more records. */
+  E_WMBUS_RECORD_END,
+  /*! The record exceeds the buffer. */
+  E_WMBUS_RECORD_ERR_LEN,
+  /*! More than WMBUS_RECORD_EXT_MAX DIFEs or VIFEs. */
+  E_WMBUS_RECORD_ERR_EXT,
+  /*! Reserved DIF or LVAR coding. */
+  E_WMBUS_RECORD_ERR_CODING
+
+} E_WMBUS_RECORD_RET_t;
+
+/*! Coding of the data of a record. */
+typedef enum
+{
+  /*! No data, e.g. a selection for readout. */
+  E_WMBUS_RECORD_CODING_NONE,
+  /*! Signed integer, least significant byte first. */
+  E_WMBUS_RECORD_CODING_INT,
+  /*! 32 bit real (IEEE 754). */
+  E_WMBUS_RECORD_CODING_REAL,
+  /*! BCD, least significant digits first. A most significant digit of
+      0xF denotes a negative value. */
+  E_WMBUS_RECORD_CODING_BCD,
+  /*! Text of a variable length, last character first. */
+  E_WMBUS_RECORD_CODING_TEXT,
+  /*! Manufacturer specific data up to the end of the buffer. */
+  E_WMBUS_RECORD_CODING_MANUFACTURER
+
+} E_WMBUS_RECORD_CODING_t;
+
+/*! Table the VIF of a record refers to. */
+typedef enum
+{
+  /*! Primary VIF. */
+  E_WMBUS_RECORD_VIF_PRIMARY,
+  /*! First extension table, VIF 0xFB. c_vif is the following VIFE. */
+  E_WMBUS_RECORD_VIF_EXT_FB,
+  /*! Second extension table, VIF 0xFD. c_vif is the following VIFE. */
+  E_WMBUS_RECORD_VIF_EXT_FD,
+  /*! Plain text unit, VIF 0x7C. */
+  E_WMBUS_RECORD_VIF_PLAIN_TEXT,
+  /*! Any VIF, VIF 0x7E. */
+  E_WMBUS_RECORD_VIF_ANY,
+  /*! Manufacturer specific, VIF 0x7F. */
+  E_WMBUS_RECORD_VIF_MANUFACTURER,
+  /*! No VIF, i.e. manufacturer specific data. */
+  E_WMBUS_RECORD_VIF_NONE
+
+} E_WMBUS_RECORD_VIF_t;
+
+/*! Units of the primary VIFs. */
+typedef enum
+{
+  /*! Not a primary VIF or reserved. */
+  E_WMBUS_RECORD_UNIT_NONE,
+  /*! Energy in 10^exp Wh. */
+  E_WMBUS_RECORD_UNIT_WH,
+  /*! Energy in 10^exp J. */
+  E_WMBUS_RECORD_UNIT_J,
+  /*! Volume in 10^exp m^3. */
+  E_WMBUS_RECORD_UNIT_M3,
+  /*! Mass in 10^exp kg. */
+  E_WMBUS_RECORD_UNIT_KG,
+  /*! On time, exp is the time unit. */
+  E_WMBUS_RECORD_UNIT_ON_TIME,
+  /*! Operating time, exp is the time unit. */
+  E_WMBUS_RECORD_UNIT_OPERATING_TIME,
+  /*! Power in 10^exp W. */
+  E_WMBUS_RECORD_UNIT_W,
+  /*! Power in 10^exp J/h. */
+  E_WMBUS_RECORD_UNIT_J_H,
+  /*! Volume flow in 10^exp m^3/h. */
+  E_WMBUS_RECORD_UNIT_M3_H,
+  /*! Volume flow in 10^exp m^3/min. */
+  E_WMBUS_RECORD_UNIT_M3_MIN,
+  /*! Volume flow in 10^exp m^3/s. */
+  E_WMBUS_RECORD_UNIT_M3_S,
+  /*! Mass flow in 10^exp kg/h. */
+  E_WMBUS_RECORD_UNIT_KG_H,
+  /*! Flow temperature in 10^exp degree Celsius. */
+  E_WMBUS_RECORD_UNIT_FLOW_TEMP,
+  /*! Return temperature in 10^exp degree Celsius. */
+  E_WMBUS_RECORD_UNIT_RETURN_TEMP,
+  /*! Temperature difference in 10^exp K. */
+  E_WMBUS_RECORD_UNIT_TEMP_DIFF,
+  /*! External temperature in 10^exp degree Celsius. */
+  E_WMBUS_RECORD_UNIT_EXT_TEMP,
+  /*! Pressure in 10^exp bar. */
+  E_WMBUS_RECORD_UNIT_BAR,
+  /*! Date, type G. */
+  E_WMBUS_RECORD_UNIT_DATE,
+  /*! Date and time, type F, I or J. */
+  E_WMBUS_RECORD_UNIT_DATE_TIME,
+  /*! Units for H.C.A. */
+  E_WMBUS_RECORD_UNIT_HCA,
+  /*! Averaging duration, exp is the time unit. */
+  E_WMBUS_RECORD_UNIT_AVG_DURATION,
+  /*! Actuality duration, exp is the time unit. */
+  E_WMBUS_RECORD_UNIT_ACT_DURATION,
+  /*! Fabrication number. */
+  E_WMBUS_RECORD_UNIT_FABRICATION_NO,
+  /*! (Enhanced) identification. */
+  E_WMBUS_RECORD_UNIT_ENHANCED_ID,
+  /*! Bus address. */
+  E_WMBUS_RECORD_UNIT_BUS_ADDRESS
+
+} E_WMBUS_RECORD_UNIT_t;
+
+/*==============================================================================
+                            TYPEDEFS
+==============================================================================*/
+/*! Reads bytes of a telegram, see wmbus_apl_readData(). */
+typedef uint16_t (*fp_wmbus_record_read_t)(uint8_t c_tlgId, uint8_t *pc_data,
+                                           uint16_t i_len, uint16_t i_offset);
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! State of the iteration over the records of a buffer. */
+typedef struct S_WMBUS_RECORD_ITER_T
+{
+  /*! Buffer holding the records, NULL if they are read by fp_read. */
+  const uint8_t *pc_data;
+  /*! Reads the records of the telegram c_tlgId into ac_window. */
+  fp_wmbus_record_read_t fp_read;
+  /*! Id of the telegram read by fp_read. */
+  uint8_t c_tlgId;
+  /*! Bytes last read by fp_read. */
+  uint8_t ac_window[WMBUS_RECORD_WINDOW_LEN];
+  /*! Buffer offset of the first byte of ac_window. */
+  uint16_t i_windowOffset;
+  /*! Number of valid bytes within ac_window. */
+  uint16_t i_windowLen;
+  /*! Length of the buffer. */
+  uint16_t i_len;
+  /*! Offset of the next record. */
+  uint16_t i_offset;
+  /*! Set if the buffer holds the bytes in reverse order, as returned by
+      wmbus_apl_readData(). */
+  bool_t b_reverse;
+
+} s_wmbus_record_iter_t;
+
+/*! Decoded record. All offsets refer to the order of transmission. */
+typedef struct S_WMBUS_RECORD_T
+{
+  /*! DIF of the record. */
+  uint8_t c_dif;
+  /*! Function field of the DIF (instantaneous, maximum, minimum, error). */
+  uint8_t c_function;
+  /*! Number of DIFEs. */
+  uint8_t c_difeCnt;
+  /*! Storage number from the DIF and the DIFEs. */
+  uint32_t l_storage;
+  /*! Tariff from the DIFEs. */
+  uint32_t l_tariff;
+  /*! Subunit from the DIFEs. */
+  uint16_t i_subunit;
+  /*! Table the VIF refers to. */
+  E_WMBUS_RECORD_VIF_t e_vifTable;
+  /*! VIF without the extension bit, the code within the extension table
+      for E_WMBUS_RECORD_VIF_EXT_FB and E_WMBUS_RECORD_VIF_EXT_FD. */
+  uint8_t c_vif;
+  /*! Unit of a primary VIF. */
+  E_WMBUS_RECORD_UNIT_t e_unit;
+  /*! Decimal exponent of a primary VIF. For time units 0 to 3 select
+      seconds, minutes, hours and days. */
+  sint16_t i_exponent;
+  /*! Number of VIFEs, not including the code of an extension table. */
+  uint8_t c_vifeCnt;
+  /*! Offset of the first VIFE. */
+  uint16_t i_vifeOffset;
+  /*! Length of a plain text unit, last character first. */
+  uint8_t c_textLen;
+  /*! Offset of a plain text unit. */
+  uint16_t i_textOffset;
+  /*! Coding of the data. */
+  E_WMBUS_RECORD_CODING_t e_coding;
+  /*! LVAR preceding the data if the DIF announces a variable length. */
+  uint8_t c_lvar;
+  /*! Length of the data. */
+  uint16_t i_dataLen;
+  /*! Offset of the data. */
+  uint16_t i_dataOffset;
+  /*! Set if the manufacturer specific data announces more records in the
+      next telegram (DIF 0x1F). */
+  bool_t b_moreRecords;
+
+} s_wmbus_record_t;
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+
+/*============================================================================*/
+/*!
+ * @brief  Starts the iteration over the records of a buffer.
+ * @param ps_iter     State of the iteration.
+ * @param pc_data     Buffer holding the application data of a telegram. It
+ *                    has to be kept until the iteration is finished.
+ * @param i_len       Length of the buffer.
+ * @param b_reverse   @ref TRUE if the last byte of the buffer has been
+ *                    transmitted first.
+ */
+/*============================================================================*/
+void wmbus_record_init(s_wmbus_record_iter_t *ps_iter, const uint8_t *pc_data,
+                       uint16_t i_len, bool_t b_reverse);
+
+/*============================================================================*/
+/*!
+ * @brief  Starts the iteration over the records of a telegram that is read
+ *         in chunks of WMBUS_RECORD_WINDOW_LEN bytes.
+ * @param ps_iter     State of the iteration.
+ * @param fp_read     Function reading the telegram, e.g.
+ *                    wmbus_apl_readData().
+ * @param c_tlgId     Id of the telegram. It has to be kept until the
+ *                    iteration is finished.
+ * @param i_len       Length of the application data of the telegram.
+ * @param b_reverse   @ref TRUE if the last byte read has been transmitted
+ *                    first.
+ */
+/*============================================================================*/
+void wmbus_record_initRead(s_wmbus_record_iter_t *ps_iter,
+                           fp_wmbus_record_read_t fp_read, uint8_t c_tlgId,
+                           uint16_t i_len, bool_t b_reverse);
+
+/*============================================================================*/
+/*!
+ * @brief  Decodes the next record.
+ * @param ps_iter     State of the iteration.
+ * @param ps_record   Memory to write the decoded record to.
+ * @return            @ref E_WMBUS_RECORD_OK if a record has been decoded.
+ *                    The iteration ends on any other value.
+ */
+/*============================================================================*/
+E_WMBUS_RECORD_RET_t wmbus_record_next(s_wmbus_record_iter_t *ps_iter,
+                                       s_wmbus_record_t *ps_record);
+
+/*============================================================================*/
+/*!
+ * @brief  Reads a byte of the buffer.
+ * @param ps_iter     State of the iteration.
+ * @param i_offset    Offset of the byte in the order of transmission, e.g.
+ *                    i_dataOffset of a record.
+ * @return            Value of the byte.
+ */
+/*============================================================================*/
+uint8_t wmbus_record_getByte(s_wmbus_record_iter_t *ps_iter,
+                             uint16_t i_offset);
+
+/*============================================================================*/
+/*!
+ * @brief  Converts the data of a record coded as integer or BCD.
+ * @param ps_iter     State of the iteration.
+ * @param ps_record   Decoded record.
+ * @param pl_value    Memory to write the value to.
+ * @return            @ref FALSE if the coding is different or the value
+ *                    exceeds 32 bits.
+ */
+/*============================================================================*/
+bool_t wmbus_record_getValue(s_wmbus_record_iter_t *ps_iter,
+                             const s_wmbus_record_t *ps_record,
+                             sint32_t *pl_value);
+
+/*============================================================================*/
+/*!
+ * @brief  Converts the data of a record coded as real.
+ * @param ps_iter     State of the iteration.
+ * @param ps_record   Decoded record.
+ * @param pf_value    Memory to write the value to.
+ * @return            @ref FALSE if the coding is different.
+ */
+/*============================================================================*/
+bool_t wmbus_record_getReal(s_wmbus_record_iter_t *ps_iter,
+                            const s_wmbus_record_t *ps_record,
+                            float *pf_value);
+
+/*!@} end of WMBUS_RECORD */
+/******************************************************************************/
+
+#endif /* __WMBUS_RECORD_API_H__ */
@@ -15,10 +15,20 @@
 #include "inc\prv\cfg\wmbus_config.h"
 #include "inc\pub\utils\wmbus_clock_api.h"
 #include "inc\pub\hal\wmbus_hal.h"
+#include "inc\pub\hal\wmbus_hal_rf.h"
+#include "inc\pub\utils\wmbus_timer_api.h"
+#include "inc\pub\utils\wmbus_record_api.h"
+#include "sf_hal_mem.h"
+#include "sf_hal_meterlist.h"
+#include "sf_hal_rf.h"
+#include "sf_hal_tmr.h"
 /* Include common APL API */
 #include "inc\pub\apl\wmbus_apl_api.h"
 /* Include meter device specific APL API functions */
 #include "inc\pub\apl\wmbus_apl_col_api.h"
+/* EFM library includes for the telegram storage */
+#include "em_device.h"
+#include "em_msc.h"
 
 /*==============================================================================
                             DEFINES
@@ -45,25 +55,68 @@
 /*==============================================================================
                     data storage in RAM/FLASH
 ==============================================================================*/
-/*! example entry for a message to store in RAM/FLASH */
-/*  for efficient memory usage, entry sizes of 16/32/64/128 bytes would be positive */
+/*
+ * The received telegrams are stored in a ring buffer within the flash, e.g.
+ * to forward them later on once the uplink is available again. The entries
+ * are collected in RAM and written from the main loop, a page is erased only
+ * when writing its first entry. Like the erases of the non-volatile memory,
+ * the flash is written only while the radio is idle. Entries not written yet
+ * are flushed every APP_TLG_LOG_FLUSH_MS and before a reset.
+ * Each entry carries a sequence number. As the entries are stored in the
+ * order of their sequence numbers, the location of any entry is calculated
+ * directly from its sequence number.
+ */
+#ifndef APP_TLG_LOG_ENABLED
+#define APP_TLG_LOG_ENABLED   TRUE
+#endif /* APP_TLG_LOG_ENABLED */
 
-#define APP_FLASHPAGE_SIZE    512    /* page size in FLASH */
+#define APP_FLASHPAGE_SIZE    FLASH_PAGE_SIZE    /* page size in FLASH */
 #define APP_ENTRY_SIZE        64     /* just an example */
 #define APP_ENTRIES_PER_PAGE  (APP_FLASHPAGE_SIZE/APP_ENTRY_SIZE)
-#define APP_METADATA_SIZE     4      /* 2 bytes meter ID, 1 byte RSSI, 1 byte */
+#define APP_METADATA_SIZE     14     /* see s_app_tlgEntry_t */
 #define APP_DATA_SIZE         (APP_ENTRY_SIZE - APP_METADATA_SIZE)
 
+/* Size of the flash area storing the telegrams. */
+#ifndef APP_DATA_SIZE_TOTAL
+#define APP_DATA_SIZE_TOTAL   0x6000
+#endif /* APP_DATA_SIZE_TOTAL */
+/* Period to write entries of a partially filled page to the flash. */
+#ifndef APP_TLG_LOG_FLUSH_MS
+#define APP_TLG_LOG_FLUSH_MS  60000
+#endif /* APP_TLG_LOG_FLUSH_MS */
+/* Flash pages at the end of the flash reserved for the non-volatile memory of
+   the stack and the meter table, see sf_hal_mem.h and sf_hal_meterlist.h */
+#if METERLIST_ENABLED
+#define APP_NVM_PAGE_COUNT    (MEM_LOG_PAGES + METERLIST_PAGES)
+#else
+#define APP_NVM_PAGE_COUNT    (MEM_LOG_PAGES)
+#endif /* METERLIST_ENABLED */
+/* Upper limit: pages used by the non-volatile memory of the stack */
+#define APP_DATA_END_ADDRESS  (FLASH_SIZE - (APP_NVM_PAGE_COUNT * APP_FLASHPAGE_SIZE))
 /* Start address fort the array in FLASH*/
-#define APP_DATA_BASE_ADDRESS 0xB600
-/* Upper limit: page containing the interrupt vectors */
-#define MCU_VECTOR_PAGE_ADDRESS    0xFE00
-/* number of pages before stop/roll-over --> to be decided */
-/* in page 32, the interrupt vectors reside.*/
-#define APP_DATA_PAGE_COUNT   (MCU_VECTOR_PAGE_ADDRESS - APP_DATA_BASE_ADDRESS)/APP_FLASHPAGE_SIZE
+#define APP_DATA_BASE_ADDRESS (APP_DATA_END_ADDRESS - APP_DATA_SIZE_TOTAL)
+/* number of pages before roll-over */
+#define APP_DATA_PAGE_COUNT   (APP_DATA_SIZE_TOTAL/APP_FLASHPAGE_SIZE)
+/* Address of a page of the ring buffer */
+#define APP_DATA_PAGE_ADDRESS(x) (APP_DATA_BASE_ADDRESS + ((x) * APP_FLASHPAGE_SIZE))
+/* Sequence number of an erased entry */
+#define APP_SEQ_INVALID       0xFFFFFFFFU
+
+#if (APP_DATA_PAGE_COUNT < 2)
+#error At least two pages are required for the telegram ring buffer.
+#endif
+#if ((APP_DATA_SIZE_TOTAL + (APP_NVM_PAGE_COUNT * APP_FLASHPAGE_SIZE)) >= \
+     FLASH_SIZE)
+#error The telegram ring buffer overlaps the non-volatile memory or the code.
+#endif
 
 typedef struct S_APP_TLG_ENTRY_T
 {
+  /*! Sequence number of the entry, APP_SEQ_INVALID if erased. */
+  uint32_t l_seq;
+  /*! Time the sync word of the telegram was received, see
+      sf_hal_rf_getRxTimestamp(). */
+  uint32_t l_rxTimestamp;
   /*! Id of the meter device the telegram was received from. A conversion of
       addresses to IDs is always possible. */
   uint16_t i_meterId;
@@ -71,18 +124,188 @@ typedef struct S_APP_TLG_ENTRY_T
   uint8_t c_quality;
   /*! Access number of the request telegram. */
   uint8_t c_accNo;
+  /*! Type of the data (CI-field). */
+  uint8_t c_controlInfo;
+  /*! Number of valid bytes within c_data. */
+  uint8_t c_dataLen;
   /*! feel free to add data here, but try to respect memory boundaries */
   uint8_t c_data[APP_DATA_SIZE];
 } s_app_tlgEntry_t;
 
+#if APP_TLG_LOG_ENABLED
 /* array in RAM to collect telegrams before writing to FLASH */
 s_app_tlgEntry_t gs_dataArray[APP_ENTRIES_PER_PAGE];
 /* next page to write */
 uint8_t gc_nextFlashPage;
-/* check if RAM array needs to be written to FLASH */
-bool_t gb_tlgArrayComplete;
+/* number of entries of the RAM array already written to FLASH */
+uint8_t gc_flushedRamEntries;
 /* next array entry to write to RAM array */
 uint8_t gc_nextRamEntry;
+/* first sequence number of each page, APP_SEQ_INVALID if the page is empty */
+uint32_t gal_pageSeq[APP_DATA_PAGE_COUNT];
+/* sequence number of the next entry */
+uint32_t gl_nextSeq;
+/* number of telegrams dropped as the RAM array was not written yet */
+uint32_t gl_tlgLogDropped;
+/* set to write the entries of a partially filled page */
+static bool_t gb_tlgLogFlushReq;
+/* timer requesting to write partially filled pages */
+static s_tmr_t gs_tlgLogTmr;
+#endif /* APP_TLG_LOG_ENABLED */
+
+/*==============================================================================
+                    receive scheduler
+==============================================================================*/
+/*
+ * T and C mode meters transmit periodically. The OMS specification varies the
+ * interval before the telegram with the access number n by
+ *   t = t_nom * (1 + (|n - 128| - 64) / 2048)
+ * so the time of the next telegram of a meter is predictable. The scheduler
+ * learns the nominal interval and its jitter of each meter from the received
+ * telegrams and lets the radio sleep between the windows the telegrams are
+ * expected in. Meters not learned yet, or lost after missing too many
+ * windows, are listened to continuously.
+ */
+#ifndef APP_RX_SCHED_ENABLED
+#if WMBUS_CHECK_MODE_or(WMBUS_MODE_T2 | WMBUS_MODE_C2)
+#define APP_RX_SCHED_ENABLED      TRUE
+#else
+#define APP_RX_SCHED_ENABLED      FALSE
+#endif /* WMBUS_CHECK_MODE_or(WMBUS_MODE_T2 | WMBUS_MODE_C2) */
+#endif /* APP_RX_SCHED_ENABLED */
+
+#define APP_RX_SCHED_METERS       8     /* meters the intervals are learned for */
+#define APP_RX_SCHED_GUARD_MS     30    /* window opened before the telegram */
+#define APP_RX_SCHED_TLG_MS       50    /* air time of the longest telegram */
+#define APP_RX_SCHED_MIN_SLEEP_MS 20    /* shorter gaps are not slept */
+#define APP_RX_SCHED_RECHECK_MS   1000  /* period while listening continuously */
+#define APP_RX_SCHED_BUSY_MS      10    /* period while the stack is busy */
+#define APP_RX_SCHED_MIN_SAMPLES  2     /* intervals learned before sleeping */
+#define APP_RX_SCHED_MAX_MISSES   3     /* missed windows before relearning */
+#define APP_RX_SCHED_MAX_GAP      8     /* missed telegrams to learn across */
+
+/* Scaled interval factor of the telegram with the access number n */
+#define APP_RX_SCHED_FACTOR(n)    (2048U - 64U + \
+                                   (((n) >= 128U) ? ((n) - 128U) : (128U - (n))))
+/* Conversion of milliseconds to timestamp counts */
+#define APP_RX_SCHED_MS_TO_TS(x)  (((x) * SF_HAL_TMR_TIMESTAMP_FREQ) / 1000U)
+
+#if APP_RX_SCHED_ENABLED
+typedef struct S_APP_RX_SLOT_T
+{
+  /*! Timestamp of the last telegram of the meter. */
+  uint32_t l_lastRx;
+  /*! Learned nominal interval in timestamp counts. */
+  uint32_t l_nominal;
+  /*! Learned mean deviation of the intervals from l_nominal. */
+  uint32_t l_jitter;
+  /*! Access number of the last telegram. */
+  uint8_t c_accNo;
+  /*! Number of intervals learned, saturated. */
+  uint8_t c_samples;
+  /*! Number of consecutive intervals not matching l_nominal. */
+  uint8_t c_outliers;
+  /*! Number of windows missed since the last telegram. */
+  uint8_t c_missed;
+  /*! Set once a telegram of the meter has been received. */
+  bool_t b_valid;
+} s_app_rxSlot_t;
+
+/* learned timing of the meters, indexed by the meter ID */
+static s_app_rxSlot_t gs_rxSlot[APP_RX_SCHED_METERS];
+/* timer running the scheduler */
+static s_tmr_t gs_rxSchedTmr;
+/* current state of the radio */
+static bool_t gb_rxSchedRfOn;
+/* timestamp the radio was switched on at */
+static uint32_t gl_rxSchedOnSince;
+/* statistics: timestamp counts the radio was on while it was switched off */
+uint32_t gl_rxSchedOnTime;
+/* statistics: telegrams received from the meters */
+uint32_t gl_rxSchedTlgCnt;
+/* statistics: windows passed without receiving the expected telegram */
+uint32_t gl_rxSchedMissCnt;
+#endif /* APP_RX_SCHED_ENABLED */
+
+/*
+ * Mode N meters are spread over the channels of the 169 MHz band. Instead of
+ * listening to a single channel the collector visits the channels of
+ * APP_CHAN_SCAN_LIST in turn. A channel is kept for a short sense time, long
+ * enough for the radio to detect a telegram, plus a share of the cycle
+ * weighted by the telegrams received on the channel recently. Once the radio
+ * signals a reception the channel is kept until the telegram is complete, so
+ * quiet channels are left after the sense time while busy ones get most of
+ * the cycle. The scanner keeps a map of the occupancy and the link quality of
+ * the channels and of the channel each meter was received on. Channels the
+ * radio signals receptions on without delivering telegrams, e.g. occupied by
+ * other systems, are reduced to the sense time.
+ */
+#ifndef APP_CHAN_SCAN_ENABLED
+#if WMBUS_CHECK_MODE_or(WMBUS_MODE_N1 | WMBUS_MODE_N2)
+#define APP_CHAN_SCAN_ENABLED     TRUE
+#else
+#define APP_CHAN_SCAN_ENABLED     FALSE
+#endif /* WMBUS_CHECK_MODE_or(WMBUS_MODE_N1 | WMBUS_MODE_N2) */
+#endif /* APP_CHAN_SCAN_ENABLED */
+
+#ifndef APP_CHAN_SCAN_LIST
+/* Channels scanned, the 12.5 kHz channels by default. E_RF_CFG_CHAN_169_0
+   may be added if the image supports its data rate. */
+#define APP_CHAN_SCAN_LIST        {E_RF_CFG_CHAN_169_1A, E_RF_CFG_CHAN_169_1B, \
+                                   E_RF_CFG_CHAN_169_2A, E_RF_CFG_CHAN_169_2B, \
+                                   E_RF_CFG_CHAN_169_3A, E_RF_CFG_CHAN_169_3B}
+#endif /* APP_CHAN_SCAN_LIST */
+
+#define APP_CHAN_SCAN_SENSE_MS    20    /* shortest time spent on a channel */
+#define APP_CHAN_SCAN_SHARE_MS    300   /* cycle time shared by the weights */
+#define APP_CHAN_SCAN_RX_MS       20    /* period while receiving */
+#define APP_CHAN_SCAN_HOLD_MS     1200  /* air time of the longest telegram */
+#define APP_CHAN_SCAN_WEIGHT_MIN  16    /* weight of a channel without traffic */
+#define APP_CHAN_SCAN_WEIGHT_TLG  64    /* weight added per telegram */
+#define APP_CHAN_SCAN_DECAY       4     /* weights decay by 1/16 per cycle */
+#define APP_CHAN_SCAN_METERS      8     /* meters the channel is kept for */
+#define APP_CHAN_SCAN_NONE        0xFFU /* channel of a meter not received */
+
+#if APP_CHAN_SCAN_ENABLED
+typedef struct S_APP_CHAN_MAP_T
+{
+  /*! Number of telegrams received on the channel. */
+  uint32_t l_tlgCnt;
+  /*! Number of times the channel was visited. */
+  uint32_t l_visits;
+  /*! Number of visits the radio signalled a reception on without a
+      telegram being received. */
+  uint32_t l_busy;
+  /*! Mean link quality of the telegrams, coded like c_quality of
+      s_apl_tlgAttr_t. 0xFF until a telegram was received. */
+  uint8_t c_quality;
+} s_app_chanMap_t;
+
+/* channels scanned */
+static const E_RADIO_CHANNEL_INDEX_t gae_chanScan[] = APP_CHAN_SCAN_LIST;
+#define APP_CHAN_SCAN_NUM         (sizeof(gae_chanScan) / sizeof(gae_chanScan[0]))
+
+/* weights of the channels according to their traffic */
+static uint16_t gai_chanScanWeight[APP_CHAN_SCAN_NUM];
+/* timer running the scan */
+static s_tmr_t gs_chanScanTmr;
+/* index of the current channel */
+static uint8_t gc_chanScanIdx;
+/* timestamp the current channel was set at */
+static uint32_t gl_chanScanSince;
+/* set if the radio signalled a reception during the current visit */
+static bool_t gb_chanScanRx;
+/* set if a telegram was received during the current visit */
+static bool_t gb_chanScanTlg;
+/* index of the channel each meter was received on last, by the meter ID */
+static uint8_t gac_chanScanMeter[APP_CHAN_SCAN_METERS];
+/* statistics: occupancy and link quality of the channels */
+s_app_chanMap_t gas_chanMap[APP_CHAN_SCAN_NUM];
+/* statistics: telegrams abandoned after APP_CHAN_SCAN_HOLD_MS */
+uint32_t gl_chanScanHoldCnt;
+/* statistics: completed scan cycles */
+uint32_t gl_chanScanCycles;
+#endif /* APP_CHAN_SCAN_ENABLED */
 
 /*==============================================================================
                             VARIABLES
@@ -138,6 +361,47 @@ uint8_t gc_tlgIdClkSync = APL_ERR_TLG_NOT_AVAILABLE;
 static void loc_clockSyncTest(uint8_t c_tlgReqId);
 #endif /* DO_CLK_SYNC_TEST */
 
+#if APP_TLG_LOG_ENABLED
+/*! Restores the state of the telegram storage from the flash */
+static void loc_tlgLogInit(void);
+/*! Stores a received telegram */
+static uint32_t loc_tlgLogAppend(s_apl_tlgAttr_t *ps_tlgAttr);
+/*! Writes the collected telegrams to the flash */
+static bool_t loc_tlgLogFlush(void);
+/*! Writes the collected telegrams from the main loop once due */
+static bool_t loc_tlgLogProcess(void);
+/*! Requests to write a partially filled page */
+static uint32_t loc_tlgLogFlushTmr(void);
+/*! Writes all the collected telegrams before a reset */
+static bool_t loc_tlgLogReset(void);
+/*! Reads a stored telegram by its sequence number */
+bool_t app_tlgLog_read(uint32_t l_seq, s_app_tlgEntry_t *ps_entry);
+/*! Returns the sequence number of the oldest stored telegram */
+uint32_t app_tlgLog_getFirstSeq(void);
+/*! Returns the sequence number the next telegram will get */
+uint32_t app_tlgLog_getNextSeq(void);
+#endif /* APP_TLG_LOG_ENABLED */
+
+#if APP_RX_SCHED_ENABLED
+/*! Starts the receive scheduler */
+static void loc_rxSchedInit(void);
+/*! Learns the timing of a meter from a received telegram */
+static void loc_rxSchedLearn(s_apl_tlgAttr_t *ps_tlgAttr);
+/*! Switches the radio according to the expected telegrams */
+static uint32_t loc_rxSchedRun(void);
+#endif /* APP_RX_SCHED_ENABLED */
+
+#if APP_CHAN_SCAN_ENABLED
+/*! Starts scanning the channels */
+static void loc_chanScanInit(void);
+/*! Weights the current channel by a received telegram */
+static void loc_chanScanLearn(s_apl_tlgAttr_t *ps_tlgAttr);
+/*! Switches to the next channel once the current one is done */
+static uint32_t loc_chanScanRun(void);
+/*! Returns the channel a meter was received on last */
+E_RADIO_CHANNEL_INDEX_t app_chanScan_getMeterChannel(uint16_t i_meterId);
+#endif /* APP_CHAN_SCAN_ENABLED */
+
 /*==============================================================================
                             FUNCTIONS
 ==============================================================================*/
@@ -149,6 +413,9 @@ static void loc_clockSyncTest(uint8_t c_tlgReqId);
 /*============================================================================*/
 void main(void)
 {
+  /* Telegrams are left to be written to the flash */
+  bool_t b_tlgLogBusy = FALSE;
+
   /* Initialises the hal. */
   if(wmbus_hal_init() == E_HAL_STATUS_SUCCESS)
   {
@@ -158,15 +425,43 @@ void main(void)
     /* start the APL for device type collector */
     wmbus_apl_col_start(&gs_startAttr);
 
+    #if APP_TLG_LOG_ENABLED
+    /* restore the telegram storage */
+    loc_tlgLogInit();
+    #endif /* APP_TLG_LOG_ENABLED */
+
+    #if APP_RX_SCHED_ENABLED
+    /* listen to the meters only when their telegrams are expected */
+    loc_rxSchedInit();
+    #endif /* APP_RX_SCHED_ENABLED */
+
     /* Set the channel which should be used (for mode N-Devices only) */
-    #if WMBUS_CHECK_MODE_or(WMBUS_MODE_N1 | WMBUS_MODE_N2)
+    #if APP_CHAN_SCAN_ENABLED
+    /* listen to the meters on all of their channels */
+    loc_chanScanInit();
+    #elif WMBUS_CHECK_MODE_or(WMBUS_MODE_N1 | WMBUS_MODE_N2)
     wmbus_apl_setRfChannel(E_RF_CFG_CHAN_169_1A);
-    #endif /* WMBUS_CHECK_MODE_or(WMBUS_MODE_N1 | WMBUS_MODE_N2) */
+    #endif /* APP_CHAN_SCAN_ENABLED ... WMBUS_CHECK_MODE_or(...) */
 
     while(TRUE)
     {
       /* run the application layer */
       wmbus_apl_col_run();
+
+      /* write pending data of the non-volatile memory */
+      sf_hal_mem_process();
+
+      #if APP_TLG_LOG_ENABLED
+      /* write the collected telegrams */
+      b_tlgLogBusy = loc_tlgLogProcess();
+      #endif /* APP_TLG_LOG_ENABLED */
+
+      /* sleep until the next timer expires if there is nothing left to do */
+      if(((wmbus_apl_getStatus() & APL_STATUS_BUSY) == 0U) &&
+         (sf_hal_mem_isBusy() == FALSE) && (b_tlgLogBusy == FALSE))
+      {
+        sf_hal_tmr_sleep();
+      } /* if */
     } /* while */
   } /* if */
 } /* main() */
@@ -248,16 +543,26 @@ E_APL_HEADER_TYPE_t wmbus_apl_evt_getCiHeader(uint8_t c_ci)
 void wmbus_apl_evt_tlgAvailable(E_WMBUS_RX_t e_status, uint8_t c_tlgReqId,
                           s_apl_tlgAttr_t *ps_tlgAttr)
 {
-  /* Current offset. */
-  uint16_t i_offset = 0;
-  /* current telegram buffer if data should be stored locally */
-  uint8_t pc_dataBuf[25];
+  /* Records of the telegram. */
+  s_wmbus_record_iter_t s_recordIter;
+  s_wmbus_record_t s_record;
+  sint32_t l_value;
 
   /* check for the current status. */
   switch(e_status)
   {
     case E_WMBUS_RX_TLG_AVAILABLE:
     {
+      #if APP_RX_SCHED_ENABLED
+      /* the telegram tells when the next one is expected */
+      loc_rxSchedLearn(ps_tlgAttr);
+      #endif /* APP_RX_SCHED_ENABLED */
+
+      #if APP_CHAN_SCAN_ENABLED
+      /* the channel carries traffic, stay on it longer */
+      loc_chanScanLearn(ps_tlgAttr);
+      #endif /* APP_CHAN_SCAN_ENABLED */
+
       /* new telegram available and the data may be read */
       switch(ps_tlgAttr->c_controlInfo)
       {
@@ -265,39 +570,55 @@ void wmbus_apl_evt_tlgAvailable(E_WMBUS_RX_t e_status, uint8_t c_tlgReqId,
         case APL_FIELD_CI_HEADER_SHORT:
         case APL_FIELD_CI_LINK_FROM_DEVICE_SHORT:
         {
-          /* Read the whole telegram to local buffer */
-          wmbus_apl_readData(ps_tlgAttr->c_tlgId, pc_dataBuf, ps_tlgAttr->i_dataLen, i_offset);
-
           /*
            * 11 bytes of data received with record 0 and record 1 in reverse order:
-           * pc_dataBuf[18]...[11]: record 0 (default: timestamp)
-           * pc_dataBuf[10]...[5] : record 1 (water volume)
-           * pc_dataBuf[4]...[0] : record 2 (water volume)
+           * Data[18]...[11]: record 0 (default: timestamp)
+           * Data[10]...[5] : record 1 (water volume)
+           * Data[4]...[0] : record 2 (water volume)
            *
            * Record 0 (timestamp):
-           * pc_dataBuf[18] is DIB: 0x6 = 48Bit Integer, Instantanous
-           * pc_dataBuf[17] is VIB: 0x6D = special value used for timestamp
-           * pc_dataBuf[16]...[11] is data: 48bit timestamp value
+           * Data[18] is DIB: 0x6 = 48Bit Integer, Instantanous
+           * Data[17] is VIB: 0x6D = special value used for timestamp
+           * Data[16]...[11] is data: 48bit timestamp value
            *
            * Record 1 (water volume):
-           * pc_dataBuf[10] is DIB: 0x0C = 8 digit BCD, Function=Instantaneous
-           * pc_dataBuf[9] is VIB: 0x13 = Unit= Volume(m^3), Multiplier: 1m^3
-           * pc_dataBuf[8] is data: 0x27 = Value LSB
-           * pc_dataBuf[7] is DIB: 0x04 = Value: (= 2850427)
-           * pc_dataBuf[6] is VIB: 0x85 = Value: (= 2850427)
-           * pc_dataBuf[5] is data: 0x02 = Value MSB
+           * Data[10] is DIB: 0x0C = 8 digit BCD, Function=Instantaneous
+           * Data[9] is VIB: 0x13 = Unit= Volume(m^3), Multiplier: 1m^3
+           * Data[8] is data: 0x27 = Value LSB
+           * Data[7] is DIB: 0x04 = Value: (= 2850427)
+           * Data[6] is VIB: 0x85 = Value: (= 2850427)
+           * Data[5] is data: 0x02 = Value MSB
            *
            * Record 2 (water volume):
-           * pc_dataBuf[4] is DIB: 0x0B = 6 digit BCD, Function=Instantaneous
-           * pc_dataBuf[3] is VIB: 0x3B = Unit=  Volume Flow(m^3/h), Multiplier= 1dm^3/h
-           * pc_dataBuf[2] is DIB: 0x27 = Value LSB
-           * pc_dataBuf[1] is VIB: 0x01 = Value   (= 127)
-           * pc_dataBuf[0] is data: 0x00 = Value MSB
+           * Data[4] is DIB: 0x0B = 6 digit BCD, Function=Instantaneous
+           * Data[3] is VIB: 0x3B = Unit=  Volume Flow(m^3/h), Multiplier= 1dm^3/h
+           * Data[2] is DIB: 0x27 = Value LSB
+           * Data[1] is VIB: 0x01 = Value   (= 127)
+           * Data[0] is data: 0x00 = Value MSB
            */
 
-          /*
-           * Extract records here
-           */
+          /* Extract the records. They are read from the telegram in chunks,
+             so the telegram may have any length. The data is read in
+             reverse order. */
+          wmbus_record_initRead(&s_recordIter, wmbus_apl_readData,
+                                ps_tlgAttr->c_tlgId, ps_tlgAttr->i_dataLen,
+                                TRUE);
+          while(wmbus_record_next(&s_recordIter, &s_record) ==
+                E_WMBUS_RECORD_OK)
+          {
+            if((s_record.e_unit == E_WMBUS_RECORD_UNIT_M3) &&
+               (wmbus_record_getValue(&s_recordIter, &s_record, &l_value) ==
+                TRUE))
+            {
+              /* Volume of l_value * 10^s_record.i_exponent m^3, e.g. of
+                 record 1 above 2850427 l. */
+            } /* if */
+          } /* while */
+
+          #if APP_TLG_LOG_ENABLED
+          /* store the telegram for forwarding it later on */
+          loc_tlgLogAppend(ps_tlgAttr);
+          #endif /* APP_TLG_LOG_ENABLED */
 
           #if DO_CLK_SYNC_TEST
           loc_clockSyncTest(c_tlgReqId);
@@ -466,3 +787,682 @@ void wmbus_apl_evt_ACDBitSet(uint8_t c_tlgId)
      with the next unsolicited trans-mission of the Meter.*/
   return;
 } /* wmbus_apl_evt_ACDBitSet() */
+
+#if APP_TLG_LOG_ENABLED
+/*============================================================================*/
+/*! loc_tlgLogInit() */
+/*============================================================================*/
+static void loc_tlgLogInit(void)
+{
+  /* Current page */
+  uint8_t c_page;
+  /* Page holding the most recent entries */
+  uint8_t c_headPage = 0U;
+  /* Entries stored within the head page */
+  uint8_t c_entries = 0U;
+  const s_app_tlgEntry_t *ps_flash;
+
+  gl_nextSeq = 0U;
+
+  /* Build the index of the pages and find the most recent page. */
+  for(c_page = 0U; c_page < APP_DATA_PAGE_COUNT; c_page++)
+  {
+    ps_flash = (const s_app_tlgEntry_t *) APP_DATA_PAGE_ADDRESS(c_page);
+    gal_pageSeq[c_page] = ps_flash->l_seq;
+    if((gal_pageSeq[c_page] != APP_SEQ_INVALID) &&
+       (gal_pageSeq[c_page] >= gl_nextSeq))
+    {
+      c_headPage = c_page;
+      gl_nextSeq = gal_pageSeq[c_page] + 1U;
+    } /* if */
+  } /* for */
+
+  if(gl_nextSeq > 0U)
+  {
+    /* Count the entries of the most recent page. */
+    ps_flash = (const s_app_tlgEntry_t *) APP_DATA_PAGE_ADDRESS(c_headPage);
+    while((c_entries < APP_ENTRIES_PER_PAGE) &&
+          (ps_flash[c_entries].l_seq == (gal_pageSeq[c_headPage] + c_entries)))
+    {
+      c_entries++;
+    } /* while */
+    gl_nextSeq = gal_pageSeq[c_headPage] + c_entries;
+  } /* if */
+
+  if((gl_nextSeq > 0U) && (c_entries < APP_ENTRIES_PER_PAGE))
+  {
+    /* Continue the page, the free entries are still erased. */
+    gc_nextFlashPage = c_headPage;
+    MEMCPY(gs_dataArray, ps_flash, c_entries * APP_ENTRY_SIZE);
+    gc_nextRamEntry = c_entries;
+    gc_flushedRamEntries = c_entries;
+  }
+  else
+  {
+    /* Start with the page following the most recent one. */
+    gc_nextFlashPage = (gl_nextSeq > 0U) ?
+                       ((c_headPage + 1U) % APP_DATA_PAGE_COUNT) : 0U;
+    gc_nextRamEntry = 0U;
+    gc_flushedRamEntries = 0U;
+  } /* if ... else */
+
+  gl_tlgLogDropped = 0U;
+  gb_tlgLogFlushReq = FALSE;
+  wmbus_tmr_initDefault(&gs_tlgLogTmr, FALSE);
+  wmbus_tmr_set(&gs_tlgLogTmr, APP_TLG_LOG_FLUSH_MS, loc_tlgLogFlushTmr);
+  sf_hal_mem_setResetCallback(loc_tlgLogReset);
+
+  return;
+} /* loc_tlgLogInit() */
+
+/*============================================================================*/
+/*! loc_tlgLogAppend() */
+/*============================================================================*/
+static uint32_t loc_tlgLogAppend(s_apl_tlgAttr_t *ps_tlgAttr)
+{
+  s_app_tlgEntry_t *ps_entry = &gs_dataArray[gc_nextRamEntry];
+  uint16_t i_len = ps_tlgAttr->i_dataLen;
+  uint32_t l_seq = APP_SEQ_INVALID;
+
+  if(i_len > APP_DATA_SIZE)
+  {
+    i_len = APP_DATA_SIZE;
+  } /* if */
+
+  if(gc_nextRamEntry == APP_ENTRIES_PER_PAGE)
+  {
+    /* The complete page is not written yet, see loc_tlgLogProcess(). */
+    gl_tlgLogDropped++;
+  }
+  else
+  {
+    if(gc_nextRamEntry == 0U)
+    {
+      /* The page gets overwritten, its oldest entries are dropped. */
+      gal_pageSeq[gc_nextFlashPage] = gl_nextSeq;
+    } /* if */
+
+    MEMSET(ps_entry, 0xFFU, APP_ENTRY_SIZE);
+    ps_entry->l_seq = gl_nextSeq;
+    ps_entry->l_rxTimestamp = sf_hal_rf_getRxTimestamp();
+    ps_entry->i_meterId = ps_tlgAttr->i_meterId;
+    ps_entry->c_quality = ps_tlgAttr->c_quality;
+    ps_entry->c_accNo = ps_tlgAttr->c_accNo;
+    ps_entry->c_controlInfo = ps_tlgAttr->c_controlInfo;
+    ps_entry->c_dataLen = (uint8_t) wmbus_apl_readData(ps_tlgAttr->c_tlgId,
+                                                       ps_entry->c_data,
+                                                       i_len, 0U);
+    l_seq = gl_nextSeq;
+    gc_nextRamEntry++;
+    gl_nextSeq++;
+  } /* if ... else */
+
+  return l_seq;
+} /* loc_tlgLogAppend() */
+
+/*============================================================================*/
+/*! loc_tlgLogFlush() */
+/*============================================================================*/
+static bool_t loc_tlgLogFlush(void)
+{
+  bool_t b_ret = TRUE;
+  uint32_t l_addr;
+
+  if(gc_flushedRamEntries < gc_nextRamEntry)
+  {
+    if(gc_flushedRamEntries == 0U)
+    {
+      /* First write to the page */
+      b_ret = sf_hal_mem_erasePage((uint32_t *)
+                                   APP_DATA_PAGE_ADDRESS(gc_nextFlashPage));
+    } /* if */
+
+    if(b_ret)
+    {
+      l_addr = APP_DATA_PAGE_ADDRESS(gc_nextFlashPage) +
+               (gc_flushedRamEntries * APP_ENTRY_SIZE);
+      MSC_Init();
+      b_ret = (bool_t)(MSC_WriteWord((uint32_t *) l_addr,
+                                     &gs_dataArray[gc_flushedRamEntries],
+                                     (gc_nextRamEntry - gc_flushedRamEntries) *
+                                     APP_ENTRY_SIZE) == mscReturnOk);
+      MSC_Deinit();
+    } /* if */
+
+    if(b_ret)
+    {
+      gc_flushedRamEntries = gc_nextRamEntry;
+    }
+    else
+    {
+      /* The RAM array holds all entries of the page, so the retry erases the
+         page and writes them again. */
+      gc_flushedRamEntries = 0U;
+    } /* if ... else */
+  } /* if */
+
+  if(b_ret && (gc_nextRamEntry == APP_ENTRIES_PER_PAGE))
+  {
+    /* The page is complete, continue with the next one. */
+    gc_nextFlashPage = (gc_nextFlashPage + 1U) % APP_DATA_PAGE_COUNT;
+    gc_nextRamEntry = 0U;
+    gc_flushedRamEntries = 0U;
+  } /* if */
+
+  return b_ret;
+} /* loc_tlgLogFlush() */
+
+/*============================================================================*/
+/*! loc_tlgLogProcess() */
+/*============================================================================*/
+static bool_t loc_tlgLogProcess(void)
+{
+  /* A page is written once complete, a partially filled one on request. */
+  bool_t b_due = (bool_t)((gc_nextRamEntry == APP_ENTRIES_PER_PAGE) ||
+                          (gb_tlgLogFlushReq &&
+                           (gc_flushedRamEntries < gc_nextRamEntry)));
+
+  if(b_due)
+  {
+    /* Writing stalls the RF interrupt handlers as erasing does, wait for
+       the radio getting idle. Failed writes are retried on the next call. */
+    if(((gc_flushedRamEntries == 0U) && sf_hal_mem_eraseAllowed()) ||
+       ((gc_flushedRamEntries > 0U) && (sf_hal_rf_isBusy() == FALSE)))
+    {
+      if(loc_tlgLogFlush() && (gc_flushedRamEntries == gc_nextRamEntry))
+      {
+        gb_tlgLogFlushReq = FALSE;
+        b_due = FALSE;
+      } /* if */
+    } /* if */
+  }
+  else
+  {
+    gb_tlgLogFlushReq = FALSE;
+  } /* if ... else */
+
+  return b_due;
+} /* loc_tlgLogProcess() */
+
+/*============================================================================*/
+/*! loc_tlgLogFlushTmr() */
+/*============================================================================*/
+static uint32_t loc_tlgLogFlushTmr(void)
+{
+  gb_tlgLogFlushReq = TRUE;
+
+  return APP_TLG_LOG_FLUSH_MS;
+} /* loc_tlgLogFlushTmr() */
+
+/*============================================================================*/
+/*! loc_tlgLogReset() */
+/*============================================================================*/
+static bool_t loc_tlgLogReset(void)
+{
+  /* The radio is not waited for, the device is about to be reset. */
+  return loc_tlgLogFlush();
+} /* loc_tlgLogReset() */
+
+/*============================================================================*/
+/*! app_tlgLog_read() */
+/*============================================================================*/
+bool_t app_tlgLog_read(uint32_t l_seq, s_app_tlgEntry_t *ps_entry)
+{
+  bool_t b_ret = FALSE;
+  uint8_t c_page;
+  const s_app_tlgEntry_t *ps_src = NULL;
+
+  if((l_seq < gl_nextSeq) && (ps_entry != NULL))
+  {
+    if((gc_nextRamEntry > 0U) && (l_seq >= gal_pageSeq[gc_nextFlashPage]))
+    {
+      /* Entry of the current page, which may not be written yet */
+      ps_src = &gs_dataArray[l_seq - gal_pageSeq[gc_nextFlashPage]];
+    }
+    else
+    {
+      /* The entries of a page are consecutive, so the page index gives
+         the location directly. */
+      for(c_page = 0U; (c_page < APP_DATA_PAGE_COUNT) && (ps_src == NULL);
+          c_page++)
+      {
+        if((c_page != gc_nextFlashPage) &&
+           (gal_pageSeq[c_page] != APP_SEQ_INVALID) &&
+           (l_seq >= gal_pageSeq[c_page]) &&
+           (l_seq < (gal_pageSeq[c_page] + APP_ENTRIES_PER_PAGE)))
+        {
+          ps_src = (const s_app_tlgEntry_t *) APP_DATA_PAGE_ADDRESS(c_page);
+          ps_src += l_seq - gal_pageSeq[c_page];
+        } /* if */
+      } /* for */
+    } /* if ... else */
+
+    if((ps_src != NULL) && (ps_src->l_seq == l_seq))
+    {
+      MEMCPY(ps_entry, ps_src, APP_ENTRY_SIZE);
+      b_ret = TRUE;
+    } /* if */
+  } /* if */
+
+  return b_ret;
+} /* app_tlgLog_read() */
+
+/*============================================================================*/
+/*! app_tlgLog_getFirstSeq() */
+/*============================================================================*/
+uint32_t app_tlgLog_getFirstSeq(void)
+{
+  uint32_t l_first = gl_nextSeq;
+  uint8_t c_page;
+
+  for(c_page = 0U; c_page < APP_DATA_PAGE_COUNT; c_page++)
+  {
+    if((gal_pageSeq[c_page] != APP_SEQ_INVALID) &&
+       (gal_pageSeq[c_page] < l_first))
+    {
+      l_first = gal_pageSeq[c_page];
+    } /* if */
+  } /* for */
+
+  return l_first;
+} /* app_tlgLog_getFirstSeq() */
+
+/*============================================================================*/
+/*! app_tlgLog_getNextSeq() */
+/*============================================================================*/
+uint32_t app_tlgLog_getNextSeq(void)
+{
+  /*
+   * All telegrams received since a sequence number N are read by
+   *   for(l_seq = MAX(N, app_tlgLog_getFirstSeq());
+   *       l_seq < app_tlgLog_getNextSeq(); l_seq++)
+   *     app_tlgLog_read(l_seq, &s_entry);
+   */
+  return gl_nextSeq;
+} /* app_tlgLog_getNextSeq() */
+#endif /* APP_TLG_LOG_ENABLED */
+
+#if APP_RX_SCHED_ENABLED
+/*============================================================================*/
+/*! loc_rxSchedFactor() */
+/*============================================================================*/
+static uint32_t loc_rxSchedFactor(uint8_t c_accNo, uint8_t c_cnt)
+{
+  /* Sum of the scaled intervals between the telegram with the given access
+     number and the c_cnt following ones. */
+  uint32_t l_factor = 0U;
+
+  while(c_cnt > 0U)
+  {
+    /* the access number wraps around after 255 */
+    c_accNo++;
+    l_factor += APP_RX_SCHED_FACTOR((uint32_t)c_accNo);
+    c_cnt--;
+  } /* while */
+
+  return l_factor;
+} /* loc_rxSchedFactor() */
+
+/*============================================================================*/
+/*! loc_rxSchedTsToMs() */
+/*============================================================================*/
+static uint32_t loc_rxSchedTsToMs(uint32_t l_ts)
+{
+  return ((l_ts / SF_HAL_TMR_TIMESTAMP_FREQ) * 1000U) +
+         (((l_ts % SF_HAL_TMR_TIMESTAMP_FREQ) * 1000U) /
+          SF_HAL_TMR_TIMESTAMP_FREQ);
+} /* loc_rxSchedTsToMs() */
+
+/*============================================================================*/
+/*! loc_rxSchedRadio() */
+/*============================================================================*/
+static void loc_rxSchedRadio(bool_t b_on)
+{
+  uint32_t l_now = sf_hal_tmr_getTimestamp();
+
+  if(b_on && !gb_rxSchedRfOn)
+  {
+    /* wake up the radio and restart the reception */
+    wmbus_hal_rf_wake();
+    wmbus_hal_rf_rxFinish(E_HAL_RF_MODE_RUN);
+    gl_rxSchedOnSince = l_now;
+    gb_rxSchedRfOn = TRUE;
+  }
+  else if(!b_on && gb_rxSchedRfOn)
+  {
+    wmbus_hal_rf_sleep();
+    gl_rxSchedOnTime += l_now - gl_rxSchedOnSince;
+    gb_rxSchedRfOn = FALSE;
+  } /* if ... else if */
+} /* loc_rxSchedRadio() */
+
+/*============================================================================*/
+/*! loc_rxSchedInit() */
+/*============================================================================*/
+static void loc_rxSchedInit(void)
+{
+  MEMSET(gs_rxSlot, 0U, sizeof(gs_rxSlot));
+  gb_rxSchedRfOn = TRUE;
+  gl_rxSchedOnSince = sf_hal_tmr_getTimestamp();
+
+  wmbus_tmr_initDefault(&gs_rxSchedTmr, FALSE);
+  wmbus_tmr_set(&gs_rxSchedTmr, APP_RX_SCHED_RECHECK_MS, loc_rxSchedRun);
+} /* loc_rxSchedInit() */
+
+/*============================================================================*/
+/*! loc_rxSchedLearn() */
+/*============================================================================*/
+static void loc_rxSchedLearn(s_apl_tlgAttr_t *ps_tlgAttr)
+{
+  s_app_rxSlot_t *ps_slot;
+  uint32_t l_rx = sf_hal_rf_getRxTimestamp();
+  uint32_t l_interval;
+  uint32_t l_dev;
+  sint32_t sl_err;
+  uint8_t c_cnt;
+
+  if(ps_tlgAttr->i_meterId >= APP_RX_SCHED_METERS)
+  {
+    return;
+  } /* if */
+
+  ps_slot = &gs_rxSlot[ps_tlgAttr->i_meterId];
+  c_cnt = (uint8_t)(ps_tlgAttr->c_accNo - ps_slot->c_accNo);
+  gl_rxSchedTlgCnt++;
+
+  if(ps_slot->b_valid && (c_cnt == 0U))
+  {
+    /* repetition of the last telegram */
+    return;
+  } /* if */
+
+  if(ps_slot->b_valid && (c_cnt <= APP_RX_SCHED_MAX_GAP))
+  {
+    /* nominal interval derived from the telegrams in between */
+    l_interval = (uint32_t)(((uint64_t)(l_rx - ps_slot->l_lastRx) << 11U) /
+                            loc_rxSchedFactor(ps_slot->c_accNo, c_cnt));
+    sl_err = (sint32_t)(l_interval - ps_slot->l_nominal);
+    l_dev = (uint32_t)((sl_err < 0) ? -sl_err : sl_err);
+
+    if(ps_slot->c_samples == 0U)
+    {
+      ps_slot->l_nominal = l_interval;
+      ps_slot->l_jitter = 0U;
+      ps_slot->c_samples = 1U;
+    }
+    else if(l_dev <= (ps_slot->l_nominal >> 3U))
+    {
+      /* follow slow changes, e.g. the drift of the crystals */
+      ps_slot->l_nominal += (uint32_t)(sl_err / 8);
+      ps_slot->l_jitter = (uint32_t)((sint32_t)ps_slot->l_jitter +
+                          (((sint32_t)l_dev - (sint32_t)ps_slot->l_jitter) / 4));
+      ps_slot->c_outliers = 0U;
+      if(ps_slot->c_samples < 0xFFU)
+      {
+        ps_slot->c_samples++;
+      } /* if */
+    }
+    else if(++ps_slot->c_outliers >= APP_RX_SCHED_MAX_MISSES)
+    {
+      /* the meter changed its interval, start over */
+      ps_slot->l_nominal = l_interval;
+      ps_slot->l_jitter = 0U;
+      ps_slot->c_samples = 1U;
+      ps_slot->c_outliers = 0U;
+    } /* if ... else if */
+  } /* if */
+
+  ps_slot->l_lastRx = l_rx;
+  ps_slot->c_accNo = ps_tlgAttr->c_accNo;
+  ps_slot->c_missed = 0U;
+  ps_slot->b_valid = TRUE;
+
+  /* the window of the telegram may be closed now */
+  wmbus_tmr_set(&gs_rxSchedTmr, APP_RX_SCHED_BUSY_MS, loc_rxSchedRun);
+} /* loc_rxSchedLearn() */
+
+/*============================================================================*/
+/*! loc_rxSchedRun() */
+/*============================================================================*/
+static uint32_t loc_rxSchedRun(void)
+{
+  s_app_rxSlot_t *ps_slot;
+  uint32_t l_now = sf_hal_tmr_getTimestamp();
+  uint32_t l_guard;
+  uint32_t l_open;
+  uint32_t l_close;
+  uint32_t l_delay = 0xFFFFFFFFU;
+  bool_t b_listen = FALSE;
+  uint16_t i_meter;
+  uint8_t c_cnt;
+
+  if(gs_meterList.i_numberOfMeters > APP_RX_SCHED_METERS)
+  {
+    /* the timing of all meters is required to sleep */
+    b_listen = TRUE;
+  } /* if */
+
+  for(i_meter = 0U; (i_meter < gs_meterList.i_numberOfMeters) && !b_listen;
+      i_meter++)
+  {
+    ps_slot = &gs_rxSlot[i_meter];
+    if(ps_slot->c_samples < APP_RX_SCHED_MIN_SAMPLES)
+    {
+      b_listen = TRUE;
+      break;
+    } /* if */
+
+    /* find the next window which did not pass yet */
+    for(c_cnt = 1U; c_cnt <= (APP_RX_SCHED_MAX_MISSES + 1U); c_cnt++)
+    {
+      l_guard = APP_RX_SCHED_MS_TO_TS(APP_RX_SCHED_GUARD_MS) +
+                (4U * c_cnt * ps_slot->l_jitter);
+      l_open = ps_slot->l_lastRx - l_guard +
+               (uint32_t)(((uint64_t)ps_slot->l_nominal *
+                           loc_rxSchedFactor(ps_slot->c_accNo, c_cnt)) >> 11U);
+      l_close = l_open + (2U * l_guard) +
+                APP_RX_SCHED_MS_TO_TS(APP_RX_SCHED_TLG_MS);
+      if((sint32_t)(l_close - l_now) > 0)
+      {
+        break;
+      } /* if */
+    } /* for */
+
+    if((c_cnt - 1U) > ps_slot->c_missed)
+    {
+      gl_rxSchedMissCnt += (c_cnt - 1U) - ps_slot->c_missed;
+      ps_slot->c_missed = c_cnt - 1U;
+    } /* if */
+
+    if(c_cnt > (APP_RX_SCHED_MAX_MISSES + 1U))
+    {
+      /* the meter got lost, learn its timing again */
+      ps_slot->c_samples = 0U;
+      b_listen = TRUE;
+    }
+    else if((sint32_t)(l_open - l_now) <= 0)
+    {
+      /* within the window, listen until it closes */
+      b_listen = TRUE;
+      l_delay = l_close - l_now;
+    }
+    else if((l_open - l_now) < l_delay)
+    {
+      l_delay = l_open - l_now;
+    } /* if ... else if */
+  } /* for */
+
+  if(b_listen && (l_delay == 0xFFFFFFFFU))
+  {
+    /* listen continuously until the timing is known */
+    loc_rxSchedRadio(TRUE);
+    return APP_RX_SCHED_RECHECK_MS;
+  } /* if */
+
+  if((wmbus_apl_getStatus() & APL_STATUS_BUSY) ||
+     (!b_listen &&
+      (l_delay < APP_RX_SCHED_MS_TO_TS(APP_RX_SCHED_MIN_SLEEP_MS))))
+  {
+    /* the stack is busy or the next window is about to open */
+    loc_rxSchedRadio(TRUE);
+    return APP_RX_SCHED_BUSY_MS;
+  } /* if */
+
+  loc_rxSchedRadio(b_listen);
+
+  return loc_rxSchedTsToMs(l_delay) + 1U;
+} /* loc_rxSchedRun() */
+#endif /* APP_RX_SCHED_ENABLED */
+
+#if APP_CHAN_SCAN_ENABLED
+/*============================================================================*/
+/*! loc_chanScanDwell() */
+/*============================================================================*/
+static uint32_t loc_chanScanDwell(uint8_t c_idx)
+{
+  uint32_t l_sum = 0U;
+  uint8_t c_chan;
+
+  for(c_chan = 0U; c_chan < APP_CHAN_SCAN_NUM; c_chan++)
+  {
+    l_sum += gai_chanScanWeight[c_chan];
+  } /* for */
+
+  return APP_CHAN_SCAN_SENSE_MS +
+         ((APP_CHAN_SCAN_SHARE_MS * (uint32_t)gai_chanScanWeight[c_idx]) /
+          l_sum);
+} /* loc_chanScanDwell() */
+
+/*============================================================================*/
+/*! loc_chanScanInit() */
+/*============================================================================*/
+static void loc_chanScanInit(void)
+{
+  uint8_t c_chan;
+
+  for(c_chan = 0U; c_chan < APP_CHAN_SCAN_NUM; c_chan++)
+  {
+    gai_chanScanWeight[c_chan] = APP_CHAN_SCAN_WEIGHT_MIN;
+    gas_chanMap[c_chan].c_quality = 0xFFU;
+  } /* for */
+  MEMSET(gac_chanScanMeter, APP_CHAN_SCAN_NONE, sizeof(gac_chanScanMeter));
+
+  gc_chanScanIdx = 0U;
+  gl_chanScanSince = sf_hal_tmr_getTimestamp();
+  wmbus_apl_setRfChannel(gae_chanScan[0U]);
+
+  wmbus_tmr_initDefault(&gs_chanScanTmr, FALSE);
+  wmbus_tmr_set(&gs_chanScanTmr, loc_chanScanDwell(0U), loc_chanScanRun);
+} /* loc_chanScanInit() */
+
+/*============================================================================*/
+/*! loc_chanScanLearn() */
+/*============================================================================*/
+static void loc_chanScanLearn(s_apl_tlgAttr_t *ps_tlgAttr)
+{
+  uint16_t *pi_weight = &gai_chanScanWeight[gc_chanScanIdx];
+  s_app_chanMap_t *ps_map = &gas_chanMap[gc_chanScanIdx];
+
+  /* the channel is not left while receiving, the telegram was received on
+     the current one */
+  ps_map->l_tlgCnt++;
+  gb_chanScanTlg = TRUE;
+  if(*pi_weight <= (0xFFFFU - APP_CHAN_SCAN_WEIGHT_TLG))
+  {
+    *pi_weight += APP_CHAN_SCAN_WEIGHT_TLG;
+  } /* if */
+
+  if(ps_tlgAttr->c_quality != 0xFFU)
+  {
+    if(ps_map->c_quality == 0xFFU)
+    {
+      ps_map->c_quality = ps_tlgAttr->c_quality;
+    }
+    else
+    {
+      ps_map->c_quality = (uint8_t)((sint16_t)ps_map->c_quality +
+                          (((sint16_t)ps_tlgAttr->c_quality -
+                            (sint16_t)ps_map->c_quality) / 4));
+    } /* if ... else */
+  } /* if */
+
+  if(ps_tlgAttr->i_meterId < APP_CHAN_SCAN_METERS)
+  {
+    gac_chanScanMeter[ps_tlgAttr->i_meterId] = gc_chanScanIdx;
+  } /* if */
+} /* loc_chanScanLearn() */
+
+/*============================================================================*/
+/*! loc_chanScanRun() */
+/*============================================================================*/
+static uint32_t loc_chanScanRun(void)
+{
+  uint32_t l_on = sf_hal_tmr_getTimestamp() - gl_chanScanSince;
+  uint8_t c_chan;
+
+  if(sf_hal_rf_isRxActive())
+  {
+    gb_chanScanRx = TRUE;
+  } /* if */
+
+  if(sf_hal_rf_isRxActive() || (wmbus_apl_getStatus() & APL_STATUS_BUSY))
+  {
+    if(l_on < APP_RX_SCHED_MS_TO_TS(APP_CHAN_SCAN_HOLD_MS))
+    {
+      /* a telegram is being received or processed, keep the channel */
+      return APP_CHAN_SCAN_RX_MS;
+    } /* if */
+
+    /* noise or a reception the radio did not finish */
+    gl_chanScanHoldCnt++;
+  } /* if */
+
+  gas_chanMap[gc_chanScanIdx].l_visits++;
+  if(gb_chanScanRx && !gb_chanScanTlg)
+  {
+    /* the channel is occupied by other systems or noise, receiving on it
+       mostly holds the scan, listen for the sense time only */
+    gas_chanMap[gc_chanScanIdx].l_busy++;
+    gai_chanScanWeight[gc_chanScanIdx] = APP_CHAN_SCAN_WEIGHT_MIN;
+  } /* if */
+  gb_chanScanRx = FALSE;
+  gb_chanScanTlg = FALSE;
+
+  if(++gc_chanScanIdx >= APP_CHAN_SCAN_NUM)
+  {
+    /* forget about the traffic slowly, so the weights follow changes */
+    for(c_chan = 0U; c_chan < APP_CHAN_SCAN_NUM; c_chan++)
+    {
+      gai_chanScanWeight[c_chan] -=
+        ((gai_chanScanWeight[c_chan] - APP_CHAN_SCAN_WEIGHT_MIN) +
+         (1U << APP_CHAN_SCAN_DECAY) - 1U) >> APP_CHAN_SCAN_DECAY;
+    } /* for */
+    gc_chanScanIdx = 0U;
+    gl_chanScanCycles++;
+  } /* if */
+
+  gl_chanScanSince = sf_hal_tmr_getTimestamp();
+  wmbus_apl_setRfChannel(gae_chanScan[gc_chanScanIdx]);
+
+  return loc_chanScanDwell(gc_chanScanIdx);
+} /* loc_chanScanRun() */
+
+/*============================================================================*/
+/*! app_chanScan_getMeterChannel() */
+/*============================================================================*/
+E_RADIO_CHANNEL_INDEX_t app_chanScan_getMeterChannel(uint16_t i_meterId)
+{
+  /*
+   * Meters sharing a channel may be found by this function, e.g. to queue
+   * the requests to them together. The channel is kept while the stack is
+   * busy, so the requests are sent on the channel the meter was received on.
+   */
+  if((i_meterId >= APP_CHAN_SCAN_METERS) ||
+     (gac_chanScanMeter[i_meterId] == APP_CHAN_SCAN_NONE))
+  {
+    return E_RF_CFG_CHAN_UNKNOWN;
+  } /* if */
+
+  return gae_chanScan[gac_chanScanMeter[i_meterId]];
+} /* app_chanScan_getMeterChannel() */
+#endif /* APP_CHAN_SCAN_ENABLED */
@@ -18,6 +18,7 @@
 #include "inc\pub\dll\wmbus_dll_defines.h"
 #include "inc\pub\tpl\wmbus_tpl_api.h"
 #include "inc\pub\hal\wmbus_hal.h"
+#include "sf_hal_mem.h"
 
 /*==============================================================================
                             DEFINES
@@ -109,6 +110,9 @@ void main(void)
      {
        /* run the tpl layer */
        wmbus_tpl_run();
+
+       /* write pending data of the non-volatile memory */
+       sf_hal_mem_process();
     
        /* runs the clobal clock */
        wmbus_clock_run(&gs_clock);
@@ -20,6 +20,7 @@
 #include "inc\pub\tpl\wmbus_tpl_api.h"
 #include "inc\pub\utils\wmbus_timer_api.h"
 #include "inc\pub\hal\wmbus_hal.h"
+#include "sf_hal_mem.h"
 
 /*==============================================================================
                             DEFINES
@@ -188,6 +189,9 @@ void main(void)
      {
        /* run the tpl layer */
        wmbus_tpl_run();
+
+       /* write pending data of the non-volatile memory */
+       sf_hal_mem_process();
     
        /* runs the clobal clock */
        wmbus_clock_run(&gs_clock);
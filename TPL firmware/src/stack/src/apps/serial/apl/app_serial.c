@@ -12,6 +12,7 @@
 #include "inc\pub\utils\wmbus_api.h"
 #include "inc\prv\cfg\wmbus_config.h"
 #include "inc\pub\hal\wmbus_hal.h"
+#include "sf_hal_mem.h"
 /* Stack specific includes */
 #include "wmbus_global.h"
 /* Include common APL API functions */
@@ -115,6 +116,14 @@ void main(void)
     while(TRUE)
     {
       wmbus_serial_run();
+
+      #if SERIAL_RF_DATA_BATCH_ENABLED
+      /* transmit pending telegrams of a RF DATA BATCH frame */
+      wmbus_serial_rfdataBatch_run();
+      #endif /* SERIAL_RF_DATA_BATCH_ENABLED */
+
+      /* write pending data of the non-volatile memory */
+      sf_hal_mem_process();
     } /* while */
   } /* if */
 } /* main() */
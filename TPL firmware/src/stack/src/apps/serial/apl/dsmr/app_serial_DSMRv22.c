@@ -12,6 +12,7 @@
 #include "inc\pub\utils\wmbus_api.h"
 #include "inc\prv\cfg\wmbus_config.h"
 #include "inc\pub\hal\wmbus_hal.h"
+#include "sf_hal_mem.h"
 /* Stack specific includes */
 #include "wmbus_global.h"
 /* Include common APL API functions */
@@ -115,6 +116,9 @@ void main(void)
     while(TRUE)
     {
       wmbus_serial_run();
+
+      /* write pending data of the non-volatile memory */
+      sf_hal_mem_process();
     } /* while */
   } /* if */
 } /* main() */
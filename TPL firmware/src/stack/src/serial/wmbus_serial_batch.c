@@ -0,0 +1,183 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @file       wmbus_serial_batch.c
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Batched RF DATA frames of the serial protocol.
+
+  @addtogroup WMBUS_SERIAL
+
+  Collectors receiving many telegrams spend most of the serial bandwidth and
+  of the host wake-ups on the framing of the single RF DATA frames. The
+  functions below collect the telegrams in a buffer and transmit them in one
+  frame of the type SERIAL_CMD_TYPE_RF_DATA_BATCH. The layout of the frame is
+  described at wmbus_serial_rfdataBatch_add().
+
+  The functions are built with SERIAL_RF_DATA_BATCH_ENABLED only. A frame is
+  written to the UART as a whole once its Tx buffer has room for it, as the
+  serial framing has no flow control.
+*/
+/**@{*/
+
+/*==============================================================================
+                            INCLUDE FILES
+==============================================================================*/
+#include "inc\pub\utils\wmbus_typedefs.h"
+#include "inc\pub\utils\wmbus_api.h"
+#include "inc\prv\cfg\wmbus_config.h"
+#include "inc\pub\utils\wmbus_timer_api.h"
+#include "inc\pub\hal\wmbus_hal_uart.h"
+
+#include "wmbus_global.h"
+
+#include "inc\pub\serial\wmbus_serial_api.h"
+
+#if SERIAL_RF_DATA_BATCH_ENABLED
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! Maximum number of bytes passed to wmbus_serial_localdata_write(). */
+#define SERIAL_RF_DATA_BATCH_WRITE_MAX        255U
+
+/*==============================================================================
+                            VARIABLES
+==============================================================================*/
+/*! Telegrams of the pending RF DATA BATCH frame. */
+static uint8_t gac_serial_batch[SERIAL_RF_DATA_BATCH_SIZE];
+/*! Number of bytes used in gac_serial_batch. */
+static uint16_t gi_serial_batchLen;
+/*! Number of telegrams in gac_serial_batch. */
+static uint8_t gc_serial_batchCnt;
+/*! Tick at which the pending frame has to be transmitted. */
+static uint32_t gl_serial_batchTimeout;
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+
+/*============================================================================*/
+/* wmbus_serial_rfdataBatch_init() */
+/*============================================================================*/
+void wmbus_serial_rfdataBatch_init(void)
+{
+  gi_serial_batchLen = 0U;
+  gc_serial_batchCnt = 0U;
+} /* wmbus_serial_rfdataBatch_init() */
+
+/*============================================================================*/
+/* wmbus_serial_rfdataBatch_add() */
+/*============================================================================*/
+bool_t wmbus_serial_rfdataBatch_add(uint8_t c_rssi, uint8_t c_lqi,
+                                    uint32_t l_timestamp, uint8_t *pc_data,
+                                    uint16_t i_len)
+{
+  uint8_t* pc_entry;
+
+  if(i_len > (SERIAL_RF_DATA_BATCH_SIZE - SERIAL_RF_DATA_BATCH_ENTRY_HDR_LEN))
+  {
+    return FALSE;
+  } /* if */
+
+  if(((gc_serial_batchCnt >= SERIAL_RF_DATA_BATCH_CNT) ||
+      ((gi_serial_batchLen + SERIAL_RF_DATA_BATCH_ENTRY_HDR_LEN + i_len) >
+       SERIAL_RF_DATA_BATCH_SIZE)) &&
+     (wmbus_serial_rfdataBatch_flush() == FALSE))
+  {
+    /* The telegram does not fit anymore and the pending ones could not be
+       transmitted yet. */
+    return FALSE;
+  } /* if */
+
+  if(gc_serial_batchCnt == 0U)
+  {
+    /* The first telegram defines when the frame has to be transmitted. */
+    gl_serial_batchTimeout =
+      wmbus_tmr_getTimeout(SERIAL_RF_DATA_BATCH_LATENCY);
+  } /* if */
+
+  pc_entry = &gac_serial_batch[gi_serial_batchLen];
+  pc_entry[0U] = (uint8_t)(i_len >> 8U);
+  pc_entry[1U] = (uint8_t)i_len;
+  pc_entry[2U] = c_rssi;
+  pc_entry[3U] = c_lqi;
+  pc_entry[4U] = (uint8_t)(l_timestamp >> 24U);
+  pc_entry[5U] = (uint8_t)(l_timestamp >> 16U);
+  pc_entry[6U] = (uint8_t)(l_timestamp >> 8U);
+  pc_entry[7U] = (uint8_t)l_timestamp;
+  MEMCPY(&pc_entry[SERIAL_RF_DATA_BATCH_ENTRY_HDR_LEN], pc_data, i_len);
+
+  gi_serial_batchLen += SERIAL_RF_DATA_BATCH_ENTRY_HDR_LEN + i_len;
+  gc_serial_batchCnt++;
+
+  if(gc_serial_batchCnt >= SERIAL_RF_DATA_BATCH_CNT)
+  {
+    /* Retried by wmbus_serial_rfdataBatch_run() if the UART is busy. */
+    wmbus_serial_rfdataBatch_flush();
+  } /* if */
+
+  return TRUE;
+} /* wmbus_serial_rfdataBatch_add() */
+
+/*============================================================================*/
+/* wmbus_serial_rfdataBatch_flush() */
+/*============================================================================*/
+bool_t wmbus_serial_rfdataBatch_flush(void)
+{
+  uint16_t i_offset;
+  uint16_t i_len;
+
+  if(gc_serial_batchCnt == 0U)
+  {
+    return TRUE;
+  } /* if */
+
+  if(wmbus_hal_uart_cntTxBytes() <
+     (gi_serial_batchLen + SERIAL_RF_DATA_BATCH_FRAME_OVERHEAD))
+  {
+    /* Bytes exceeding the Tx buffer would be dropped by the UART. */
+    return FALSE;
+  } /* if */
+
+  /* The payload consists of the number of telegrams and the telegrams. */
+  wmbus_serial_localdata_writeHeader(gi_serial_batchLen + 1U,
+                                     SERIAL_CMD_TYPE_RF_DATA_BATCH);
+  wmbus_serial_localdata_write(&gc_serial_batchCnt, 1U);
+
+  for(i_offset = 0U; i_offset < gi_serial_batchLen; i_offset += i_len)
+  {
+    i_len = gi_serial_batchLen - i_offset;
+    if(i_len > SERIAL_RF_DATA_BATCH_WRITE_MAX)
+    {
+      i_len = SERIAL_RF_DATA_BATCH_WRITE_MAX;
+    } /* if */
+    wmbus_serial_localdata_write(&gac_serial_batch[i_offset], (uint8_t)i_len);
+  } /* for */
+
+  wmbus_serial_localdata_finish();
+
+  wmbus_serial_rfdataBatch_init();
+
+  return TRUE;
+} /* wmbus_serial_rfdataBatch_flush() */
+
+/*============================================================================*/
+/* wmbus_serial_rfdataBatch_run() */
+/*============================================================================*/
+void wmbus_serial_rfdataBatch_run(void)
+{
+  if((gc_serial_batchCnt >= SERIAL_RF_DATA_BATCH_CNT) ||
+     ((gc_serial_batchCnt > 0U) &&
+      (wmbus_tmr_ticksToExpire(gl_serial_batchTimeout) == 0U)))
+  {
+    wmbus_serial_rfdataBatch_flush();
+  } /* if */
+} /* wmbus_serial_rfdataBatch_run() */
+#endif /* SERIAL_RF_DATA_BATCH_ENABLED */
+
+/**@}*/
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,307 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @file       wmbus_codec.c
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Line codes of the Wireless M-Bus.
+
+  @addtogroup WMBUS_CODEC
+
+  Source implementation of the API in wmbus_codec_api.h. 3 out of 6 is
+  handled in groups of 2 bytes, whose 24 chips are collected in a word and
+  looked up as 4 codes of 6 chips. Invalid codes are marked by an extra bit
+  in the decoding table, which is accumulated over all codes, so the loop
+  does not branch on the data.
+
+  Manchester is decoded by looking up each byte of chips on Cortex-M0+,
+  which lacks the 32 bit immediates to handle masks cheaply. The other
+  cores decode 4 bytes of chips at once: the data bit is the second chip of
+  each pair, the pairs are validated and packed together by shifting the
+  whole word.
+
+  Decoding in place works as each group of data is written after its chips
+  have been read, and never behind the chips of the next group.
+*/
+/**@{*/
+
+/*==============================================================================
+                            INCLUDE FILES
+==============================================================================*/
+#include "inc\pub\utils\wmbus_typedefs.h"
+#include "inc\pub\utils\wmbus_codec_api.h"
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! Set to TRUE to decode Manchester by a table of 256 bytes. */
+#ifndef CODEC_MANCHESTER_TABLE
+#if defined(__CORE__) && defined(__ARM6M__) && (__CORE__ == __ARM6M__)
+#define CODEC_MANCHESTER_TABLE                TRUE
+#else
+#define CODEC_MANCHESTER_TABLE                FALSE
+#endif /* __CORE__ */
+#endif /* CODEC_MANCHESTER_TABLE */
+
+/*! Marks an invalid code within the decoding tables. */
+#define CODEC_INVALID                         0x10U
+/*! Mask of the 6 chips of a 3 out of 6 code. */
+#define CODEC_3OUTOF6_MASK                    0x3FU
+/*! Chips following the code of an odd last byte, start of the postamble. */
+#define CODEC_3OUTOF6_PAD                     0x05U
+
+#if !CODEC_MANCHESTER_TABLE
+/*! Second chip of each pair within a word, carrying the data bit. */
+#define CODEC_MANCHESTER_DATA                 0x55555555UL
+/*! Chips filling the word of an odd last byte, valid Manchester codes. */
+#define CODEC_MANCHESTER_FILL                 0x00005555UL
+#endif /* !CODEC_MANCHESTER_TABLE */
+
+/*==============================================================================
+                            VARIABLES
+==============================================================================*/
+/*! 3 out of 6 code of each nibble. */
+static const uint8_t gac_codec_3outof6Enc[16U] =
+{
+  0x16U, 0x0DU, 0x0EU, 0x0BU, 0x1CU, 0x19U, 0x1AU, 0x13U,
+  0x2CU, 0x25U, 0x26U, 0x23U, 0x34U, 0x31U, 0x32U, 0x29U
+};
+
+/*! Nibble of each 3 out of 6 code, CODEC_INVALID if not valid. */
+static const uint8_t gac_codec_3outof6Dec[64U] =
+{
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x03U, 0x10U, 0x01U, 0x02U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x07U, 0x10U, 0x10U, 0x00U, 0x10U,
+  0x10U, 0x05U, 0x06U, 0x10U, 0x04U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x0BU, 0x10U, 0x09U, 0x0AU, 0x10U,
+  0x10U, 0x0FU, 0x10U, 0x10U, 0x08U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x0DU, 0x0EU, 0x10U, 0x0CU, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U
+};
+
+/*! Manchester code of each nibble. */
+static const uint8_t gac_codec_manchesterEnc[16U] =
+{
+  0xAAU, 0xA9U, 0xA6U, 0xA5U, 0x9AU, 0x99U, 0x96U, 0x95U,
+  0x6AU, 0x69U, 0x66U, 0x65U, 0x5AU, 0x59U, 0x56U, 0x55U
+};
+
+#if CODEC_MANCHESTER_TABLE
+/*! Nibble of each byte of Manchester chips, CODEC_INVALID if not valid. */
+static const uint8_t gac_codec_manchesterDec[256U] =
+{
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x0FU, 0x0EU, 0x10U,
+  0x10U, 0x0DU, 0x0CU, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x0BU, 0x0AU, 0x10U,
+  0x10U, 0x09U, 0x08U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x07U, 0x06U, 0x10U,
+  0x10U, 0x05U, 0x04U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x03U, 0x02U, 0x10U,
+  0x10U, 0x01U, 0x00U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U,
+  0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U, 0x10U
+};
+#endif /* CODEC_MANCHESTER_TABLE */
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+#if !CODEC_MANCHESTER_TABLE
+static uint32_t loc_codec_manchesterPack(uint32_t l_chips);
+
+/*============================================================================*/
+/* loc_codec_manchesterPack() */
+/*============================================================================*/
+static uint32_t loc_codec_manchesterPack(uint32_t l_chips)
+{
+  /* Keep the data chips and close the gaps, the data bits of the upper half
+     end up in bits 16 to 23, the ones of the lower half in bits 0 to 7. */
+  l_chips &= CODEC_MANCHESTER_DATA;
+  l_chips = (l_chips | (l_chips >> 1U)) & 0x33333333UL;
+  l_chips = (l_chips | (l_chips >> 2U)) & 0x0F0F0F0FUL;
+  l_chips = (l_chips | (l_chips >> 4U)) & 0x00FF00FFUL;
+
+  return l_chips;
+} /* loc_codec_manchesterPack() */
+#endif /* !CODEC_MANCHESTER_TABLE */
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+
+/*============================================================================*/
+/* wmbus_codec_3outof6_encode() */
+/*============================================================================*/
+void wmbus_codec_3outof6_encode(uint8_t *pc_chips, const uint8_t *pc_data,
+                                uint16_t i_len)
+{
+  uint32_t l_chips;
+
+  for(; i_len >= 2U; i_len -= 2U)
+  {
+    l_chips = ((uint32_t)gac_codec_3outof6Enc[pc_data[0] >> 4U] << 18U) |
+              ((uint32_t)gac_codec_3outof6Enc[pc_data[0] & 0x0FU] << 12U) |
+              ((uint32_t)gac_codec_3outof6Enc[pc_data[1] >> 4U] << 6U) |
+              (uint32_t)gac_codec_3outof6Enc[pc_data[1] & 0x0FU];
+    pc_chips[0] = (uint8_t)(l_chips >> 16U);
+    pc_chips[1] = (uint8_t)(l_chips >> 8U);
+    pc_chips[2] = (uint8_t)l_chips;
+    pc_data += 2U;
+    pc_chips += 3U;
+  } /* for */
+
+  if(i_len > 0U)
+  {
+    l_chips = ((uint32_t)gac_codec_3outof6Enc[pc_data[0] >> 4U] << 10U) |
+              ((uint32_t)gac_codec_3outof6Enc[pc_data[0] & 0x0FU] << 4U) |
+              CODEC_3OUTOF6_PAD;
+    pc_chips[0] = (uint8_t)(l_chips >> 8U);
+    pc_chips[1] = (uint8_t)l_chips;
+  } /* if */
+} /* wmbus_codec_3outof6_encode() */
+
+/*============================================================================*/
+/* wmbus_codec_3outof6_decode() */
+/*============================================================================*/
+bool_t wmbus_codec_3outof6_decode(uint8_t *pc_data, const uint8_t *pc_chips,
+                                  uint16_t i_len)
+{
+  uint32_t l_chips;
+  uint8_t c_n0;
+  uint8_t c_n1;
+  uint8_t c_n2;
+  uint8_t c_n3;
+  uint8_t c_err = 0U;
+
+  for(; i_len >= 2U; i_len -= 2U)
+  {
+    l_chips = ((uint32_t)pc_chips[0] << 16U) |
+              ((uint32_t)pc_chips[1] << 8U) |
+              (uint32_t)pc_chips[2];
+    c_n0 = gac_codec_3outof6Dec[l_chips >> 18U];
+    c_n1 = gac_codec_3outof6Dec[(l_chips >> 12U) & CODEC_3OUTOF6_MASK];
+    c_n2 = gac_codec_3outof6Dec[(l_chips >> 6U) & CODEC_3OUTOF6_MASK];
+    c_n3 = gac_codec_3outof6Dec[l_chips & CODEC_3OUTOF6_MASK];
+    c_err |= (uint8_t)(c_n0 | c_n1 | c_n2 | c_n3);
+
+    pc_data[0] = (uint8_t)((c_n0 << 4U) | (c_n1 & 0x0FU));
+    pc_data[1] = (uint8_t)((c_n2 << 4U) | (c_n3 & 0x0FU));
+    pc_chips += 3U;
+    pc_data += 2U;
+  } /* for */
+
+  if(i_len > 0U)
+  {
+    l_chips = ((uint32_t)pc_chips[0] << 8U) | (uint32_t)pc_chips[1];
+    c_n0 = gac_codec_3outof6Dec[l_chips >> 10U];
+    c_n1 = gac_codec_3outof6Dec[(l_chips >> 4U) & CODEC_3OUTOF6_MASK];
+    c_err |= (uint8_t)(c_n0 | c_n1);
+
+    pc_data[0] = (uint8_t)((c_n0 << 4U) | (c_n1 & 0x0FU));
+  } /* if */
+
+  return ((c_err & CODEC_INVALID) == 0U) ? TRUE : FALSE;
+} /* wmbus_codec_3outof6_decode() */
+
+/*============================================================================*/
+/* wmbus_codec_manchester_encode() */
+/*============================================================================*/
+void wmbus_codec_manchester_encode(uint8_t *pc_chips, const uint8_t *pc_data,
+                                   uint16_t i_len)
+{
+  for(; i_len > 0U; i_len--)
+  {
+    pc_chips[0] = gac_codec_manchesterEnc[*pc_data >> 4U];
+    pc_chips[1] = gac_codec_manchesterEnc[*pc_data & 0x0FU];
+    pc_data++;
+    pc_chips += 2U;
+  } /* for */
+} /* wmbus_codec_manchester_encode() */
+
+/*============================================================================*/
+/* wmbus_codec_manchester_decode() */
+/*============================================================================*/
+bool_t wmbus_codec_manchester_decode(uint8_t *pc_data, const uint8_t *pc_chips,
+                                     uint16_t i_len)
+{
+#if CODEC_MANCHESTER_TABLE
+  uint8_t c_hi;
+  uint8_t c_lo;
+  uint8_t c_err = 0U;
+
+  for(; i_len > 0U; i_len--)
+  {
+    c_hi = gac_codec_manchesterDec[pc_chips[0]];
+    c_lo = gac_codec_manchesterDec[pc_chips[1]];
+    c_err |= (uint8_t)(c_hi | c_lo);
+
+    *pc_data = (uint8_t)((c_hi << 4U) | (c_lo & 0x0FU));
+    pc_chips += 2U;
+    pc_data++;
+  } /* for */
+
+  return ((c_err & CODEC_INVALID) == 0U) ? TRUE : FALSE;
+#else
+  uint32_t l_chips;
+  /* Each pair of chips has to differ, which keeps its data bit set. */
+  uint32_t l_valid = CODEC_MANCHESTER_DATA;
+
+  for(; i_len >= 2U; i_len -= 2U)
+  {
+    l_chips = ((uint32_t)pc_chips[0] << 24U) |
+              ((uint32_t)pc_chips[1] << 16U) |
+              ((uint32_t)pc_chips[2] << 8U) |
+              (uint32_t)pc_chips[3];
+    l_valid &= l_chips ^ (l_chips >> 1U);
+    l_chips = loc_codec_manchesterPack(l_chips);
+
+    pc_data[0] = (uint8_t)(l_chips >> 16U);
+    pc_data[1] = (uint8_t)l_chips;
+    pc_chips += 4U;
+    pc_data += 2U;
+  } /* for */
+
+  if(i_len > 0U)
+  {
+    l_chips = ((uint32_t)pc_chips[0] << 24U) |
+              ((uint32_t)pc_chips[1] << 16U) |
+              CODEC_MANCHESTER_FILL;
+    l_valid &= l_chips ^ (l_chips >> 1U);
+    l_chips = loc_codec_manchesterPack(l_chips);
+
+    pc_data[0] = (uint8_t)(l_chips >> 16U);
+  } /* if */
+
+  return (l_valid == CODEC_MANCHESTER_DATA) ? TRUE : FALSE;
+#endif /* CODEC_MANCHESTER_TABLE */
+} /* wmbus_codec_manchester_decode() */
+
+/**@}*/
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,664 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @file       wmbus_record.c
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Decoder of the data records of a telegram.
+
+  @addtogroup WMBUS_RECORD
+
+  Source implementation of the API in wmbus_record_api.h. A record is
+  decoded in a single pass over its bytes. The length and coding of the data
+  are looked up from the data field of the DIF, the unit and exponent of a
+  primary VIF from a constant table, so no record needs more than one access
+  per byte and nothing is buffered. All offsets are counted in the order of
+  transmission and only mapped to the buffer when reading a byte. A telegram
+  read through fp_read is fetched in windows of WMBUS_RECORD_WINDOW_LEN
+  bytes, which are placed ahead of the offset in the order of transmission.
+*/
+/**@{*/
+
+/*==============================================================================
+                            INCLUDE FILES
+==============================================================================*/
+#include "inc\pub\utils\wmbus_typedefs.h"
+#include "inc\pub\utils\wmbus_record_api.h"
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! Extension bit of a DIF, DIFE, VIF or VIFE. */
+#define RECORD_EXT_BIT                        0x80U
+/*! Data field of a DIF. */
+#define RECORD_DIF_DATA_MASK                  0x0FU
+/*! Function field of a DIF. */
+#define RECORD_DIF_FUNC_MASK                  0x30U
+/*! Least significant bit of the storage number within the DIF. */
+#define RECORD_DIF_STORAGE_BIT                0x40U
+
+/*! Data field announcing a special function. */
+#define RECORD_DIF_DATA_SPECIAL               0x0FU
+/*! Data field announcing a variable length. */
+#define RECORD_DIF_DATA_LVAR                  0x0DU
+/*! Manufacturer specific data up to the end. */
+#define RECORD_DIF_MANUFACTURER               0x0FU
+/*! Manufacturer specific data, more records in the next telegram. */
+#define RECORD_DIF_MANUFACTURER_MORE          0x1FU
+/*! Idle filler. */
+#define RECORD_DIF_IDLE_FILLER                0x2FU
+/*! Global readout request. */
+#define RECORD_DIF_GLOBAL_READOUT             0x7FU
+
+/*! Primary VIF announcing the first extension table. */
+#define RECORD_VIF_EXT_FB                     0x7BU
+/*! Primary VIF announcing a plain text unit. */
+#define RECORD_VIF_PLAIN_TEXT                 0x7CU
+/*! Primary VIF announcing the second extension table. */
+#define RECORD_VIF_EXT_FD                     0x7DU
+/*! Primary VIF matching any VIF. */
+#define RECORD_VIF_ANY                        0x7EU
+/*! Primary VIF announcing a manufacturer specific unit. */
+#define RECORD_VIF_MANUFACTURER               0x7FU
+
+/*! Last LVAR announcing text. */
+#define RECORD_LVAR_TEXT_MAX                  0xBFU
+/*! LVAR of positive BCD, the low nibble holds the length. */
+#define RECORD_LVAR_BCD_POS                   0xC0U
+/*! LVAR of negative BCD, the low nibble holds the length. */
+#define RECORD_LVAR_BCD_NEG                   0xD0U
+/*! LVAR of binary data, the low nibble holds the length. */
+#define RECORD_LVAR_BIN                       0xE0U
+/*! LVAR of binary data of 4 * (LVAR - 0xEC) bytes. */
+#define RECORD_LVAR_BIN_LONG                  0xF0U
+/*! Last LVAR of binary data of 4 * (LVAR - 0xEC) bytes. */
+#define RECORD_LVAR_BIN_LONG_MAX              0xF4U
+/*! LVAR of a 48 bit binary number. */
+#define RECORD_LVAR_BIN_48                    0xF5U
+/*! LVAR of a 64 bit binary number. */
+#define RECORD_LVAR_BIN_64                    0xF6U
+
+/*! Most significant digit of a negative BCD value. */
+#define RECORD_BCD_NEG_DIGIT                  0x0FU
+
+/*! Bias of the exponents stored in gas_record_vif. */
+#define RECORD_EXP_BIAS                       9
+
+/*! Entry of gas_record_vif. */
+#define VIF_E(unit, exp)    { (uint8_t)(unit),                                \
+                              (uint8_t)((exp) + RECORD_EXP_BIAS) }
+/*! Two VIFs with the exponent in the lowest bit. */
+#define VIF_2(unit, exp)    VIF_E(unit, (exp)), VIF_E(unit, (exp) + 1)
+/*! Four VIFs with the exponent in the lowest two bits. */
+#define VIF_4(unit, exp)    VIF_2(unit, (exp)), VIF_2(unit, (exp) + 2)
+/*! Eight VIFs with the exponent in the lowest three bits. */
+#define VIF_8(unit, exp)    VIF_4(unit, (exp)), VIF_4(unit, (exp) + 4)
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! Unit and exponent of a primary VIF. */
+typedef struct S_RECORD_VIF_T
+{
+  /*! Unit, of type E_WMBUS_RECORD_UNIT_t. */
+  uint8_t c_unit;
+  /*! Exponent plus RECORD_EXP_BIAS. */
+  uint8_t c_exp;
+
+} s_record_vif_t;
+
+/*==============================================================================
+                            VARIABLES
+==============================================================================*/
+/*! Length of the data by the data field of the DIF. */
+static const uint8_t gac_record_dataLen[16U] =
+{
+  0U, 1U, 2U, 3U, 4U, 4U, 6U, 8U, 0U, 1U, 2U, 3U, 4U, 0U, 6U, 0U
+};
+
+/*! Coding of the data by the data field of the DIF. */
+static const uint8_t gac_record_coding[16U] =
+{
+  (uint8_t)E_WMBUS_RECORD_CODING_NONE, (uint8_t)E_WMBUS_RECORD_CODING_INT,
+  (uint8_t)E_WMBUS_RECORD_CODING_INT,  (uint8_t)E_WMBUS_RECORD_CODING_INT,
+  (uint8_t)E_WMBUS_RECORD_CODING_INT,  (uint8_t)E_WMBUS_RECORD_CODING_REAL,
+  (uint8_t)E_WMBUS_RECORD_CODING_INT,  (uint8_t)E_WMBUS_RECORD_CODING_INT,
+  (uint8_t)E_WMBUS_RECORD_CODING_NONE, (uint8_t)E_WMBUS_RECORD_CODING_BCD,
+  (uint8_t)E_WMBUS_RECORD_CODING_BCD,  (uint8_t)E_WMBUS_RECORD_CODING_BCD,
+  (uint8_t)E_WMBUS_RECORD_CODING_BCD,  (uint8_t)E_WMBUS_RECORD_CODING_NONE,
+  (uint8_t)E_WMBUS_RECORD_CODING_BCD,  (uint8_t)E_WMBUS_RECORD_CODING_NONE
+};
+
+/*! Unit and exponent of the primary VIFs as specified by EN 13757-3. */
+static const s_record_vif_t gas_record_vif[128U] =
+{
+  /* 0x00 */ VIF_8(E_WMBUS_RECORD_UNIT_WH, -3),
+  /* 0x08 */ VIF_8(E_WMBUS_RECORD_UNIT_J, 0),
+  /* 0x10 */ VIF_8(E_WMBUS_RECORD_UNIT_M3, -6),
+  /* 0x18 */ VIF_8(E_WMBUS_RECORD_UNIT_KG, -3),
+  /* 0x20 */ VIF_4(E_WMBUS_RECORD_UNIT_ON_TIME, 0),
+  /* 0x24 */ VIF_4(E_WMBUS_RECORD_UNIT_OPERATING_TIME, 0),
+  /* 0x28 */ VIF_8(E_WMBUS_RECORD_UNIT_W, -3),
+  /* 0x30 */ VIF_8(E_WMBUS_RECORD_UNIT_J_H, 0),
+  /* 0x38 */ VIF_8(E_WMBUS_RECORD_UNIT_M3_H, -6),
+  /* 0x40 */ VIF_8(E_WMBUS_RECORD_UNIT_M3_MIN, -7),
+  /* 0x48 */ VIF_8(E_WMBUS_RECORD_UNIT_M3_S, -9),
+  /* 0x50 */ VIF_8(E_WMBUS_RECORD_UNIT_KG_H, -3),
+  /* 0x58 */ VIF_4(E_WMBUS_RECORD_UNIT_FLOW_TEMP, -3),
+  /* 0x5C */ VIF_4(E_WMBUS_RECORD_UNIT_RETURN_TEMP, -3),
+  /* 0x60 */ VIF_4(E_WMBUS_RECORD_UNIT_TEMP_DIFF, -3),
+  /* 0x64 */ VIF_4(E_WMBUS_RECORD_UNIT_EXT_TEMP, -3),
+  /* 0x68 */ VIF_4(E_WMBUS_RECORD_UNIT_BAR, -3),
+  /* 0x6C */ VIF_E(E_WMBUS_RECORD_UNIT_DATE, 0),
+  /* 0x6D */ VIF_E(E_WMBUS_RECORD_UNIT_DATE_TIME, 0),
+  /* 0x6E */ VIF_E(E_WMBUS_RECORD_UNIT_HCA, 0),
+  /* 0x6F */ VIF_E(E_WMBUS_RECORD_UNIT_NONE, 0),
+  /* 0x70 */ VIF_4(E_WMBUS_RECORD_UNIT_AVG_DURATION, 0),
+  /* 0x74 */ VIF_4(E_WMBUS_RECORD_UNIT_ACT_DURATION, 0),
+  /* 0x78 */ VIF_E(E_WMBUS_RECORD_UNIT_FABRICATION_NO, 0),
+  /* 0x79 */ VIF_E(E_WMBUS_RECORD_UNIT_ENHANCED_ID, 0),
+  /* 0x7A */ VIF_E(E_WMBUS_RECORD_UNIT_BUS_ADDRESS, 0),
+  /* 0x7B */ VIF_E(E_WMBUS_RECORD_UNIT_NONE, 0),
+  /* 0x7C */ VIF_4(E_WMBUS_RECORD_UNIT_NONE, 0),
+};
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+static E_WMBUS_RECORD_RET_t loc_record_dib(s_wmbus_record_iter_t *ps_iter,
+                                           s_wmbus_record_t *ps_record,
+                                           uint16_t *pi_offset);
+static E_WMBUS_RECORD_RET_t loc_record_vib(s_wmbus_record_iter_t *ps_iter,
+                                           s_wmbus_record_t *ps_record,
+                                           uint16_t *pi_offset);
+static E_WMBUS_RECORD_RET_t loc_record_data(s_wmbus_record_iter_t *ps_iter,
+                                            s_wmbus_record_t *ps_record,
+                                            uint16_t *pi_offset);
+
+/*============================================================================*/
+/* loc_record_dib() */
+/*============================================================================*/
+static E_WMBUS_RECORD_RET_t loc_record_dib(s_wmbus_record_iter_t *ps_iter,
+                                           s_wmbus_record_t *ps_record,
+                                           uint16_t *pi_offset)
+{
+  uint16_t i_offset = *pi_offset;
+  uint8_t c_dife = ps_record->c_dif;
+  uint8_t c_cnt = 0U;
+
+  ps_record->c_function = (ps_record->c_dif & RECORD_DIF_FUNC_MASK) >> 4U;
+  ps_record->l_storage = ((ps_record->c_dif & RECORD_DIF_STORAGE_BIT) != 0U) ?
+                         1UL : 0UL;
+
+  while((c_dife & RECORD_EXT_BIT) != 0U)
+  {
+    if(c_cnt >= WMBUS_RECORD_EXT_MAX)
+    {
+      return E_WMBUS_RECORD_ERR_EXT;
+    } /* if */
+    if(i_offset >= ps_iter->i_len)
+    {
+      return E_WMBUS_RECORD_ERR_LEN;
+    } /* if */
+
+    c_dife = wmbus_record_getByte(ps_iter, i_offset++);
+
+    /* The storage number continues above the bits of the DIF and the
+       previous DIFEs, the ones beyond 32 bits are dropped. */
+    if(c_cnt < 8U)
+    {
+      ps_record->l_storage |= (uint32_t)(c_dife & 0x0FU) <<
+                              (1U + (4U * c_cnt));
+    } /* if */
+    ps_record->l_tariff |= (uint32_t)((c_dife >> 4U) & 0x03U) << (2U * c_cnt);
+    ps_record->i_subunit |= (uint16_t)((c_dife >> 6U) & 0x01U) << c_cnt;
+    c_cnt++;
+  } /* while */
+
+  ps_record->c_difeCnt = c_cnt;
+  *pi_offset = i_offset;
+
+  return E_WMBUS_RECORD_OK;
+} /* loc_record_dib() */
+
+/*============================================================================*/
+/* loc_record_vib() */
+/*============================================================================*/
+static E_WMBUS_RECORD_RET_t loc_record_vib(s_wmbus_record_iter_t *ps_iter,
+                                           s_wmbus_record_t *ps_record,
+                                           uint16_t *pi_offset)
+{
+  uint16_t i_offset = *pi_offset;
+  uint8_t c_vif;
+  uint8_t c_cnt = 0U;
+
+  if(i_offset >= ps_iter->i_len)
+  {
+    return E_WMBUS_RECORD_ERR_LEN;
+  } /* if */
+  c_vif = wmbus_record_getByte(ps_iter, i_offset++);
+  ps_record->c_vif = c_vif & (uint8_t)~RECORD_EXT_BIT;
+
+  switch(ps_record->c_vif)
+  {
+    case RECORD_VIF_EXT_FB:
+    case RECORD_VIF_EXT_FD:
+      /* The code within the extension table follows as first VIFE. */
+      ps_record->e_vifTable = (ps_record->c_vif == RECORD_VIF_EXT_FB) ?
+                              E_WMBUS_RECORD_VIF_EXT_FB :
+                              E_WMBUS_RECORD_VIF_EXT_FD;
+      if((c_vif & RECORD_EXT_BIT) == 0U)
+      {
+        return E_WMBUS_RECORD_ERR_CODING;
+      } /* if */
+      if(i_offset >= ps_iter->i_len)
+      {
+        return E_WMBUS_RECORD_ERR_LEN;
+      } /* if */
+      c_vif = wmbus_record_getByte(ps_iter, i_offset++);
+      ps_record->c_vif = c_vif & (uint8_t)~RECORD_EXT_BIT;
+      break;
+
+    case RECORD_VIF_PLAIN_TEXT:
+      ps_record->e_vifTable = E_WMBUS_RECORD_VIF_PLAIN_TEXT;
+      break;
+
+    case RECORD_VIF_ANY:
+      ps_record->e_vifTable = E_WMBUS_RECORD_VIF_ANY;
+      break;
+
+    case RECORD_VIF_MANUFACTURER:
+      ps_record->e_vifTable = E_WMBUS_RECORD_VIF_MANUFACTURER;
+      break;
+
+    default:
+      ps_record->e_vifTable = E_WMBUS_RECORD_VIF_PRIMARY;
+      ps_record->e_unit = (E_WMBUS_RECORD_UNIT_t)
+                          gas_record_vif[ps_record->c_vif].c_unit;
+      ps_record->i_exponent = (sint16_t)
+        ((sint16_t)gas_record_vif[ps_record->c_vif].c_exp - RECORD_EXP_BIAS);
+      break;
+  } /* switch */
+
+  ps_record->i_vifeOffset = i_offset;
+  while((c_vif & RECORD_EXT_BIT) != 0U)
+  {
+    if(c_cnt >= WMBUS_RECORD_EXT_MAX)
+    {
+      return E_WMBUS_RECORD_ERR_EXT;
+    } /* if */
+    if(i_offset >= ps_iter->i_len)
+    {
+      return E_WMBUS_RECORD_ERR_LEN;
+    } /* if */
+    c_vif = wmbus_record_getByte(ps_iter, i_offset++);
+    c_cnt++;
+  } /* while */
+  ps_record->c_vifeCnt = c_cnt;
+
+  if(ps_record->e_vifTable == E_WMBUS_RECORD_VIF_PLAIN_TEXT)
+  {
+    /* The length and the text of the unit follow the VIFEs. */
+    if(i_offset >= ps_iter->i_len)
+    {
+      return E_WMBUS_RECORD_ERR_LEN;
+    } /* if */
+    ps_record->c_textLen = wmbus_record_getByte(ps_iter, i_offset++);
+    if(ps_record->c_textLen > (ps_iter->i_len - i_offset))
+    {
+      return E_WMBUS_RECORD_ERR_LEN;
+    } /* if */
+    ps_record->i_textOffset = i_offset;
+    i_offset += ps_record->c_textLen;
+  } /* if */
+
+  *pi_offset = i_offset;
+
+  return E_WMBUS_RECORD_OK;
+} /* loc_record_vib() */
+
+/*============================================================================*/
+/* loc_record_data() */
+/*============================================================================*/
+static E_WMBUS_RECORD_RET_t loc_record_data(s_wmbus_record_iter_t *ps_iter,
+                                            s_wmbus_record_t *ps_record,
+                                            uint16_t *pi_offset)
+{
+  uint16_t i_offset = *pi_offset;
+  uint8_t c_field = ps_record->c_dif & RECORD_DIF_DATA_MASK;
+  uint8_t c_lvar;
+
+  if(c_field != RECORD_DIF_DATA_LVAR)
+  {
+    ps_record->e_coding = (E_WMBUS_RECORD_CODING_t)gac_record_coding[c_field];
+    ps_record->i_dataLen = gac_record_dataLen[c_field];
+  }
+  else
+  {
+    if(i_offset >= ps_iter->i_len)
+    {
+      return E_WMBUS_RECORD_ERR_LEN;
+    } /* if */
+    c_lvar = wmbus_record_getByte(ps_iter, i_offset++);
+    ps_record->c_lvar = c_lvar;
+
+    if(c_lvar <= RECORD_LVAR_TEXT_MAX)
+    {
+      ps_record->e_coding = E_WMBUS_RECORD_CODING_TEXT;
+      ps_record->i_dataLen = c_lvar;
+    }
+    else if(c_lvar < RECORD_LVAR_BIN_LONG)
+    {
+      /* BCD or binary data with the length in the low nibble. */
+      if(((c_lvar & 0xF0U) != RECORD_LVAR_BIN) &&
+         ((c_lvar & 0x0FU) > 9U))
+      {
+        return E_WMBUS_RECORD_ERR_CODING;
+      } /* if */
+      ps_record->e_coding = ((c_lvar & 0xF0U) == RECORD_LVAR_BIN) ?
+                            E_WMBUS_RECORD_CODING_INT :
+                            E_WMBUS_RECORD_CODING_BCD;
+      ps_record->i_dataLen = c_lvar & 0x0FU;
+    }
+    else if(c_lvar <= RECORD_LVAR_BIN_LONG_MAX)
+    {
+      ps_record->e_coding = E_WMBUS_RECORD_CODING_INT;
+      ps_record->i_dataLen = 4U * (c_lvar - 0xECU);
+    }
+    else if((c_lvar == RECORD_LVAR_BIN_48) || (c_lvar == RECORD_LVAR_BIN_64))
+    {
+      ps_record->e_coding = E_WMBUS_RECORD_CODING_INT;
+      ps_record->i_dataLen = (c_lvar == RECORD_LVAR_BIN_48) ? 6U : 8U;
+    }
+    else
+    {
+      return E_WMBUS_RECORD_ERR_CODING;
+    } /* if ... else */
+  } /* if ... else */
+
+  if(ps_record->i_dataLen > (ps_iter->i_len - i_offset))
+  {
+    return E_WMBUS_RECORD_ERR_LEN;
+  } /* if */
+  ps_record->i_dataOffset = i_offset;
+  *pi_offset = i_offset + ps_record->i_dataLen;
+
+  return E_WMBUS_RECORD_OK;
+} /* loc_record_data() */
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+
+/*============================================================================*/
+/* wmbus_record_init() */
+/*============================================================================*/
+void wmbus_record_init(s_wmbus_record_iter_t *ps_iter, const uint8_t *pc_data,
+                       uint16_t i_len, bool_t b_reverse)
+{
+  ps_iter->pc_data = pc_data;
+  ps_iter->fp_read = NULL;
+  ps_iter->i_len = i_len;
+  ps_iter->i_offset = 0U;
+  ps_iter->b_reverse = b_reverse;
+} /* wmbus_record_init() */
+
+/*============================================================================*/
+/* wmbus_record_initRead() */
+/*============================================================================*/
+void wmbus_record_initRead(s_wmbus_record_iter_t *ps_iter,
+                           fp_wmbus_record_read_t fp_read, uint8_t c_tlgId,
+                           uint16_t i_len, bool_t b_reverse)
+{
+  wmbus_record_init(ps_iter, NULL, i_len, b_reverse);
+  ps_iter->fp_read = fp_read;
+  ps_iter->c_tlgId = c_tlgId;
+  ps_iter->i_windowOffset = 0U;
+  ps_iter->i_windowLen = 0U;
+} /* wmbus_record_initRead() */
+
+/*============================================================================*/
+/* wmbus_record_next() */
+/*============================================================================*/
+E_WMBUS_RECORD_RET_t wmbus_record_next(s_wmbus_record_iter_t *ps_iter,
+                                       s_wmbus_record_t *ps_record)
+{
+  E_WMBUS_RECORD_RET_t e_ret = E_WMBUS_RECORD_OK;
+  uint16_t i_offset = ps_iter->i_offset;
+  uint8_t c_dif = RECORD_DIF_IDLE_FILLER;
+
+  /* Skip the idle fillers. */
+  while((c_dif == RECORD_DIF_IDLE_FILLER) && (i_offset < ps_iter->i_len))
+  {
+    c_dif = wmbus_record_getByte(ps_iter, i_offset++);
+  } /* while */
+
+  if(c_dif == RECORD_DIF_IDLE_FILLER)
+  {
+    ps_iter->i_offset = ps_iter->i_len;
+    return E_WMBUS_RECORD_END;
+  } /* if */
+
+  MEMSET(ps_record, 0U, sizeof(s_wmbus_record_t));
+  ps_record->c_dif = c_dif;
+
+  if((c_dif & RECORD_DIF_DATA_MASK) == RECORD_DIF_DATA_SPECIAL)
+  {
+    switch(c_dif)
+    {
+      case RECORD_DIF_MANUFACTURER:
+      case RECORD_DIF_MANUFACTURER_MORE:
+        /* The remaining bytes are not structured as records. */
+        ps_record->e_vifTable = E_WMBUS_RECORD_VIF_NONE;
+        ps_record->e_coding = E_WMBUS_RECORD_CODING_MANUFACTURER;
+        ps_record->i_dataOffset = i_offset;
+        ps_record->i_dataLen = ps_iter->i_len - i_offset;
+        ps_record->b_moreRecords = (c_dif == RECORD_DIF_MANUFACTURER_MORE) ?
+                                   TRUE : FALSE;
+        i_offset = ps_iter->i_len;
+        break;
+
+      case RECORD_DIF_GLOBAL_READOUT:
+        ps_record->e_vifTable = E_WMBUS_RECORD_VIF_NONE;
+        break;
+
+      default:
+        e_ret = E_WMBUS_RECORD_ERR_CODING;
+        break;
+    } /* switch */
+  }
+  else
+  {
+    e_ret = loc_record_dib(ps_iter, ps_record, &i_offset);
+    if(e_ret == E_WMBUS_RECORD_OK)
+    {
+      e_ret = loc_record_vib(ps_iter, ps_record, &i_offset);
+    } /* if */
+    if(e_ret == E_WMBUS_RECORD_OK)
+    {
+      e_ret = loc_record_data(ps_iter, ps_record, &i_offset);
+    } /* if */
+  } /* if ... else */
+
+  /* Stop the iteration on an error, the following bytes can not be
+     assigned to records anymore. */
+  ps_iter->i_offset = (e_ret == E_WMBUS_RECORD_OK) ? i_offset : ps_iter->i_len;
+
+  return e_ret;
+} /* wmbus_record_next() */
+
+/*============================================================================*/
+/* wmbus_record_getByte() */
+/*============================================================================*/
+uint8_t wmbus_record_getByte(s_wmbus_record_iter_t *ps_iter,
+                             uint16_t i_offset)
+{
+  uint16_t i_len;
+
+  if(ps_iter->b_reverse == TRUE)
+  {
+    i_offset = ps_iter->i_len - 1U - i_offset;
+  } /* if */
+
+  if(ps_iter->fp_read == NULL)
+  {
+    return ps_iter->pc_data[i_offset];
+  } /* if */
+
+  if((i_offset < ps_iter->i_windowOffset) ||
+     (i_offset >= (ps_iter->i_windowOffset + ps_iter->i_windowLen)))
+  {
+    /* Read the window ahead in the order of transmission, which is
+       backwards within a reversed buffer. */
+    if((ps_iter->b_reverse == TRUE) &&
+       (i_offset >= WMBUS_RECORD_WINDOW_LEN))
+    {
+      ps_iter->i_windowOffset = i_offset - (WMBUS_RECORD_WINDOW_LEN - 1U);
+    }
+    else if(ps_iter->b_reverse == TRUE)
+    {
+      ps_iter->i_windowOffset = 0U;
+    }
+    else
+    {
+      ps_iter->i_windowOffset = i_offset;
+    } /* if ... else if ... else */
+
+    i_len = ps_iter->i_len - ps_iter->i_windowOffset;
+    if(i_len > WMBUS_RECORD_WINDOW_LEN)
+    {
+      i_len = WMBUS_RECORD_WINDOW_LEN;
+    } /* if */
+    ps_iter->i_windowLen = ps_iter->fp_read(ps_iter->c_tlgId,
+                                            ps_iter->ac_window, i_len,
+                                            ps_iter->i_windowOffset);
+    if(i_offset >= (ps_iter->i_windowOffset + ps_iter->i_windowLen))
+    {
+      /* The telegram is shorter than announced. */
+      return 0U;
+    } /* if */
+  } /* if */
+
+  return ps_iter->ac_window[i_offset - ps_iter->i_windowOffset];
+} /* wmbus_record_getByte() */
+
+/*============================================================================*/
+/* wmbus_record_getValue() */
+/*============================================================================*/
+bool_t wmbus_record_getValue(s_wmbus_record_iter_t *ps_iter,
+                             const s_wmbus_record_t *ps_record,
+                             sint32_t *pl_value)
+{
+  uint16_t i_offset = ps_record->i_dataOffset;
+  uint16_t i_len = ps_record->i_dataLen;
+  uint16_t i_i;
+  uint32_t l_value;
+  uint8_t c_byte;
+  uint8_t c_digit;
+  uint8_t c_sign;
+  bool_t b_negative;
+
+  if(i_len == 0U)
+  {
+    return FALSE;
+  } /* if */
+
+  if(ps_record->e_coding == E_WMBUS_RECORD_CODING_INT)
+  {
+    /* Bytes beyond 32 bits have to be the sign extension. */
+    c_byte = wmbus_record_getByte(ps_iter, i_offset + i_len - 1U);
+    c_sign = ((c_byte & 0x80U) != 0U) ? 0xFFU : 0x00U;
+    for(i_i = i_len; i_i > 4U; i_i--)
+    {
+      if(wmbus_record_getByte(ps_iter, i_offset + i_i - 1U) != c_sign)
+      {
+        return FALSE;
+      } /* if */
+    } /* for */
+    if((i_len > 4U) &&
+       (((wmbus_record_getByte(ps_iter, i_offset + 3U) ^ c_sign) & 0x80U) !=
+        0U))
+    {
+      return FALSE;
+    } /* if */
+
+    l_value = (c_sign != 0U) ? 0xFFFFFFFFUL : 0UL;
+    for(i_i = (i_len > 4U) ? 4U : i_len; i_i > 0U; i_i--)
+    {
+      l_value = (l_value << 8U) |
+                wmbus_record_getByte(ps_iter, i_offset + i_i - 1U);
+    } /* for */
+
+    *pl_value = (sint32_t)l_value;
+    return TRUE;
+  } /* if */
+
+  if(ps_record->e_coding == E_WMBUS_RECORD_CODING_BCD)
+  {
+    /* LVAR announces the sign, otherwise a most significant digit of 0xF. */
+    b_negative = FALSE;
+    if((ps_record->c_dif & RECORD_DIF_DATA_MASK) == RECORD_DIF_DATA_LVAR)
+    {
+      b_negative = ((ps_record->c_lvar & 0xF0U) == RECORD_LVAR_BCD_NEG) ?
+                   TRUE : FALSE;
+    } /* if */
+
+    l_value = 0UL;
+    for(i_i = i_len * 2U; i_i > 0U; i_i--)
+    {
+      c_byte = wmbus_record_getByte(ps_iter, i_offset + ((i_i - 1U) / 2U));
+      c_digit = ((i_i & 1U) == 0U) ? (c_byte >> 4U) : (c_byte & 0x0FU);
+
+      if((i_i == (i_len * 2U)) && (c_digit == RECORD_BCD_NEG_DIGIT) &&
+         ((ps_record->c_dif & RECORD_DIF_DATA_MASK) != RECORD_DIF_DATA_LVAR))
+      {
+        b_negative = TRUE;
+        continue;
+      } /* if */
+
+      if((c_digit > 9U) || (l_value > ((0x7FFFFFFFUL - c_digit) / 10UL)))
+      {
+        return FALSE;
+      } /* if */
+      l_value = (l_value * 10UL) + c_digit;
+    } /* for */
+
+    *pl_value = (b_negative == TRUE) ? -(sint32_t)l_value : (sint32_t)l_value;
+    return TRUE;
+  } /* if */
+
+  return FALSE;
+} /* wmbus_record_getValue() */
+
+/*============================================================================*/
+/* wmbus_record_getReal() */
+/*============================================================================*/
+bool_t wmbus_record_getReal(s_wmbus_record_iter_t *ps_iter,
+                            const s_wmbus_record_t *ps_record,
+                            float *pf_value)
+{
+  uint32_t l_value = 0UL;
+  uint8_t c_i;
+
+  if((ps_record->e_coding != E_WMBUS_RECORD_CODING_REAL) ||
+     (ps_record->i_dataLen != 4U))
+  {
+    return FALSE;
+  } /* if */
+
+  for(c_i = 4U; c_i > 0U; c_i--)
+  {
+    l_value = (l_value << 8U) |
+              wmbus_record_getByte(ps_iter, ps_record->i_dataOffset + c_i - 1U);
+  } /* for */
+  MEMCPY(pf_value, &l_value, sizeof(float));
+
+  return TRUE;
+} /* wmbus_record_getReal() */
+
+/**@}*/
+#ifdef __cplusplus
+}
+#endif
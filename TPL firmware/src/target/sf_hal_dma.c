@@ -0,0 +1,99 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @file       sf_hal_dma.c
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      HAL for the DMA controller.
+  @addtogroup SF_HAL_DMA
+
+  The DMA controller handling is implemented in `/src/target/`sf_hal_dma.c.
+
+*/
+/**@{*/
+
+/*==============================================================================
+                            INCLUDE FILES
+==============================================================================*/
+/*! Stack includes */
+#include "inc\pub\utils\wmbus_typedefs.h"
+
+#include "sf_hal_dma.h"
+
+/*! EFM32LIB includes */
+#include "em_cmu.h"
+#include "em_dma.h"
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! The alternate descriptors are located at an offset depending on the number
+    of channels. Therefore the control block has to be sized for the next
+    power of two of the available channels. */
+#if (DMA_CHAN_COUNT <= 4)
+  #define DMA_CTRL_CH_CNT                     (4U)
+  #define DMA_CTRL_ALIGNMENT                  256
+#elif (DMA_CHAN_COUNT <= 8)
+  #define DMA_CTRL_CH_CNT                     (8U)
+  #define DMA_CTRL_ALIGNMENT                  256
+#else
+  #define DMA_CTRL_CH_CNT                     (16U)
+  #define DMA_CTRL_ALIGNMENT                  512
+#endif /* DMA_CHAN_COUNT */
+
+/** Verify the channels assigned to the drivers are available. */
+#if (SF_HAL_DMA_CH_SPI_TX >= DMA_CHAN_COUNT)
+  #error Not enough DMA channels available for the SPI driver.
+#endif
+
+#if (SF_HAL_DMA_CH_UART_TX >= DMA_CHAN_COUNT)
+  #error Not enough DMA channels available for the LEUART driver.
+#endif
+
+/*==============================================================================
+                            LOCAL VARIABLES
+==============================================================================*/
+/*! DMA control block holding the primary and alternate descriptors. */
+#if defined(__ICCARM__)
+#pragma data_alignment=DMA_CTRL_ALIGNMENT
+static DMA_DESCRIPTOR_TypeDef gas_dma_ctrlBlock[DMA_CTRL_CH_CNT * 2U];
+#elif defined(__GNUC__)
+static DMA_DESCRIPTOR_TypeDef gas_dma_ctrlBlock[DMA_CTRL_CH_CNT * 2U]
+                                __attribute__ ((aligned(DMA_CTRL_ALIGNMENT)));
+#else
+  #error Alignment of the DMA control block is not supported by the compiler.
+#endif
+
+/*! Set as soon as the DMA controller has been initialized. */
+static bool_t gb_dma_init = FALSE;
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/* sf_hal_dma_init() */
+/*============================================================================*/
+void sf_hal_dma_init(void)
+{
+  DMA_Init_TypeDef s_dmaInit;
+
+  if(gb_dma_init == FALSE)
+  {
+    CMU_ClockEnable(cmuClock_DMA, true);
+
+    s_dmaInit.hprot = 0U;
+    s_dmaInit.controlBlock = gas_dma_ctrlBlock;
+    DMA_Init(&s_dmaInit);
+
+    gb_dma_init = TRUE;
+  } /* if */
+
+  return;
+} /* sf_hal_dma_init() */
+
+/**@}*/
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,44 @@
+#ifndef __SF_HAL_DMA_H__
+#define __SF_HAL_DMA_H__
+
+/**
+  @file       sf_hal_dma.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      HAL module sharing the DMA controller between the drivers.
+
+  @defgroup   SF_HAL_DMA DMA controller HAL
+
+  The EFM/EZR devices provide a single DMA controller with one control block
+  for all of its channels. This module owns that control block and assigns the
+  channels to the HAL drivers making use of the DMA, e.g. the SPI driver
+  for accessing the Si446x FIFOs or the LEUART driver.
+*/
+/**@{*/
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! DMA channel used by the SPI driver for reading from the USART. */
+#define SF_HAL_DMA_CH_SPI_RX              (0U)
+/*! DMA channel used by the SPI driver for writing to the USART. */
+#define SF_HAL_DMA_CH_SPI_TX              (1U)
+/*! DMA channel used by the LEUART driver for receiving. */
+#define SF_HAL_DMA_CH_UART_RX             (2U)
+/*! DMA channel used by the LEUART driver for transmitting. */
+#define SF_HAL_DMA_CH_UART_TX             (3U)
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/**
+  @brief  Initializes the DMA controller.
+          Enables the DMA clock and hands the control block over to the
+          controller. The function may be called by every driver using the
+          DMA, only the first call initializes the controller.
+*/
+void sf_hal_dma_init(void);
+
+/**@}*/
+#endif /* __SF_HAL_DMA_H__ */
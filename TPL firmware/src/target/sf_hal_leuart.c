@@ -22,6 +22,8 @@ extern "C" {
 #include "inc\pub\utils\wmbus_typedefs.h"
 #include "inc\pub\hal\wmbus_hal_uart.h"
 
+#include "sf_hal_leuart.h"
+
 /*! EFM32LIB includes */
 #include "em_chip.h"
 #include "em_emu.h"
@@ -51,31 +53,113 @@ extern "C" {
 /*==============================================================================
                             CONFIGURATION
 ==============================================================================*/
-
-/*! Sets the length of the Rx ringbuffer. */
-#define UART_BUFFER_RX_LEN            20U
+#ifndef UART_DMA_ENABLED
+/*! Use the DMA for receiving and transmitting instead of one interrupt per
+    byte. */
+#define UART_DMA_ENABLED              TRUE
+#endif /* UART_DMA_ENABLED */
+
+#if UART_DMA_ENABLED
+#include "em_dma.h"
+#include "sf_hal_dma.h"
+#endif /* UART_DMA_ENABLED */
+
+#ifndef UART_BAUDRATE
+/*! Baud rate of the LEUART. */
+#define UART_BAUDRATE                 9600U
+#endif /* UART_BAUDRATE */
+
+#ifndef UART_BUFFER_RX_LEN
+/*! Sets the length of the Rx ringbuffer. Using the DMA, the length has to
+    be a power of two and the buffer is received in two halves. Each half has
+    to cover the bytes arriving while the DMA interrupt is blocked, e.g. by
+    erasing a flash page. */
+#define UART_BUFFER_RX_LEN            128U
+#endif /* UART_BUFFER_RX_LEN */
+
+#ifndef UART_BUFFER_TX_LEN
 /*! Sets the length of the Tx ringbuffer. */
-#define UART_BUFFER_TX_LEN            50U
+#define UART_BUFFER_TX_LEN            128U
+#endif /* UART_BUFFER_TX_LEN */
 
 #ifndef UART_USE_TX_IRQ
 /*! Enable UART Tx interrupts. */
 #define UART_USE_TX_IRQ               TRUE
 #endif /* UART_USE_TX_IRQ */
 
+/*! Highest baud rate supported by the LFXO. Higher baud rates are derived
+    from the HFCLK, the LEUART does not run in EM2 in that case. */
+#define UART_LFXO_BAUDRATE_MAX        9600U
+
+/*! Maximum ratio between the LEUART clock and the baud rate. */
+#define UART_CLKDIV_RATIO_MAX         128U
+
+#if UART_DMA_ENABLED
+#ifndef UART_USART_DMAREQ_RX
+#error: define UART_USART_DMAREQ_RX
+#endif
+
+#ifndef UART_USART_DMAREQ_TX
+#error: define UART_USART_DMAREQ_TX
+#endif
+
+/*! Maximum number of bytes a single DMA descriptor is able to transfer. */
+#define UART_DMA_CHUNK_LEN            1024U
+
+/*! Number of bytes received by one DMA descriptor. */
+#define UART_DMA_RX_HALF_LEN          (UART_BUFFER_RX_LEN / 2U)
+
+/* The byte counters wrap around, which keeps the ring buffer position
+   consistent for a power of two length only. */
+#if ((UART_BUFFER_RX_LEN & (UART_BUFFER_RX_LEN - 1U)) != 0U) || \
+    (UART_DMA_RX_HALF_LEN > UART_DMA_CHUNK_LEN)
+#error: UART_BUFFER_RX_LEN has to be a power of two of at most 2048 bytes.
+#endif
+#endif /* UART_DMA_ENABLED */
+
 LEUART_TypeDef *usart_interface          = UART_USART_INTERFACE;
 
-LEUART_Init_TypeDef usart_settings       =   
-{   leuartEnable,      /* Enable RX/TX when init completed. */                                
+LEUART_Init_TypeDef usart_settings       =
+{   leuartEnable,      /* Enable RX/TX when init completed. */
     0,                 /* Use current configured reference clock for configuring baudrate. */
-    9600,            /* 9600 bits/s. */
-    leuartDatabits8,   /* 8 databits. */                                                      
-    leuartNoParity,    /* No parity. */                                                       
-    leuartStopbits1    /* 1 stopbit. */                                                      
+    UART_BAUDRATE,     /* Baud rate. */
+    leuartDatabits8,   /* 8 databits. */
+    leuartNoParity,    /* No parity. */
+    leuartStopbits1    /* 1 stopbit. */
 };
-                                
+
 /*==============================================================================
                             VARIABLES
 ==============================================================================*/
+/*! Statistics of the driver. */
+static s_sf_hal_leuart_stats_t gs_uart_stats;
+/*! Set if there was a Rx buffer overflow. */
+volatile bool_t gb_uart_bufferRxOverflow;
+
+#if UART_DMA_ENABLED
+/*! Input ring buffer, written by the DMA. */
+static uint8_t gc_uart_bufferRx[UART_BUFFER_RX_LEN];
+/*! Number of buffer halves completely received by the DMA. */
+static volatile uint32_t gl_uart_bufferRxHalfCnt;
+/*! Total number of bytes read from the Rx ring buffer. Together with the
+    number of received bytes, it gives the read position and fill level. */
+static uint32_t gl_uart_bufferRxReadCnt;
+/*! Callback structure of the DMA Rx channel. */
+static DMA_CB_TypeDef gs_uart_dmaRxCb;
+
+/*! Output ring buffer, read by the DMA. */
+static uint8_t gc_uart_bufferTx[UART_BUFFER_TX_LEN];
+/*! Index of the Tx ring buffer's current write position. */
+static uint16_t gi_uart_bufferTxWrite;
+/*! Index of the Tx ring buffer's current read position. */
+static volatile uint16_t gi_uart_bufferTxRead;
+/*! Number of bytes in the output buffer. */
+static volatile uint16_t gi_uart_bufferTxLen;
+/*! Number of bytes of the running DMA transfer, zero if idle. */
+static volatile uint16_t gi_uart_dmaTxLen;
+/*! Callback structure of the DMA Tx channel. */
+static DMA_CB_TypeDef gs_uart_dmaTxCb;
+#else
 /*! Input ring buffer. */
 volatile uint8_t gc_uart_bufferRx[UART_BUFFER_RX_LEN];
 /*! Pointer to the Rx ring buffer's current write position */
@@ -84,8 +168,6 @@ volatile uint8_t *gpc_uart_bufferRxWrite;
 volatile uint8_t *gpc_uart_bufferRxRead;
 /*! Number of bytes in the input buffer. */
 volatile uint16_t gi_uart_bufferRxLen;
-/*! Set if there was a Rx buffer overflow. */
-volatile bool_t gb_uart_bufferRxOverflow;
 
 /*! Input ring buffer. */
 volatile uint8_t gc_uart_bufferTx[UART_BUFFER_TX_LEN];
@@ -95,26 +177,214 @@ volatile uint8_t *gpc_uart_bufferTxWrite;
 volatile uint8_t *gpc_uart_bufferTxRead;
 /*! Number of bytes in the input buffer. */
 volatile uint16_t gi_uart_bufferTxLen;
+#endif /* UART_DMA_ENABLED */
 
 /*==============================================================================
                          LOCAL   FUNCTIONS
 ==============================================================================*/
+#if UART_DMA_ENABLED
+/*============================================================================*/
+/**
+  @brief  Returns the total number of bytes received by the DMA.
+          The number is built from the completed buffer halves and the
+          progress of the active descriptor. A completion not handled by the
+          DMA interrupt yet is taken into account. The DMA keeps running while
+          the registers are read, so they are read until consistent.
+  @return Total number of received bytes.
+*/
+/*============================================================================*/
+static uint32_t loc_uart_dmaRxCnt(void)
+{
+  DMA_DESCRIPTOR_TypeDef *ps_descr;
+  uint32_t l_mask = (1UL << SF_HAL_DMA_CH_UART_RX);
+  uint32_t l_halfCnt;
+  uint32_t l_alt;
+  uint32_t l_pending;
+  uint32_t l_enabled;
+  uint32_t l_left;
+
+  __disable_irq();
+  do
+  {
+    l_pending = (DMA->IF & l_mask);
+    l_alt = (DMA->CHALTS & l_mask);
+    l_enabled = (DMA->CHENS & l_mask);
+    ps_descr = (DMA_DESCRIPTOR_TypeDef *)((l_alt != 0UL) ?
+                                          DMA->ALTCTRLBASE : DMA->CTRLBASE);
+    ps_descr += SF_HAL_DMA_CH_UART_RX;
+    l_left = ((ps_descr->CTRL & _DMA_CTRL_N_MINUS_1_MASK) >>
+              _DMA_CTRL_N_MINUS_1_SHIFT) + 1UL;
+  } while((l_pending != (DMA->IF & l_mask)) ||
+          (l_alt != (DMA->CHALTS & l_mask)) ||
+          (l_enabled != (DMA->CHENS & l_mask)));
+
+  l_halfCnt = gl_uart_bufferRxHalfCnt;
+  __enable_irq();
+
+  if(l_enabled == 0UL)
+  {
+    /* Both halves have completed without the interrupt refreshing them. */
+    l_halfCnt += 2UL;
+    l_left = UART_DMA_RX_HALF_LEN;
+  }
+  else if(l_pending != 0UL)
+  {
+    l_halfCnt++;
+  } /* if ... else if */
+
+  return ((l_halfCnt * UART_DMA_RX_HALF_LEN) +
+          (UART_DMA_RX_HALF_LEN - l_left));
+} /* loc_uart_dmaRxCnt() */
+
+/*============================================================================*/
+/**
+  @brief  Starts receiving into both halves of the Rx ring buffer.
+          The primary descriptor receives into the half following the last
+          completed one.
+*/
+/*============================================================================*/
+static void loc_uart_dmaRxStart(void)
+{
+  uint8_t *pc_first;
+  uint8_t *pc_second;
+
+  if((gl_uart_bufferRxHalfCnt & 1UL) == 0UL)
+  {
+    pc_first = &gc_uart_bufferRx[0U];
+    pc_second = &gc_uart_bufferRx[UART_DMA_RX_HALF_LEN];
+  }
+  else
+  {
+    pc_first = &gc_uart_bufferRx[UART_DMA_RX_HALF_LEN];
+    pc_second = &gc_uart_bufferRx[0U];
+  } /* if ... else */
+
+  DMA_ActivatePingPong(SF_HAL_DMA_CH_UART_RX, false,
+                       pc_first, (void*) &(usart_interface->RXDATA),
+                       UART_DMA_RX_HALF_LEN - 1U,
+                       pc_second, (void*) &(usart_interface->RXDATA),
+                       UART_DMA_RX_HALF_LEN - 1U);
+  return;
+} /* loc_uart_dmaRxStart() */
+
+/*============================================================================*/
+/**
+  @brief  Completion callback of the DMA Rx channel.
+          Called each time a half of the Rx ring buffer has been received.
+          The completed descriptor is refilled for the same half, so the DMA
+          keeps receiving in a circle. If the interrupt has been blocked for
+          both halves, the DMA has stopped and is restarted.
+  @param  channel   DMA channel that has completed.
+  @param  primary   TRUE if the primary descriptor has completed.
+  @param  user      Unused user pointer.
+*/
+/*============================================================================*/
+static void loc_uart_dmaRxDone(unsigned int channel, bool primary, void *user)
+{
+  if((DMA->CHENS & (1UL << SF_HAL_DMA_CH_UART_RX)) == 0UL)
+  {
+    gl_uart_bufferRxHalfCnt += 2UL;
+    loc_uart_dmaRxStart();
+  }
+  else
+  {
+    gl_uart_bufferRxHalfCnt++;
+    DMA_RefreshPingPong(SF_HAL_DMA_CH_UART_RX, primary, false,
+                        NULL, NULL, UART_DMA_RX_HALF_LEN - 1U, false);
+  } /* if ... else */
+
+  (void) channel;
+  (void) user;
+
+  return;
+} /* loc_uart_dmaRxDone() */
+
+/*============================================================================*/
+/**
+  @brief  Starts transmitting the next contiguous part of the Tx ring buffer.
+          Must be called with the Tx channel being idle and at least one byte
+          in the buffer.
+*/
+/*============================================================================*/
+static void loc_uart_dmaTxStart(void)
+{
+  uint16_t i_len = gi_uart_bufferTxLen;
+
+  if(i_len > (UART_BUFFER_TX_LEN - gi_uart_bufferTxRead))
+  {
+    i_len = (UART_BUFFER_TX_LEN - gi_uart_bufferTxRead);
+  } /* if */
+
+  if(i_len > UART_DMA_CHUNK_LEN)
+  {
+    i_len = UART_DMA_CHUNK_LEN;
+  } /* if */
+
+  gi_uart_dmaTxLen = i_len;
+  DMA_ActivateBasic(SF_HAL_DMA_CH_UART_TX, true, false,
+                    (void*) &(usart_interface->TXDATA),
+                    &gc_uart_bufferTx[gi_uart_bufferTxRead], i_len - 1U);
+  return;
+} /* loc_uart_dmaTxStart() */
+
+/*============================================================================*/
+/**
+  @brief  Completion callback of the DMA Tx channel.
+          Releases the transmitted bytes and starts the next transfer if
+          further bytes have been written meanwhile.
+  @param  channel   DMA channel that has completed.
+  @param  primary   TRUE if the primary descriptor has completed.
+  @param  user      Unused user pointer.
+*/
+/*============================================================================*/
+static void loc_uart_dmaTxDone(unsigned int channel, bool primary, void *user)
+{
+  uint16_t i_len = gi_uart_dmaTxLen;
+
+  gi_uart_bufferTxRead += i_len;
+  if(gi_uart_bufferTxRead >= UART_BUFFER_TX_LEN)
+  {
+    gi_uart_bufferTxRead -= UART_BUFFER_TX_LEN;
+  } /* if */
+  gi_uart_bufferTxLen -= i_len;
+  gs_uart_stats.l_txBytes += i_len;
+  gi_uart_dmaTxLen = 0U;
 
+  if(gi_uart_bufferTxLen > 0U)
+  {
+    loc_uart_dmaTxStart();
+  } /* if */
+
+  (void) channel;
+  (void) primary;
+  (void) user;
+
+  return;
+} /* loc_uart_dmaTxDone() */
+
+#else
 /*========================= UART Input ISR ===================================*/
 /*============================================================================*/
 /* loc_sf_uart_rx_isr() */
 /*============================================================================*/
 void loc_sf_uart_rx_isr(void)
 {
-  /*! If the Rx-ringbuffer is full, disable the Rx-interrupt. */
+  uint8_t c_data;
+
+  /*! Read the byte, this clears the Rx-interrupt. */
+  c_data = LEUART_Rx(usart_interface);
+
+  /*! If the Rx-ringbuffer is full, the byte is dropped. Reception continues
+      as soon as the stack has read some bytes. */
   if(UART_BUFFER_RX_LEN <= gi_uart_bufferRxLen)
   {
-    usart_interface->IEN &= ~LEUART_IEN_RXDATAV;
     gb_uart_bufferRxOverflow = TRUE;
+    gs_uart_stats.l_rxOverflow++;
+    gs_uart_stats.l_rxLost++;
     return;
   }
-  /*! Otherwise read the next byte into the Rx-ringbuffer. */
-  *gpc_uart_bufferRxWrite++ = LEUART_Rx(usart_interface);  
+  /*! Otherwise store the byte in the Rx-ringbuffer. */
+  *gpc_uart_bufferRxWrite++ = c_data;
   /*! Increase the number of bytes in Rx-ringbuffer. */
   gi_uart_bufferRxLen++;
   /*! Check for an overflow of the read pointer and adjust if required. */
@@ -123,8 +393,6 @@ void loc_sf_uart_rx_isr(void)
     gpc_uart_bufferRxWrite = gc_uart_bufferRx;
   } /* if */
 
-  /*! Reset the Rx-interrupt. */
-  LEUART_IntClear(usart_interface, LEUART_IF_RXDATAV);
   return;
 } /* stzedn_uart_rx_isr() */
 
@@ -139,6 +407,7 @@ void loc_sf_uart_tx_isr(void)
 
   /*! Decrease the number of bytes in Tx-ringbuffer. */
   gi_uart_bufferTxLen--;
+  gs_uart_stats.l_txBytes++;
 
   /*! If the Tx-ringbuffer is empty, disable the Tx-interrupt. */
   if(gi_uart_bufferTxLen == 0U)
@@ -146,7 +415,7 @@ void loc_sf_uart_tx_isr(void)
     return;
   }
   /*! Otherwise write the next byte from Tx-ringbuffer. */
-  LEUART_Tx(usart_interface, *gpc_uart_bufferTxRead++); 
+  LEUART_Tx(usart_interface, *gpc_uart_bufferTxRead++);
 
   /*! Check for an overflow of the write pointer and adjust if required. */
   if(gpc_uart_bufferTxRead == &gc_uart_bufferTx[UART_BUFFER_TX_LEN])
@@ -156,6 +425,7 @@ void loc_sf_uart_tx_isr(void)
 
   return;
 } /* stzedn_uart_tx_isr() */
+#endif /* UART_DMA_ENABLED */
 
 /*==============================================================================
                             FUNCTIONS
@@ -165,30 +435,62 @@ void loc_sf_uart_tx_isr(void)
 /*============================================================================*/
 bool_t wmbus_hal_uart_init(void)
 {
-/*! Init the Rx-buffer variables. */
+  #if (UART_BAUDRATE > UART_LFXO_BAUDRATE_MAX)
+  CMU_ClkDiv_TypeDef l_div;
+  #endif /* UART_BAUDRATE */
+
+  MEMSET(&gs_uart_stats, 0U, sizeof(gs_uart_stats));
+  gb_uart_bufferRxOverflow = FALSE;
+
+  #if UART_DMA_ENABLED
+  /*! Init the Rx-buffer variables. */
+  gl_uart_bufferRxHalfCnt = 0U;
+  gl_uart_bufferRxReadCnt = 0U;
+
+  /*! Init the Tx-buffer variables. */
+  gi_uart_bufferTxWrite = 0U;
+  gi_uart_bufferTxRead = 0U;
+  gi_uart_bufferTxLen = 0U;
+  gi_uart_dmaTxLen = 0U;
+  #else
+  /*! Init the Rx-buffer variables. */
   gpc_uart_bufferRxWrite = gc_uart_bufferRx;
   gpc_uart_bufferRxRead = gc_uart_bufferRx;
   gi_uart_bufferRxLen = 0U;
-  gb_uart_bufferRxOverflow = FALSE;
 
   /*! Init the Tx-buffer variables. */
   gpc_uart_bufferTxWrite = gc_uart_bufferTx;
   gpc_uart_bufferTxRead = gc_uart_bufferTx;
   gi_uart_bufferTxLen = 0U;
+  #endif /* UART_DMA_ENABLED */
 
   /* enable clock system */
   CMU_ClockEnable(cmuClock_HFPER, true);
-  /* Enable clock for core */
-  CMU->HFCORECLKEN0 = CMU_HFCORECLKEN0_LE;
+  /* Enable clock for core. Other clocks, e.g. the one of the DMA, must not
+     be disabled. */
+  CMU_ClockEnable(cmuClock_CORELE, true);
   /* Enable clock for Peripherals */
-  CMU->HFPERCLKEN0 = CMU_HFPERCLKEN0_GPIO;
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  #if (UART_BAUDRATE > UART_LFXO_BAUDRATE_MAX)
+  /* The LEUART clock is prescaled to keep the clock divider in range. */
+  CMU_ClockSelectSet(cmuClock_LFB, cmuSelect_CORELEDIV2);
+  l_div = cmuClkDiv_1;
+  while((l_div < cmuClkDiv_8) &&
+        ((CMU_ClockFreqGet(cmuClock_LFB) / l_div) >
+         (UART_CLKDIV_RATIO_MAX * UART_BAUDRATE)))
+  {
+    l_div <<= 1U;
+  } /* while */
+  CMU_ClockDivSet(cmuClock_LEUART0, l_div);
+  #else
   CMU_ClockSelectSet(cmuClock_LFB, cmuSelect_LFXO);
   CMU_ClockDivSet(cmuClock_LEUART0 , cmuClkDiv_1);
-  CMU_ClockEnable(cmuClock_LEUART0, true);  
+  #endif /* UART_BAUDRATE */
+  CMU_ClockEnable(cmuClock_LEUART0, true);
 
 
   /* configure pins */
-  GPIO_PinModeSet(UART_USART_PORT, UART_USART_TX_PIN, gpioModePushPull, 1); 
+  GPIO_PinModeSet(UART_USART_PORT, UART_USART_TX_PIN, gpioModePushPull, 1);
   GPIO_PinModeSet(UART_USART_PORT, UART_USART_RX_PIN, gpioModeInput, 0);
 
   /* Configure USART for basic async operation --> use LEUART */
@@ -199,6 +501,59 @@ bool_t wmbus_hal_uart_init(void)
   /* setup location */
    usart_interface->ROUTE = USART_ROUTE_RXPEN | USART_ROUTE_TXPEN;
 
+  #if UART_DMA_ENABLED
+  /** Configure the DMA channels serving the LEUART */
+  /**@{*/
+  {
+    DMA_CfgChannel_TypeDef s_channel;
+    DMA_CfgDescr_TypeDef s_descr;
+
+    sf_hal_dma_init();
+
+    #if (UART_BAUDRATE <= UART_LFXO_BAUDRATE_MAX)
+    /* Let the DMA requests wake up the device from EM2. */
+    while(usart_interface->SYNCBUSY & LEUART_SYNCBUSY_CTRL);
+    usart_interface->CTRL |= (LEUART_CTRL_RXDMAWU | LEUART_CTRL_TXDMAWU);
+    #endif /* UART_BAUDRATE */
+
+    gs_uart_dmaRxCb.cbFunc  = loc_uart_dmaRxDone;
+    gs_uart_dmaRxCb.userPtr = NULL;
+    gs_uart_dmaRxCb.primary = 0U;
+
+    s_channel.highPri   = false;
+    s_channel.enableInt = true;
+    s_channel.select    = UART_USART_DMAREQ_RX;
+    s_channel.cb        = &gs_uart_dmaRxCb;
+    DMA_CfgChannel(SF_HAL_DMA_CH_UART_RX, &s_channel);
+
+    gs_uart_dmaTxCb.cbFunc  = loc_uart_dmaTxDone;
+    gs_uart_dmaTxCb.userPtr = NULL;
+    gs_uart_dmaTxCb.primary = 0U;
+
+    s_channel.highPri   = false;
+    s_channel.enableInt = true;
+    s_channel.select    = UART_USART_DMAREQ_TX;
+    s_channel.cb        = &gs_uart_dmaTxCb;
+    DMA_CfgChannel(SF_HAL_DMA_CH_UART_TX, &s_channel);
+
+    s_descr.size    = dmaDataSize1;
+    s_descr.arbRate = dmaArbitrate1;
+    s_descr.hprot   = 0U;
+
+    s_descr.dstInc  = dmaDataInc1;
+    s_descr.srcInc  = dmaDataIncNone;
+    DMA_CfgDescr(SF_HAL_DMA_CH_UART_RX, true, &s_descr);
+    DMA_CfgDescr(SF_HAL_DMA_CH_UART_RX, false, &s_descr);
+
+    s_descr.dstInc  = dmaDataIncNone;
+    s_descr.srcInc  = dmaDataInc1;
+    DMA_CfgDescr(SF_HAL_DMA_CH_UART_TX, true, &s_descr);
+
+    /* Receive continuously, the Tx channel is started on demand. */
+    loc_uart_dmaRxStart();
+  }
+  /**@}*/
+  #else
   /* Clear previous RX interrupts */
   LEUART_IntClear(usart_interface, LEUART_IF_RXDATAV);
   NVIC_ClearPendingIRQ(LEUART0_IRQn);
@@ -209,6 +564,7 @@ bool_t wmbus_hal_uart_init(void)
   LEUART_IntEnable(usart_interface, LEUART_IF_TXC);
 
   NVIC_EnableIRQ(LEUART0_IRQn);
+  #endif /* UART_DMA_ENABLED */
 
   /* Finally enable LEUART */
   LEUART_Enable(usart_interface, leuartEnable);
@@ -223,12 +579,49 @@ bool_t wmbus_hal_uart_init(void)
 uint16_t wmbus_hal_uart_write(uint8_t *pc_data, uint16_t i_len)
 {
   uint16_t i;
+  #if UART_DMA_ENABLED
+  uint16_t i_free;
+
+  /*! The bytes exceeding the free space are rejected. */
+  i_free = (UART_BUFFER_TX_LEN - gi_uart_bufferTxLen);
+  if(i_len > i_free)
+  {
+    gs_uart_stats.l_txRejected += (i_len - i_free);
+    i_len = i_free;
+  } /* if */
+
+  /*! Only the Tx callback changes the read position, the write position
+      belongs to this function. */
+  for(i = 0U; i < i_len; i++)
+  {
+    gc_uart_bufferTx[gi_uart_bufferTxWrite++] = pc_data[i];
+    if(gi_uart_bufferTxWrite == UART_BUFFER_TX_LEN)
+    {
+      gi_uart_bufferTxWrite = 0U;
+    } /* if */
+  } /* for */
+
+  if(i_len > 0U)
+  {
+    __disable_irq();
+    gi_uart_bufferTxLen += i_len;
+    if(gi_uart_dmaTxLen == 0U)
+    {
+      loc_uart_dmaTxStart();
+    } /* if */
+    __enable_irq();
+  } /* if */
+
+  return i_len;
+
+  #else
   bool_t   b_first_write;
 
   #if UART_USE_TX_IRQ
   /*! Verify length-value. */
   if((0U == i_len) || (UART_BUFFER_TX_LEN <= gi_uart_bufferTxLen))
   {
+    gs_uart_stats.l_txRejected += i_len;
     return 0U;
   } /* if */
 
@@ -260,6 +653,7 @@ uint16_t wmbus_hal_uart_write(uint8_t *pc_data, uint16_t i_len)
     } /* if */
 
   } /* for */
+  gs_uart_stats.l_txRejected += (i_len - i);
   /*! Return the number of bytes written until the loop was left. */
 
   /*! If it is the first byte, write it. */
@@ -286,6 +680,7 @@ uint16_t wmbus_hal_uart_write(uint8_t *pc_data, uint16_t i_len)
   } /* for */
   return i_len;
   #endif /* UART_USE_TX_IRQ */
+  #endif /* UART_DMA_ENABLED */
 } /* wmbus_hal_uart_write() */
 
 /*============================================================================*/
@@ -294,6 +689,47 @@ uint16_t wmbus_hal_uart_write(uint8_t *pc_data, uint16_t i_len)
 uint16_t wmbus_hal_uart_read(uint8_t *pc_data, uint16_t i_len)
 {
   uint16_t i;
+  #if UART_DMA_ENABLED
+  uint32_t l_rxCnt;
+  uint32_t l_readCnt;
+  uint16_t i_pos;
+
+  l_rxCnt = loc_uart_dmaRxCnt();
+
+  /*! Bytes overwritten by the DMA before being read are skipped. */
+  if((l_rxCnt - gl_uart_bufferRxReadCnt) > UART_BUFFER_RX_LEN)
+  {
+    gb_uart_bufferRxOverflow = TRUE;
+    gs_uart_stats.l_rxOverflow++;
+    gs_uart_stats.l_rxLost += ((l_rxCnt - gl_uart_bufferRxReadCnt) -
+                               UART_BUFFER_RX_LEN);
+    gl_uart_bufferRxReadCnt = (l_rxCnt - UART_BUFFER_RX_LEN);
+  } /* if */
+
+  l_readCnt = gl_uart_bufferRxReadCnt;
+  i_pos = (uint16_t)(l_readCnt % UART_BUFFER_RX_LEN);
+
+  /*! Read from Rx-ringbuffer until i_len or all received bytes are read. */
+  for(i = 0U; (i < i_len) && (l_readCnt != l_rxCnt); i++)
+  {
+    pc_data[i] = gc_uart_bufferRx[i_pos++];
+    l_readCnt++;
+    if(i_pos == UART_BUFFER_RX_LEN)
+    {
+      i_pos = 0U;
+    } /* if */
+  } /* for */
+
+  /*! The DMA may have overwritten the bytes while they were copied. */
+  if((loc_uart_dmaRxCnt() - gl_uart_bufferRxReadCnt) > UART_BUFFER_RX_LEN)
+  {
+    gb_uart_bufferRxOverflow = TRUE;
+    gs_uart_stats.l_rxOverflow++;
+  } /* if */
+
+  gl_uart_bufferRxReadCnt = l_readCnt;
+  gs_uart_stats.l_rxBytes += i;
+  #else
 
   /*! Read from Rx-ringbuffer until i_len or UART_BUFFER_RX_LEN is reached. */
   for(i = 0U; (i < i_len) && (0U < gi_uart_bufferRxLen); i++)
@@ -301,15 +737,17 @@ uint16_t wmbus_hal_uart_read(uint8_t *pc_data, uint16_t i_len)
     /*! Write to the specified data pointer and increase the read pointer. */
     pc_data[i] = *gpc_uart_bufferRxRead++;
     /*! Decrease the number of bytes in ringbuffer. */
+    usart_interface->IEN &= ~LEUART_IEN_RXDATAV;
     gi_uart_bufferRxLen--;
+    usart_interface->IEN |= LEUART_IEN_RXDATAV;
     /*! Check for an overflow of the read pointer and adjust if required. */
     if(gpc_uart_bufferRxRead == &gc_uart_bufferRx[UART_BUFFER_RX_LEN])
     {
       gpc_uart_bufferRxRead = gc_uart_bufferRx;
     } /* if */
-    /*! (Re-)Enable the Rx-interrupt. */
-    usart_interface->IEN |= LEUART_IEN_RXDATAV;
   }
+  gs_uart_stats.l_rxBytes += i;
+  #endif /* UART_DMA_ENABLED */
   return i;
 } /* wmbus_hal_uart_read() */
 
@@ -318,7 +756,20 @@ uint16_t wmbus_hal_uart_read(uint8_t *pc_data, uint16_t i_len)
 /*============================================================================*/
 uint16_t wmbus_hal_uart_cntRxBytes(void)
 {
+  #if UART_DMA_ENABLED
+  uint32_t l_cnt;
+
+  l_cnt = (loc_uart_dmaRxCnt() - gl_uart_bufferRxReadCnt);
+  if(l_cnt > UART_BUFFER_RX_LEN)
+  {
+    /* The overflow is handled by the next read. */
+    l_cnt = UART_BUFFER_RX_LEN;
+  } /* if */
+
+  return (uint16_t) l_cnt;
+  #else
   return gi_uart_bufferRxLen;
+  #endif /* UART_DMA_ENABLED */
 } /* wmbus_hal_uart_cntRxBytes() */
 
 /*============================================================================*/
@@ -340,6 +791,29 @@ bool_t wmbus_hal_uart_isRxOverflow(void)
   return b_return;
 } /* wmbus_hal_uart_isRxOverflow() */
 
+/*============================================================================*/
+/* sf_hal_leuart_getStats() */
+/*============================================================================*/
+void sf_hal_leuart_getStats(s_sf_hal_leuart_stats_t* ps_stats)
+{
+  if(ps_stats != NULL)
+  {
+    __disable_irq();
+    *ps_stats = gs_uart_stats;
+    __enable_irq();
+  } /* if */
+} /* sf_hal_leuart_getStats() */
+
+/*============================================================================*/
+/* sf_hal_leuart_resetStats() */
+/*============================================================================*/
+void sf_hal_leuart_resetStats(void)
+{
+  __disable_irq();
+  MEMSET(&gs_uart_stats, 0U, sizeof(gs_uart_stats));
+  __enable_irq();
+} /* sf_hal_leuart_resetStats() */
+
 /*============================================================================*/
 /* wmbus_hal_uart_com_TxFinish() */
 /*============================================================================*/
@@ -383,6 +857,7 @@ void wmbus_hal_uart_com_run(void)
                             INTERRUPTHANDLER
 ==============================================================================*/
 
+#if (UART_DMA_ENABLED == FALSE)
 /*========================= LEUART0 RX/TX ISR ================================*/
 void LEUART0_IRQHandler(void)
 {
@@ -399,6 +874,7 @@ void LEUART0_IRQHandler(void)
       loc_sf_uart_rx_isr();
     }
 }
+#endif /* UART_DMA_ENABLED */
 
 /**@}*/
 #ifdef __cplusplus
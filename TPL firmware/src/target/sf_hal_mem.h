@@ -0,0 +1,132 @@
+#ifndef __SF_HAL_MEM_H__
+#define __SF_HAL_MEM_H__
+
+/**
+  @file       sf_hal_mem.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Target specific extensions of the non-volatile memory HAL.
+
+  @addtogroup WMBUS_HAL_MEM
+
+  wmbus_hal_mem_write() updates a RAM mirror of the non-volatile memory only.
+  The flash is written in the background by sf_hal_mem_process(), which has
+  to be called periodically, e.g. from the main loop of the application.
+
+  The CPU stalls while a flash page is erased, the RF interrupt handlers
+  included, for longer than the FIFO of the radio lasts. Erases done in the
+  background are therefore started only while the radio neither receives
+  nor transmits, see sf_hal_mem_eraseAllowed(). Other flash users, e.g. the
+  meter table, erase through sf_hal_mem_erasePage() to share this.
+*/
+/**@{*/
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+#ifndef MEM_LOG_PAGES
+/*! Number of flash pages at the end of the flash used for the non-volatile
+    memory. The wear is spread over all of these pages. At least two pages
+    are required, as a new base page is written before the old pages are
+    erased. */
+#define MEM_LOG_PAGES             (2U)
+#endif /* MEM_LOG_PAGES */
+
+/*==============================================================================
+                            TYPEDEFS
+==============================================================================*/
+/**
+  @brief  Callback notifying that all the data has been written to the flash.
+  @param  b_success   @c FALSE if any of the flash operations failed.
+*/
+typedef void (*fp_sf_hal_mem_done_t)(bool_t b_success);
+
+/**
+  @brief  Callback writing further data to the flash before a reset, e.g.
+          data the application collects in RAM.
+  @return Returns @c FALSE if any of the flash operations failed.
+*/
+typedef bool_t (*fp_sf_hal_mem_reset_t)(void);
+
+/*! Statistics of the flash erases. */
+typedef struct S_SF_HAL_MEM_STATS_T
+{
+  /*! Number of pages erased. */
+  uint32_t l_erases;
+  /*! Number of erases deferred as the radio was busy. An erase retried
+      until the radio is idle again counts once. */
+  uint32_t l_deferred;
+  /*! Number of erases the radio got busy during, i.e. telegrams possibly
+      lost by an overflow of the FIFO. */
+  uint32_t l_radioStalls;
+
+} s_sf_hal_mem_stats_t;
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/**
+  @brief  Performs the background processing of the non-volatile memory.
+          Each call performs a single flash operation at most, i.e. writing
+          a record or erasing a page. The interrupts are not disabled.
+  @return Returns @c TRUE as long as there is data left to be written.
+*/
+bool_t sf_hal_mem_process(void);
+
+/**
+  @brief  Writes all pending data to the flash before returning.
+          Should be called before a reset or entering a low power mode
+          without RAM retention.
+  @return Returns @c FALSE if any of the flash operations failed.
+*/
+bool_t sf_hal_mem_flush(void);
+
+/**
+  @brief  Checks for pending data.
+  @return Returns @c TRUE if there is data not yet written to the flash.
+*/
+bool_t sf_hal_mem_isBusy(void);
+
+/**
+  @brief  Registers the callback called when all the data has been written.
+  @param  fp_done     Callback function, NULL to disable it.
+*/
+void sf_hal_mem_setCallback(fp_sf_hal_mem_done_t fp_done);
+
+/**
+  @brief  Registers the callback called by sf_hal_mem_prepareReset().
+  @param  fp_reset    Callback function, NULL to disable it.
+*/
+void sf_hal_mem_setResetCallback(fp_sf_hal_mem_reset_t fp_reset);
+
+/**
+  @brief  Writes all pending data to the flash before a reset, the data of
+          the callback registered by sf_hal_mem_setResetCallback() first.
+          Called by wmbus_hal_mcu_reset().
+  @return Returns @c FALSE if any of the flash operations failed.
+*/
+bool_t sf_hal_mem_prepareReset(void);
+
+/**
+  @brief  Checks if a page may be erased in the background now.
+  @return Returns @c FALSE while the radio is busy, the erase has to be
+          tried again later on.
+*/
+bool_t sf_hal_mem_eraseAllowed(void);
+
+/**
+  @brief  Erases a flash page, unless all of its words are erased already.
+  @param  pl_page     Start address of the page.
+  @return Returns @c TRUE if the page is erased.
+*/
+bool_t sf_hal_mem_erasePage(uint32_t *pl_page);
+
+/**
+  @brief  Returns the statistics of the flash erases.
+  @param  ps_stats    Pointer where to store the statistics.
+*/
+void sf_hal_mem_getStats(s_sf_hal_mem_stats_t* ps_stats);
+
+/**@}*/
+#endif /* __SF_HAL_MEM_H__ */
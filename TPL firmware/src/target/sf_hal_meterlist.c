@@ -0,0 +1,735 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  @file       sf_hal_meterlist.c
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Persistent meter table for large meter lists.
+
+  @addtogroup WMBUS_HAL_MEM
+
+  All these functions are implemented in `/src/target/`sf_hal_meterlist.c
+
+  The table is an append-only log spread over METERLIST_PAGES flash pages,
+  which are used as a ring. Each change of a meter appends a record holding
+  the id and the complete entry of the meter. Removing a meter appends a
+  record without an entry. The latest record of a meter is the valid one.
+
+  Layout of a page:
+  - Page header: magic and sequence number.
+  - Records: header (id, length and check byte), entry padded to a multiple
+    of words and a commit marker.
+
+  The commit marker of a record is written last. Records without a commit
+  marker, e.g. due to a power failure, are ignored on startup.
+
+  Before the ring runs out of erased pages, the oldest page is collected:
+  the records still valid are appended again and the page is erased. One
+  erased page is reserved for collecting, so the table holds at most the
+  records of METERLIST_PAGES - 3 pages. The magic of a page is cleared
+  before erasing it, thus an interrupted erase does not bring back removed
+  meters.
+*/
+/**@{*/
+
+
+/*==============================================================================
+                            INCLUDE FILES
+==============================================================================*/
+#include "inc\pub\utils\wmbus_typedefs.h"
+#include "inc\pub\utils\wmbus_tlg_api.h"
+#include "sf_hal_mem.h"
+#include "sf_hal_meterlist.h"
+
+#include "em_device.h"
+#include "em_msc.h"
+
+#if METERLIST_ENABLED
+
+/*! In case flash access fails, the driver retries it. */
+#define METERLIST_FLASH_WRITE_RETRIES (3U)
+
+#ifndef METERLIST_MAX_METERS
+/*! Maximum number of meters in the table. */
+#define METERLIST_MAX_METERS          (100U)
+#endif /* METERLIST_MAX_METERS */
+
+#ifndef METERLIST_START_ADDR
+/*! Start address of the table, directly below the pages of the
+    non-volatile memory. */
+#define METERLIST_START_ADDR          (FLASH_SIZE - ((MEM_LOG_PAGES + \
+                                       METERLIST_PAGES) * FLASH_PAGE_SIZE))
+#endif /* METERLIST_START_ADDR */
+
+/*! Start address of a page of the table. */
+#define METERLIST_PAGE_ADDR(x)  (METERLIST_START_ADDR + \
+                                 ((uint32_t)(x) * FLASH_PAGE_SIZE))
+
+/*! Content of an erased flash word. */
+#define METERLIST_ERASED              (0xFFFFFFFFU)
+/*! Marks a page as used by the table. */
+#define METERLIST_PAGE_MAGIC          (0x5254454DU)
+/*! Marks a page as obsolete before erasing it. */
+#define METERLIST_PAGE_OBSOLETE       (0x00000000U)
+/*! Marker written after the entry of a record. */
+#define METERLIST_RECORD_COMMIT       (0x544D4D43U)
+
+/*! Word index of the magic within the page header. */
+#define METERLIST_HDR_MAGIC           (0U)
+/*! Word index of the sequence number within the page header. */
+#define METERLIST_HDR_SEQ             (1U)
+/*! Length of the page header in bytes. */
+#define METERLIST_HDR_LEN             (8U)
+
+/*! Number of words of a record carrying c_len bytes, including the record
+    header and the commit marker. */
+#define METERLIST_RECORD_WORDS(c_len) (2U + (((c_len) + 3U) / 4U))
+/*! Length of a record carrying an entry in bytes. */
+#define METERLIST_RECORD_LEN          (METERLIST_RECORD_WORDS( \
+                                       METERLIST_ENTRY_LEN) * 4U)
+/*! Number of records carrying an entry fitting into a page. */
+#define METERLIST_RECORDS_PER_PAGE    ((FLASH_PAGE_SIZE - METERLIST_HDR_LEN) \
+                                       / METERLIST_RECORD_LEN)
+
+/*! Location of an id not in use. */
+#define METERLIST_LOC_NONE            (0xFFFFU)
+
+/*! Checks the number of erased pages, i.e. pages not in use. */
+#define METERLIST_PAGES_FREE()        (METERLIST_PAGES - gs_meterlist.c_used)
+
+#if (METERLIST_PAGES < 4U)
+  #error At least four pages are required for the meter table.
+#endif
+
+#if (METERLIST_MAX_METERS > ((METERLIST_PAGES - 3U) * \
+                             METERLIST_RECORDS_PER_PAGE))
+  #error METERLIST_MAX_METERS does not fit into METERLIST_PAGES.
+#endif
+
+#if (((METERLIST_PAGES * FLASH_PAGE_SIZE) / 4U) >= METERLIST_LOC_NONE)
+  #error METERLIST_PAGES exceeds the range of the record locations.
+#endif
+
+#if (METERLIST_ENTRY_LEN < 8U) || (METERLIST_ENTRY_LEN > 255U)
+  #error METERLIST_ENTRY_LEN has to hold the address of the meter.
+#endif
+
+/*==============================================================================
+                            TYPEDEF STRUCTS
+==============================================================================*/
+/*! State of the table. */
+typedef struct S_METERLIST_T
+{
+  /*! Oldest page in use. */
+  uint8_t c_tail;
+  /*! Page the records are currently appended to. */
+  uint8_t c_head;
+  /*! Number of pages in use, from the tail to the head. */
+  uint8_t c_used;
+  /*! Sequence number of the head page. */
+  uint32_t l_seq;
+  /*! Offset within the head page where to append the next record. */
+  uint16_t i_pos;
+  /*! Offset within the tail page of the next record to be collected. */
+  uint16_t i_collect;
+  /*! Number of meters in the table. */
+  uint16_t i_num;
+  /*! Statistics of the table. */
+  s_sf_hal_meterlist_stats_t s_stats;
+
+} s_meterlist_t;
+
+/*==============================================================================
+                            LOCAL VARIABLES
+==============================================================================*/
+/*! State of the table. */
+static s_meterlist_t gs_meterlist;
+
+/*! Location of the latest record of each meter, as word offset from
+    METERLIST_START_ADDR. */
+static uint16_t gai_meterlist_loc[METERLIST_MAX_METERS];
+
+/*! Buffer to assemble a record, word aligned as required by the MSC. */
+static uint32_t gal_meterlist_record[METERLIST_RECORD_WORDS(
+                                      METERLIST_ENTRY_LEN)];
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/**
+  @brief  Writes data into the flash.
+  @param  l_addr      Word aligned address within flash where to write data.
+  @param  pl_data     Pointer to the data to be written into flash.
+  @param  i_len       Number of bytes to write, a multiple of four.
+  @return Returns @c TRUE if the data has been written.
+*/
+/*============================================================================*/
+static bool_t loc_meterlist_flashWrite(uint32_t l_addr,
+                                       const uint32_t *pl_data, uint16_t i_len)
+{
+  uint8_t c_retry_count = 0U;
+  msc_Return_TypeDef msc_ret = mscReturnUnaligned;
+
+  while((c_retry_count < METERLIST_FLASH_WRITE_RETRIES) &&
+        (msc_ret != mscReturnOk))
+  {
+    MSC_Init();
+    msc_ret = MSC_WriteWord((uint32_t *) l_addr, (void const *) pl_data, i_len);
+    MSC_Deinit();
+    c_retry_count++;
+  } /* while */
+
+  return (bool_t)(msc_ret == mscReturnOk);
+} /* loc_meterlist_flashWrite() */
+
+/*============================================================================*/
+/**
+  @brief  Erases a page of the table, unless it is erased already.
+  @param  c_page      Page of the table to erase.
+  @return Returns @c TRUE if the page has been erased.
+*/
+/*============================================================================*/
+static bool_t loc_meterlist_flashErase(uint8_t c_page)
+{
+  uint32_t *pl_page = (uint32_t *) METERLIST_PAGE_ADDR(c_page);
+  uint16_t i;
+
+  for(i = 0U; (i < (FLASH_PAGE_SIZE / 4U)) &&
+              (pl_page[i] == METERLIST_ERASED); i++)
+  {
+  } /* for */
+  if(i < (FLASH_PAGE_SIZE / 4U))
+  {
+    gs_meterlist.s_stats.l_erases++;
+  } /* if */
+
+  /* Skips the erase if the page is erased already. */
+  return sf_hal_mem_erasePage(pl_page);
+} /* loc_meterlist_flashErase() */
+
+/*============================================================================*/
+/**
+  @brief  Checks a record header.
+  @param  l_hdr       Record header as read from the flash.
+  @param  pi_meterId  Returns the id of the meter.
+  @param  pc_len      Returns the length of the entry, 0 if removed.
+  @return Returns @c TRUE if the header is valid.
+*/
+/*============================================================================*/
+static bool_t loc_meterlist_recordHdrParse(uint32_t l_hdr,
+                                           uint16_t *pi_meterId,
+                                           uint8_t *pc_len)
+{
+  uint16_t i_id = (uint16_t)(l_hdr & 0xFFFFU);
+  uint8_t c_len = (uint8_t)((l_hdr >> 16U) & 0xFFU);
+  uint8_t c_chk = (uint8_t)((l_hdr >> 24U) & 0xFFU);
+
+  *pi_meterId = i_id;
+  *pc_len = c_len;
+
+  return (bool_t)((c_chk == (uint8_t)~(i_id ^ (i_id >> 8U) ^ c_len)) &&
+                  (i_id < METERLIST_MAX_METERS) &&
+                  ((c_len == 0U) || (c_len == METERLIST_ENTRY_LEN)));
+} /* loc_meterlist_recordHdrParse() */
+
+/*============================================================================*/
+/**
+  @brief  Parses the item at an offset of a page. Besides the records, a page
+          may hold words left erased or written partially due to a power
+          failure, which are skipped word by word.
+  @param  pl_page     Page of the table.
+  @param  i_pos       Offset of the item within the page.
+  @param  pi_meterId  Returns the id of the meter of a record.
+  @param  pc_len      Returns the length of the entry of a record.
+  @param  pi_next     Returns the offset behind the item.
+  @return Returns @c TRUE if the item is a committed record.
+*/
+/*============================================================================*/
+static bool_t loc_meterlist_recordParse(const uint32_t *pl_page,
+                                        uint16_t i_pos, uint16_t *pi_meterId,
+                                        uint8_t *pc_len, uint16_t *pi_next)
+{
+  uint16_t i_words;
+
+  *pi_next = i_pos + 4U;
+
+  if((pl_page[i_pos / 4U] == METERLIST_ERASED) ||
+     (loc_meterlist_recordHdrParse(pl_page[i_pos / 4U], pi_meterId, pc_len)
+      == FALSE))
+  {
+    return FALSE;
+  } /* if */
+
+  i_words = METERLIST_RECORD_WORDS(*pc_len);
+  if((i_pos + (i_words * 4U)) > FLASH_PAGE_SIZE)
+  {
+    return FALSE;
+  } /* if */
+
+  *pi_next = i_pos + (i_words * 4U);
+
+  return (bool_t)(pl_page[(i_pos / 4U) + i_words - 1U] ==
+                  METERLIST_RECORD_COMMIT);
+} /* loc_meterlist_recordParse() */
+
+/*============================================================================*/
+/**
+  @brief  Writes the header of a page and makes it the head page.
+          The magic is written last, so a page is taken into account on
+          startup only if its sequence number is complete.
+  @param  c_page      Page of the table, erased if it is not yet.
+  @return Returns @c TRUE if the header has been written.
+*/
+/*============================================================================*/
+static bool_t loc_meterlist_pageOpen(uint8_t c_page)
+{
+  bool_t b_ret;
+  uint32_t l_seq = gs_meterlist.l_seq + 1U;
+  uint32_t l_magic = METERLIST_PAGE_MAGIC;
+
+  /* A former attempt may have left the page written partially. */
+  b_ret = loc_meterlist_flashErase(c_page);
+  if(b_ret)
+  {
+    b_ret = loc_meterlist_flashWrite(METERLIST_PAGE_ADDR(c_page) +
+                                     (METERLIST_HDR_SEQ * 4U), &l_seq, 4U);
+  } /* if */
+  if(b_ret)
+  {
+    b_ret = loc_meterlist_flashWrite(METERLIST_PAGE_ADDR(c_page) +
+                                     (METERLIST_HDR_MAGIC * 4U), &l_magic, 4U);
+  } /* if */
+
+  if(b_ret)
+  {
+    gs_meterlist.c_head = c_page;
+    gs_meterlist.l_seq = l_seq;
+    gs_meterlist.i_pos = METERLIST_HDR_LEN;
+    gs_meterlist.c_used++;
+  } /* if */
+
+  return b_ret;
+} /* loc_meterlist_pageOpen() */
+
+/*============================================================================*/
+/**
+  @brief  Appends a record to the head page, continuing on the next page if
+          it does not fit anymore.
+  @param  i_meterId   Id of the meter.
+  @param  pc_entry    Entry of the meter, NULL to remove the meter.
+  @return Returns @c TRUE if the record has been written.
+*/
+/*============================================================================*/
+static bool_t loc_meterlist_recordWrite(uint16_t i_meterId,
+                                        const uint8_t *pc_entry)
+{
+  bool_t b_ret = TRUE;
+  uint8_t c_len = (pc_entry == NULL) ? 0U : METERLIST_ENTRY_LEN;
+  uint16_t i_words = METERLIST_RECORD_WORDS(c_len);
+  uint32_t l_commit = METERLIST_RECORD_COMMIT;
+  uint32_t l_addr;
+
+  if((gs_meterlist.i_pos + (i_words * 4U)) > FLASH_PAGE_SIZE)
+  {
+    if(METERLIST_PAGES_FREE() == 0U)
+    {
+      return FALSE;
+    } /* if */
+    b_ret = loc_meterlist_pageOpen(
+              (uint8_t)((gs_meterlist.c_head + 1U) % METERLIST_PAGES));
+  } /* if */
+
+  if(b_ret)
+  {
+    /* Assemble header and entry, the padding is left erased. */
+    MEMSET(gal_meterlist_record, 0xFFU, sizeof(gal_meterlist_record));
+    gal_meterlist_record[0] = (uint32_t)i_meterId | ((uint32_t)c_len << 16U) |
+       ((uint32_t)(uint8_t)~(i_meterId ^ (i_meterId >> 8U) ^ c_len) << 24U);
+    if(c_len > 0U)
+    {
+      MEMCPY(&gal_meterlist_record[1], pc_entry, c_len);
+    } /* if */
+
+    l_addr = METERLIST_PAGE_ADDR(gs_meterlist.c_head) + gs_meterlist.i_pos;
+    b_ret = loc_meterlist_flashWrite(l_addr, gal_meterlist_record,
+                                     (i_words - 1U) * 4U);
+    if(b_ret)
+    {
+      b_ret = loc_meterlist_flashWrite(l_addr + ((i_words - 1U) * 4U),
+                                       &l_commit, 4U);
+    } /* if */
+
+    if(b_ret)
+    {
+      gai_meterlist_loc[i_meterId] = (c_len == 0U) ? METERLIST_LOC_NONE :
+        (uint16_t)(((gs_meterlist.c_head * FLASH_PAGE_SIZE) +
+                    gs_meterlist.i_pos) / 4U);
+      gs_meterlist.s_stats.l_records++;
+    } /* if */
+
+    /* The space is consumed even in case of an error. */
+    gs_meterlist.i_pos += i_words * 4U;
+  } /* if */
+
+  return b_ret;
+} /* loc_meterlist_recordWrite() */
+
+/*============================================================================*/
+/**
+  @brief  Performs a single step of collecting the tail page.
+          Moves the next valid record of the tail page to the head page. As
+          soon as there is none left, the tail page is erased.
+  @return Returns @c TRUE if the step has been performed successfully.
+*/
+/*============================================================================*/
+static bool_t loc_meterlist_collectStep(void)
+{
+  const uint32_t *pl_page =
+    (const uint32_t *) METERLIST_PAGE_ADDR(gs_meterlist.c_tail);
+  uint32_t l_obsolete = METERLIST_PAGE_OBSOLETE;
+  uint16_t i_loc;
+  uint16_t i_next;
+  uint16_t i_id;
+  uint8_t c_len;
+  bool_t b_ret;
+
+  while((gs_meterlist.i_collect + 4U) <= FLASH_PAGE_SIZE)
+  {
+    b_ret = loc_meterlist_recordParse(pl_page, gs_meterlist.i_collect,
+                                      &i_id, &c_len, &i_next);
+    i_loc = (uint16_t)(((gs_meterlist.c_tail * FLASH_PAGE_SIZE) +
+                        gs_meterlist.i_collect) / 4U);
+
+    /* Records removing a meter are dropped, the older records of the meter
+       have been erased already. */
+    if(b_ret && (c_len > 0U) && (gai_meterlist_loc[i_id] == i_loc))
+    {
+      b_ret = loc_meterlist_recordWrite(i_id, (const uint8_t *)
+                &pl_page[(gs_meterlist.i_collect / 4U) + 1U]);
+      if(b_ret)
+      {
+        /* Otherwise the record is moved again by the next step. */
+        gs_meterlist.i_collect = i_next;
+        gs_meterlist.s_stats.l_moved++;
+      } /* if */
+      return b_ret;
+    } /* if */
+
+    gs_meterlist.i_collect = i_next;
+  } /* while */
+
+  /* Nothing valid is left in the tail page. */
+  loc_meterlist_flashWrite(METERLIST_PAGE_ADDR(gs_meterlist.c_tail) +
+                           (METERLIST_HDR_MAGIC * 4U), &l_obsolete, 4U);
+  b_ret = loc_meterlist_flashErase(gs_meterlist.c_tail);
+  if(b_ret)
+  {
+    gs_meterlist.c_tail =
+      (uint8_t)((gs_meterlist.c_tail + 1U) % METERLIST_PAGES);
+    gs_meterlist.c_used--;
+    gs_meterlist.i_collect = METERLIST_HDR_LEN;
+  } /* if */
+
+  return b_ret;
+} /* loc_meterlist_collectStep() */
+
+/*============================================================================*/
+/**
+  @brief  Writes a record of a meter. Collects pages first if the record
+          would require the page reserved for collecting.
+  @param  i_meterId   Id of the meter.
+  @param  pc_entry    Entry of the meter, NULL to remove the meter.
+  @return Returns @c TRUE if the record has been written.
+*/
+/*============================================================================*/
+static bool_t loc_meterlist_write(uint16_t i_meterId, const uint8_t *pc_entry)
+{
+  /* Bounds the collecting in case of flash errors. */
+  uint16_t i_steps = (METERLIST_RECORDS_PER_PAGE + 1U) * METERLIST_PAGES;
+
+  /* While records are moved into the page reserved for collecting, the
+     tail page is finished first. Its remaining records fit into that
+     page. */
+  while((METERLIST_PAGES_FREE() == 0U) ||
+        (((gs_meterlist.i_pos + METERLIST_RECORD_LEN) > FLASH_PAGE_SIZE) &&
+         (METERLIST_PAGES_FREE() < 2U)))
+  {
+    if((i_steps == 0U) || (loc_meterlist_collectStep() == FALSE))
+    {
+      return FALSE;
+    } /* if */
+    i_steps--;
+  } /* while */
+
+  return loc_meterlist_recordWrite(i_meterId, pc_entry);
+} /* loc_meterlist_write() */
+
+/*============================================================================*/
+/**
+  @brief  Replays the records of a page into the locations.
+  @param  c_page      Page of the table.
+  @return Offset within the page behind the last item written.
+*/
+/*============================================================================*/
+static uint16_t loc_meterlist_pageReplay(uint8_t c_page)
+{
+  const uint32_t *pl_page = (const uint32_t *) METERLIST_PAGE_ADDR(c_page);
+  uint16_t i_pos = METERLIST_HDR_LEN;
+  uint16_t i_end = METERLIST_HDR_LEN;
+  uint16_t i_next;
+  uint16_t i_id;
+  uint8_t c_len;
+
+  while((i_pos + 4U) <= FLASH_PAGE_SIZE)
+  {
+    if(loc_meterlist_recordParse(pl_page, i_pos, &i_id, &c_len, &i_next))
+    {
+      gai_meterlist_loc[i_id] = (c_len == 0U) ? METERLIST_LOC_NONE :
+        (uint16_t)(((c_page * FLASH_PAGE_SIZE) + i_pos) / 4U);
+    } /* if */
+
+    /* New records are appended behind anything written, e.g. a record
+       interrupted by a power failure. */
+    if(pl_page[i_pos / 4U] != METERLIST_ERASED)
+    {
+      i_end = i_next;
+    } /* if */
+    i_pos = i_next;
+  } /* while */
+
+  return i_end;
+} /* loc_meterlist_pageReplay() */
+
+/*==============================================================================
+                            FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/* sf_hal_meterlist_init() */
+/*============================================================================*/
+bool_t sf_hal_meterlist_init(void)
+{
+  bool_t b_ret = TRUE;
+  bool_t b_found = FALSE;
+  uint8_t c_page;
+  uint8_t i;
+  uint16_t i_id;
+  const uint32_t *pl_page;
+
+  MEMSET(gai_meterlist_loc, 0xFFU, sizeof(gai_meterlist_loc));
+  MEMSET(&gs_meterlist, 0U, sizeof(gs_meterlist));
+  gs_meterlist.i_collect = METERLIST_HDR_LEN;
+
+  /* Find the oldest page in use. */
+  for(i = 0U; i < METERLIST_PAGES; i++)
+  {
+    pl_page = (const uint32_t *) METERLIST_PAGE_ADDR(i);
+    if((pl_page[METERLIST_HDR_MAGIC] == METERLIST_PAGE_MAGIC) &&
+       ((b_found == FALSE) ||
+        ((int32_t)(pl_page[METERLIST_HDR_SEQ] - gs_meterlist.l_seq) < 0)))
+    {
+      b_found = TRUE;
+      gs_meterlist.c_tail = i;
+      gs_meterlist.l_seq = pl_page[METERLIST_HDR_SEQ];
+    } /* if */
+  } /* for */
+
+  if(b_found)
+  {
+    /* Replay the tail page and all the pages continuing it. */
+    gs_meterlist.c_head = gs_meterlist.c_tail;
+    gs_meterlist.i_pos = loc_meterlist_pageReplay(gs_meterlist.c_tail);
+    gs_meterlist.c_used = 1U;
+
+    for(i = 1U; i < METERLIST_PAGES; i++)
+    {
+      c_page = (uint8_t)((gs_meterlist.c_tail + i) % METERLIST_PAGES);
+      pl_page = (const uint32_t *) METERLIST_PAGE_ADDR(c_page);
+      if((pl_page[METERLIST_HDR_MAGIC] == METERLIST_PAGE_MAGIC) &&
+         (pl_page[METERLIST_HDR_SEQ] == (gs_meterlist.l_seq + 1U)))
+      {
+        gs_meterlist.c_head = c_page;
+        gs_meterlist.l_seq++;
+        gs_meterlist.i_pos = loc_meterlist_pageReplay(c_page);
+        gs_meterlist.c_used++;
+      }
+      else
+      {
+        break;
+      } /* if ... else */
+    } /* for */
+
+    /* Pages not belonging to the chain are obsolete, e.g. an interrupted
+       erase. */
+    for(i = gs_meterlist.c_used; (i < METERLIST_PAGES) && b_ret; i++)
+    {
+      b_ret = loc_meterlist_flashErase(
+                (uint8_t)((gs_meterlist.c_tail + i) % METERLIST_PAGES));
+    } /* for */
+  }
+  else
+  {
+    for(i = 0U; (i < METERLIST_PAGES) && b_ret; i++)
+    {
+      b_ret = loc_meterlist_flashErase(i);
+    } /* for */
+    if(b_ret)
+    {
+      b_ret = loc_meterlist_pageOpen(0U);
+    } /* if */
+  } /* if ... else */
+
+  for(i_id = 0U; i_id < METERLIST_MAX_METERS; i_id++)
+  {
+    if(gai_meterlist_loc[i_id] != METERLIST_LOC_NONE)
+    {
+      gs_meterlist.i_num++;
+    } /* if */
+  } /* for */
+
+  return b_ret;
+} /* sf_hal_meterlist_init() */
+
+/*============================================================================*/
+/* sf_hal_meterlist_add() */
+/*============================================================================*/
+uint16_t sf_hal_meterlist_add(uint8_t *pc_entry)
+{
+  uint16_t i_id;
+
+  for(i_id = 0U; i_id < METERLIST_MAX_METERS; i_id++)
+  {
+    if(gai_meterlist_loc[i_id] == METERLIST_LOC_NONE)
+    {
+      return (sf_hal_meterlist_set(i_id, pc_entry) == TRUE) ?
+             i_id : METERLIST_ID_INVALID;
+    } /* if */
+  } /* for */
+
+  return METERLIST_ID_INVALID;
+} /* sf_hal_meterlist_add() */
+
+/*============================================================================*/
+/* sf_hal_meterlist_set() */
+/*============================================================================*/
+bool_t sf_hal_meterlist_set(uint16_t i_meterId, uint8_t *pc_entry)
+{
+  bool_t b_new;
+
+  if((i_meterId >= METERLIST_MAX_METERS) || (pc_entry == NULL))
+  {
+    return FALSE;
+  } /* if */
+
+  b_new = (bool_t)(gai_meterlist_loc[i_meterId] == METERLIST_LOC_NONE);
+  if(loc_meterlist_write(i_meterId, pc_entry) == FALSE)
+  {
+    return FALSE;
+  } /* if */
+
+  if(b_new)
+  {
+    gs_meterlist.i_num++;
+  } /* if */
+
+  return TRUE;
+} /* sf_hal_meterlist_set() */
+
+/*============================================================================*/
+/* sf_hal_meterlist_remove() */
+/*============================================================================*/
+bool_t sf_hal_meterlist_remove(uint16_t i_meterId)
+{
+  if((i_meterId >= METERLIST_MAX_METERS) ||
+     (gai_meterlist_loc[i_meterId] == METERLIST_LOC_NONE) ||
+     (loc_meterlist_write(i_meterId, NULL) == FALSE))
+  {
+    return FALSE;
+  } /* if */
+
+  gs_meterlist.i_num--;
+
+  return TRUE;
+} /* sf_hal_meterlist_remove() */
+
+/*============================================================================*/
+/* sf_hal_meterlist_get() */
+/*============================================================================*/
+bool_t sf_hal_meterlist_get(uint16_t i_meterId, uint8_t *pc_entry)
+{
+  if((i_meterId >= METERLIST_MAX_METERS) || (pc_entry == NULL) ||
+     (gai_meterlist_loc[i_meterId] == METERLIST_LOC_NONE))
+  {
+    return FALSE;
+  } /* if */
+
+  /* The entry follows the record header. */
+  MEMCPY(pc_entry, (const uint8_t *)(METERLIST_START_ADDR +
+         (((uint32_t)gai_meterlist_loc[i_meterId] + 1U) * 4U)),
+         METERLIST_ENTRY_LEN);
+
+  return TRUE;
+} /* sf_hal_meterlist_get() */
+
+/*============================================================================*/
+/* sf_hal_meterlist_getAddr() */
+/*============================================================================*/
+bool_t sf_hal_meterlist_getAddr(uint16_t i_meterId,
+                                s_wmbus_addr_t *ps_meterAddr)
+{
+  if((i_meterId >= METERLIST_MAX_METERS) || (ps_meterAddr == NULL) ||
+     (gai_meterlist_loc[i_meterId] == METERLIST_LOC_NONE))
+  {
+    return FALSE;
+  } /* if */
+
+  MEMCPY(ps_meterAddr, (const uint8_t *)(METERLIST_START_ADDR +
+         (((uint32_t)gai_meterlist_loc[i_meterId] + 1U) * 4U)),
+         sizeof(s_wmbus_addr_t));
+
+  return TRUE;
+} /* sf_hal_meterlist_getAddr() */
+
+/*============================================================================*/
+/* sf_hal_meterlist_getNum() */
+/*============================================================================*/
+uint16_t sf_hal_meterlist_getNum(void)
+{
+  return gs_meterlist.i_num;
+} /* sf_hal_meterlist_getNum() */
+
+/*============================================================================*/
+/* sf_hal_meterlist_process() */
+/*============================================================================*/
+bool_t sf_hal_meterlist_process(void)
+{
+  /* Keep an erased page for new records besides the one reserved for
+     collecting. A step may erase the tail page, thus it waits for the radio
+     to get idle. */
+  if((METERLIST_PAGES_FREE() < 2U) && sf_hal_mem_eraseAllowed())
+  {
+    loc_meterlist_collectStep();
+  } /* if */
+
+  return (bool_t)(METERLIST_PAGES_FREE() < 2U);
+} /* sf_hal_meterlist_process() */
+
+/*============================================================================*/
+/* sf_hal_meterlist_getStats() */
+/*============================================================================*/
+void sf_hal_meterlist_getStats(s_sf_hal_meterlist_stats_t* ps_stats)
+{
+  if(ps_stats != NULL)
+  {
+    *ps_stats = gs_meterlist.s_stats;
+  } /* if */
+} /* sf_hal_meterlist_getStats() */
+
+#endif /* METERLIST_ENABLED */
+
+/**@}*/
+#ifdef __cplusplus
+}
+#endif
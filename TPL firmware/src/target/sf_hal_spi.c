@@ -11,6 +11,11 @@ extern "C" {
 
   The SPI access is implemented in `/src/target/`sf_hal_spi.c.
 
+  The Si446x signals CTS once it has processed a command. The RF driver
+  polls it by sending READ_CMD_BUFF and reading the CTS byte, which may take
+  up to 10 ms. The SPI HAL takes the time from sending a command until CTS
+  is read, see sf_hal_spi_getCtsStats(). A command is the first byte
+  written after selecting the chip.
 */
 /**@{*/
 
@@ -23,12 +28,27 @@ extern "C" {
 
 #include "sf_hal_spi.h"
 #include "sf_rf_hal_mcu.h"
+#include "sf_hal_tmr.h"
 
 /*! EFM32LIB includes */
 #include "em_gpio.h"
 #include "em_cmu.h"
 #include "em_usart.h"
 
+/*==============================================================================
+                            CONFIGURATION
+==============================================================================*/
+#ifndef SPI_DMA_ENABLED
+/*! Use the DMA for the non-blocking transfers instead of one interrupt per
+    byte. */
+#define SPI_DMA_ENABLED                     TRUE
+#endif /* SPI_DMA_ENABLED */
+
+#if SPI_DMA_ENABLED
+#include "em_dma.h"
+#include "sf_hal_dma.h"
+#endif /* SPI_DMA_ENABLED */
+
   
    
 /*==============================================================================
@@ -73,12 +93,31 @@ extern "C" {
 #error: define SPI_USART_LOCATION   
 #endif 
 
+#if SPI_DMA_ENABLED
+#ifndef SPI_USART_DMAREQ_TX
+#error: define SPI_USART_DMAREQ_TX
+#endif
+
+#ifndef SPI_USART_DMAREQ_RX
+#error: define SPI_USART_DMAREQ_RX
+#endif
+#endif /* SPI_DMA_ENABLED */
+
 /*==============================================================================
                             DEFINES
 ==============================================================================*/
 /* Watchdog for the ISR */
 /*! Timeout to prevent blocking errors in retries. */
 #define SPI_ISR_TIMEOUT                        1000U
+
+/*! Command of the Si446x reading the CTS byte. */
+#define SPI_CMD_READ_CMD_BUFF                  0x44U
+/*! Value of the CTS byte if the Si446x is ready for the next command. */
+#define SPI_CTS_READY                          0xFFU
+
+/*! Maximum number of bytes a single DMA descriptor is able to transfer.
+    Longer transfers are chained using the ping-pong descriptors. */
+#define SPI_DMA_CHUNK_LEN                      1024U
                                           
 /*==============================================================================
                             TYPEDEF STRUCTS
@@ -95,6 +134,24 @@ typedef struct S_SPI_RXTX_T
 
 } s_spi_txTx_t;
 
+#if SPI_DMA_ENABLED
+/*! Structure to save the state of a DMA driven transfer. */
+typedef struct S_SPI_DMA_T
+{
+  /*! Start of the next chunk to be written. NULL if dummy bytes are sent. */
+  uint8_t *pc_write;
+  /*! Start of the next chunk to be read. NULL if the data is discarded. */
+  uint8_t *pc_read;
+  /*! Number of bytes not yet assigned to any of the descriptors. */
+  uint16_t i_remaining;
+  /*! Number of descriptors armed but not completed yet. */
+  uint8_t c_pending;
+  /*! Callback to notify on completion. */
+  fp_hal_spi_event fp_done;
+
+} s_spi_dma_t;
+#endif /* SPI_DMA_ENABLED */
+
 /*==============================================================================
                             LOCAL VARIABLES
 ==============================================================================*/
@@ -111,10 +168,335 @@ USART_TypeDef *gps_spi;
 static fp_hal_spi_event gfp_rx = NULL;
 static fp_hal_spi_event gfp_tx = NULL;
 
+#if SPI_DMA_ENABLED
+/*! State of the current DMA transfer. */
+static volatile s_spi_dma_t gs_spi_dma;
+
+/*! Callback structure of the DMA Rx channel. As the Rx channel completes
+    after the last byte has been clocked out and in, it signals the end of
+    both, read and write transfers. */
+static DMA_CB_TypeDef gs_spi_dmaCb;
+
+/*! Source of the dummy bytes written during read transfers. */
+static const uint8_t gc_spi_dmaDummyTx = 0U;
+/*! Sink for the bytes read during write transfers. */
+static volatile uint8_t gc_spi_dmaDummyRx;
+#endif /* SPI_DMA_ENABLED */
+
+#if SF_HAL_SPI_CTS_STATS_NUM
+/*! CTS statistics of the commands sent so far. */
+static s_sf_hal_spi_ctsStats_t gas_spi_ctsStats[SF_HAL_SPI_CTS_STATS_NUM];
+/*! Number of entries of gas_spi_ctsStats used. */
+static uint8_t gc_spi_ctsNum;
+/*! Entry of the command waiting for CTS, NULL if none. */
+static s_sf_hal_spi_ctsStats_t *gps_spi_ctsCmd;
+/*! Time the command waiting for CTS was sent. */
+static uint32_t gl_spi_ctsStart;
+/*! Set by sf_hal_spi_chipSelect(), the next byte written is a command. */
+static bool_t gb_spi_ctsSelect = FALSE;
+/*! Set after READ_CMD_BUFF, the next byte read is the CTS byte. */
+static bool_t gb_spi_ctsPoll = FALSE;
+#endif /* SF_HAL_SPI_CTS_STATS_NUM */
+
 
 /*==============================================================================
                             FUNCTION PROTOTYPES
 ==============================================================================*/
+#if SPI_DMA_ENABLED
+static void loc_spi_dmaConfig(bool_t b_write, bool_t b_read);
+static uint16_t loc_spi_dmaNextChunk(uint8_t **ppc_write, uint8_t **ppc_read);
+static void loc_spi_dmaStart(uint8_t* pc_dataWrite, uint8_t* pc_dataRead,
+                             uint16_t i_len, fp_hal_spi_event fp_done);
+static void loc_spi_dmaDone(unsigned int channel, bool primary, void *user);
+#endif /* SPI_DMA_ENABLED */
+#if SF_HAL_SPI_CTS_STATS_NUM
+static void loc_spi_ctsWrite(uint8_t *pc_dataWrite);
+static void loc_spi_ctsRead(uint8_t *pc_dataRead);
+#endif /* SF_HAL_SPI_CTS_STATS_NUM */
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+#if SF_HAL_SPI_CTS_STATS_NUM
+/*============================================================================*/
+/**
+  @brief  Checks the data written for a command or the polling of CTS.
+          Called before each transfer.
+  @param  pc_dataWrite  Data to be written, NULL for dummy bytes.
+*/
+/*============================================================================*/
+static void loc_spi_ctsWrite(uint8_t *pc_dataWrite)
+{
+  uint8_t c_i;
+
+  if(!gb_spi_ctsSelect)
+  {
+    return;
+  } /* if */
+  gb_spi_ctsSelect = FALSE;
+
+  if(pc_dataWrite == NULL)
+  {
+    return;
+  } /* if */
+
+  if(*pc_dataWrite == SPI_CMD_READ_CMD_BUFF)
+  {
+    gb_spi_ctsPoll = TRUE;
+    return;
+  } /* if */
+
+  for(c_i = 0U; c_i < gc_spi_ctsNum; c_i++)
+  {
+    if(gas_spi_ctsStats[c_i].c_cmd == *pc_dataWrite)
+    {
+      break;
+    } /* if */
+  } /* for */
+
+  if(c_i == gc_spi_ctsNum)
+  {
+    if(c_i == SF_HAL_SPI_CTS_STATS_NUM)
+    {
+      /* No entry left, the command is not taken into account. */
+      gps_spi_ctsCmd = NULL;
+      return;
+    } /* if */
+    gas_spi_ctsStats[c_i].c_cmd = *pc_dataWrite;
+    gc_spi_ctsNum++;
+  } /* if */
+
+  gps_spi_ctsCmd = &gas_spi_ctsStats[c_i];
+  gl_spi_ctsStart = sf_hal_tmr_getTimestamp();
+
+  return;
+} /* loc_spi_ctsWrite() */
+
+/*============================================================================*/
+/**
+  @brief  Checks the data read for the CTS byte of a polling.
+          Called after each transfer.
+  @param  pc_dataRead   Data read, NULL if it was discarded.
+*/
+/*============================================================================*/
+static void loc_spi_ctsRead(uint8_t *pc_dataRead)
+{
+  uint32_t l_time;
+  s_sf_hal_spi_ctsStats_t *ps_stats = gps_spi_ctsCmd;
+
+  if((!gb_spi_ctsPoll) || (pc_dataRead == NULL))
+  {
+    return;
+  } /* if */
+  gb_spi_ctsPoll = FALSE;
+
+  if((*pc_dataRead == SPI_CTS_READY) && (ps_stats != NULL))
+  {
+    l_time = sf_hal_tmr_getTimestamp() - gl_spi_ctsStart;
+    if(l_time > 0xFFFFU)
+    {
+      l_time = 0xFFFFU;
+    } /* if */
+
+    ps_stats->i_count++;
+    ps_stats->l_total += l_time;
+    if((uint16_t)l_time > ps_stats->i_max)
+    {
+      ps_stats->i_max = (uint16_t)l_time;
+    } /* if */
+    gps_spi_ctsCmd = NULL;
+  } /* if */
+
+  return;
+} /* loc_spi_ctsRead() */
+#endif /* SF_HAL_SPI_CTS_STATS_NUM */
+
+#if SPI_DMA_ENABLED
+/*============================================================================*/
+/**
+  @brief  Configures the descriptors of both DMA channels.
+          The increment settings of the descriptors depend on the direction
+          of the transfer, as dummy bytes are neither incremented on the
+          source nor on the sink side.
+  @param  b_write   TRUE if data is written from a buffer.
+  @param  b_read    TRUE if data is read into a buffer.
+*/
+/*============================================================================*/
+static void loc_spi_dmaConfig(bool_t b_write, bool_t b_read)
+{
+  DMA_CfgDescr_TypeDef s_descr;
+
+  s_descr.size    = dmaDataSize1;
+  s_descr.arbRate = dmaArbitrate1;
+  s_descr.hprot   = 0U;
+
+  /* Tx channel: buffer or dummy byte to TXDATA */
+  s_descr.dstInc  = dmaDataIncNone;
+  s_descr.srcInc  = b_write ? dmaDataInc1 : dmaDataIncNone;
+  DMA_CfgDescr(SF_HAL_DMA_CH_SPI_TX, true, &s_descr);
+  DMA_CfgDescr(SF_HAL_DMA_CH_SPI_TX, false, &s_descr);
+
+  /* Rx channel: RXDATA to buffer or dummy byte */
+  s_descr.dstInc  = b_read ? dmaDataInc1 : dmaDataIncNone;
+  s_descr.srcInc  = dmaDataIncNone;
+  DMA_CfgDescr(SF_HAL_DMA_CH_SPI_RX, true, &s_descr);
+  DMA_CfgDescr(SF_HAL_DMA_CH_SPI_RX, false, &s_descr);
+
+  return;
+} /* loc_spi_dmaConfig() */
+
+/*============================================================================*/
+/**
+  @brief  Assigns the next chunk of the current transfer to a descriptor.
+  @param  ppc_write   Returns the source of the chunk for the Tx channel.
+  @param  ppc_read    Returns the sink of the chunk for the Rx channel.
+  @return Number of bytes of the chunk, zero if there is nothing left.
+*/
+/*============================================================================*/
+static uint16_t loc_spi_dmaNextChunk(uint8_t **ppc_write, uint8_t **ppc_read)
+{
+  uint16_t i_chunk = gs_spi_dma.i_remaining;
+
+  if(i_chunk > SPI_DMA_CHUNK_LEN)
+  {
+    i_chunk = SPI_DMA_CHUNK_LEN;
+  } /* if */
+
+  if(gs_spi_dma.pc_write != NULL)
+  {
+    *ppc_write = gs_spi_dma.pc_write;
+    gs_spi_dma.pc_write += i_chunk;
+  }
+  else
+  {
+    *ppc_write = (uint8_t*) &gc_spi_dmaDummyTx;
+  } /* if ... else */
+
+  if(gs_spi_dma.pc_read != NULL)
+  {
+    *ppc_read = gs_spi_dma.pc_read;
+    gs_spi_dma.pc_read += i_chunk;
+  }
+  else
+  {
+    *ppc_read = (uint8_t*) &gc_spi_dmaDummyRx;
+  } /* if ... else */
+
+  gs_spi_dma.i_remaining -= i_chunk;
+
+  return i_chunk;
+} /* loc_spi_dmaNextChunk() */
+
+/*============================================================================*/
+/**
+  @brief  Starts a DMA driven transfer.
+          Transfers fitting into a single descriptor are done using a basic
+          cycle. Longer transfers use ping-pong cycles, where the completed
+          descriptor is refilled by loc_spi_dmaDone() while the other one is
+          active.
+  @param  pc_dataWrite  Data to be written, NULL for dummy bytes.
+  @param  pc_dataRead   Where to store read data, NULL to discard it.
+  @param  i_len         Number of bytes to be transferred.
+  @param  fp_done       Callback to be notified on completion.
+*/
+/*============================================================================*/
+static void loc_spi_dmaStart(uint8_t* pc_dataWrite, uint8_t* pc_dataRead,
+                             uint16_t i_len, fp_hal_spi_event fp_done)
+{
+  uint8_t *pc_primWrite;
+  uint8_t *pc_primRead;
+  uint8_t *pc_altWrite;
+  uint8_t *pc_altRead;
+  uint16_t i_primLen;
+  uint16_t i_altLen;
+
+  gs_spi_dma.pc_write = pc_dataWrite;
+  gs_spi_dma.pc_read = pc_dataRead;
+  gs_spi_dma.i_remaining = i_len;
+  gs_spi_dma.fp_done = fp_done;
+  gs_spi_rx_tx.i_len = i_len;
+
+  loc_spi_dmaConfig((bool_t)(pc_dataWrite != NULL),
+                    (bool_t)(pc_dataRead != NULL));
+
+  i_primLen = loc_spi_dmaNextChunk(&pc_primWrite, &pc_primRead);
+  i_altLen = loc_spi_dmaNextChunk(&pc_altWrite, &pc_altRead);
+
+  /* Discard any stale data before the Rx channel gets requests */
+  gps_spi->CMD = USART_CMD_CLEARRX;
+
+  if(i_altLen == 0U)
+  {
+    gs_spi_dma.c_pending = 1U;
+    /* The Rx channel must be armed first, otherwise received bytes could
+       be lost. */
+    DMA_ActivateBasic(SF_HAL_DMA_CH_SPI_RX, true, false,
+                      pc_primRead, (void*) &(gps_spi->RXDATA), i_primLen - 1U);
+    DMA_ActivateBasic(SF_HAL_DMA_CH_SPI_TX, true, false,
+                      (void*) &(gps_spi->TXDATA), pc_primWrite, i_primLen - 1U);
+  }
+  else
+  {
+    gs_spi_dma.c_pending = 2U;
+    DMA_ActivatePingPong(SF_HAL_DMA_CH_SPI_RX, false,
+                         pc_primRead, (void*) &(gps_spi->RXDATA), i_primLen - 1U,
+                         pc_altRead, (void*) &(gps_spi->RXDATA), i_altLen - 1U);
+    DMA_ActivatePingPong(SF_HAL_DMA_CH_SPI_TX, false,
+                         (void*) &(gps_spi->TXDATA), pc_primWrite, i_primLen - 1U,
+                         (void*) &(gps_spi->TXDATA), pc_altWrite, i_altLen - 1U);
+  } /* if ... else */
+
+  return;
+} /* loc_spi_dmaStart() */
+
+/*============================================================================*/
+/**
+  @brief  Completion callback of the DMA Rx channel.
+          Called by the DMA interrupt handler each time a descriptor of the Rx
+          channel has completed. As long as there are bytes left, the completed
+          descriptors of both channels are refilled. As the Tx channel is ahead
+          of the Rx channel by the USART buffer size only, its descriptor has
+          completed as well at that time. The registered SPI event is called
+          once, as soon as the last descriptor has completed.
+  @param  channel   DMA channel that has completed.
+  @param  primary   TRUE if the primary descriptor has completed.
+  @param  user      Unused user pointer.
+*/
+/*============================================================================*/
+static void loc_spi_dmaDone(unsigned int channel, bool primary, void *user)
+{
+  uint8_t *pc_write;
+  uint8_t *pc_read;
+  uint16_t i_chunk;
+  bool_t b_stop;
+
+  gs_spi_dma.c_pending--;
+
+  if(gs_spi_dma.i_remaining > 0U)
+  {
+    i_chunk = loc_spi_dmaNextChunk(&pc_write, &pc_read);
+    /* The last chunk ends the ping-pong cycle. */
+    b_stop = (bool_t)(gs_spi_dma.i_remaining == 0U);
+    DMA_RefreshPingPong(SF_HAL_DMA_CH_SPI_RX, primary, false,
+                        pc_read, NULL, i_chunk - 1U, b_stop);
+    DMA_RefreshPingPong(SF_HAL_DMA_CH_SPI_TX, primary, false,
+                        NULL, pc_write, i_chunk - 1U, b_stop);
+    gs_spi_dma.c_pending++;
+  }
+  else if(gs_spi_dma.c_pending == 0U)
+  {
+    if(gs_spi_dma.fp_done)
+    {
+      gs_spi_dma.fp_done(gs_spi_rx_tx.i_len);
+    } /* if */
+  } /* if ... else if */
+
+  (void) channel;
+  (void) user;
+
+  return;
+} /* loc_spi_dmaDone() */
+#endif /* SPI_DMA_ENABLED */
 
 /*==============================================================================
                             FUNCTIONS
@@ -188,6 +570,34 @@ void sf_hal_spi_init(fp_hal_spi_event fp_rx, fp_hal_spi_event fp_tx)
   NVIC_ClearPendingIRQ(SPI_USART_TX_IEN); /* Clear Pending interrupts*/
   NVIC_DisableIRQ(SPI_USART_TX_IEN);      /* Disable Tx IRQ*/
   gps_spi->IEN &= ~USART_IEN_TXBL;         /* Clear Tx buffer interrupt */
+
+  #if SPI_DMA_ENABLED
+  /** Configure the DMA channels serving the USART */
+  /**@{*/
+  {
+    DMA_CfgChannel_TypeDef s_channel;
+
+    sf_hal_dma_init();
+
+    gs_spi_dmaCb.cbFunc  = loc_spi_dmaDone;
+    gs_spi_dmaCb.userPtr = NULL;
+    gs_spi_dmaCb.primary = 0U;
+
+    /* The Rx channel signals the completion of a transfer */
+    s_channel.highPri   = true;
+    s_channel.enableInt = true;
+    s_channel.select    = SPI_USART_DMAREQ_RX;
+    s_channel.cb        = &gs_spi_dmaCb;
+    DMA_CfgChannel(SF_HAL_DMA_CH_SPI_RX, &s_channel);
+
+    s_channel.highPri   = true;
+    s_channel.enableInt = false;
+    s_channel.select    = SPI_USART_DMAREQ_TX;
+    s_channel.cb        = NULL;
+    DMA_CfgChannel(SF_HAL_DMA_CH_SPI_TX, &s_channel);
+  }
+  /**@}*/
+  #endif /* SPI_DMA_ENABLED */
   
   return;
 } /* sf_hal_spi_init() */
@@ -197,6 +607,9 @@ void sf_hal_spi_init(fp_hal_spi_event fp_rx, fp_hal_spi_event fp_tx)
 /*============================================================================*/
 void sf_hal_spi_chipSelect(void)
 {
+  #if SF_HAL_SPI_CTS_STATS_NUM
+  gb_spi_ctsSelect = TRUE;
+  #endif /* SF_HAL_SPI_CTS_STATS_NUM */
   GPIO_PinModeSet(SPI_CS_PORT, SPI_CS_PIN, gpioModePushPull, 0);
 } /* sf_hal_spi_chipSelect() */
 
@@ -215,6 +628,26 @@ void sf_hal_spi_xfer(uint8_t* pc_dataWrite, uint8_t* pc_dataRead, uint16_t i_len
 {
   sf_hal_spi_chipSelect();
 
+  #if SF_HAL_SPI_CTS_STATS_NUM
+  loc_spi_ctsWrite(pc_dataWrite);
+  #endif /* SF_HAL_SPI_CTS_STATS_NUM */
+
+  #if SPI_DMA_ENABLED
+  if(i_len == 0U)
+  {
+    /* Nothing to transfer */
+  }
+  else if(pc_dataWrite != NULL)
+  {
+    /* Write data, the read bytes are discarded. */
+    loc_spi_dmaStart(pc_dataWrite, NULL, i_len, gfp_tx);
+  }
+  else if(pc_dataRead != NULL)
+  {
+    /* Read data by writing dummy bytes. */
+    loc_spi_dmaStart(NULL, pc_dataRead, i_len, gfp_rx);
+  } /* if */
+  #else
   if(pc_dataWrite != NULL)
   {
     /* Write data. */
@@ -249,6 +682,7 @@ void sf_hal_spi_xfer(uint8_t* pc_dataWrite, uint8_t* pc_dataRead, uint16_t i_len
     while( (gps_spi->STATUS & USART_STATUS_TXBL) == 0 );
     gps_spi->TXDATA =  0U ;
   } /* if */
+  #endif /* SPI_DMA_ENABLED */
 
 } /* sf_spi_xfer() */
 
@@ -259,8 +693,16 @@ void sf_hal_spi_xfer(uint8_t* pc_dataWrite, uint8_t* pc_dataRead, uint16_t i_len
 uint8_t sf_hal_spi_xferBlock(uint8_t *pc_dataWrite, uint8_t *pc_dataRead,
                       uint16_t i_len)
 {
-  uint16_t i;
+  /* Number of bytes written to TXDATA. */
+  uint16_t i_tx;
+  /* Number of bytes read from RXDATA. */
+  uint16_t i_rx;
   uint8_t c_status;
+  uint8_t c_data;
+  #if SF_HAL_SPI_CTS_STATS_NUM
+  /* Start of the data read, pc_dataRead is advanced. */
+  uint8_t *pc_read = pc_dataRead;
+  #endif /* SF_HAL_SPI_CTS_STATS_NUM */
 
   /* Disable Interrupts from SPI */
   NVIC_ClearPendingIRQ(SPI_USART_TX_IEN); /* Clear Pending interrupts*/
@@ -276,69 +718,141 @@ uint8_t sf_hal_spi_xferBlock(uint8_t *pc_dataWrite, uint8_t *pc_dataRead,
 
   c_status = 0;
 
-  if((pc_dataWrite != NULL) && (pc_dataRead == NULL))
-  {
-    for(i = 0U;i < i_len;i++)
-    {
-      /* wait until SPI is ready to transmit */
-      while( (gps_spi->STATUS & USART_STATUS_TXBL) == 0 );
-
-      /* Writes the next byte. */
-      gps_spi->TXDATA = *pc_dataWrite++;
-      while( (gps_spi->STATUS & USART_STATUS_TXC) == 0 );
+  #if SF_HAL_SPI_CTS_STATS_NUM
+  loc_spi_ctsWrite(pc_dataWrite);
+  #endif /* SF_HAL_SPI_CTS_STATS_NUM */
 
-      /* Read data. */
-      while( (gps_spi->STATUS & USART_STATUS_TXBL) == 0 );
-      c_status = gps_spi->RXDATA;
-    } /* for */
-  }
-  else if((pc_dataRead != NULL))
+  if((pc_dataWrite != NULL) || (pc_dataRead != NULL))
   {
     /* fist check if data is available, if so clear it */
     while((gps_spi->STATUS & USART_STATUS_RXDATAV) == USART_STATUS_RXDATAV)
     {
       c_status = gps_spi->RXDATA;
-    } /* if */
-
-    for(i = 0U;i < i_len;i++)
+    } /* while */
+
+    /* The USART is double buffered. Instead of waiting for each byte to be
+       shifted out completely, the next byte is written as soon as the
+       transmit buffer has space, while at most two bytes are in flight. */
+    i_tx = 0U;
+    i_rx = 0U;
+    while(i_rx < i_len)
     {
-      /* wait until SPI is ready to transmit */
-    	while( (gps_spi->STATUS & USART_STATUS_TXBL) == 0 );
-
-      /* Dummy write. */
-      if(pc_dataWrite != 0)
+      if((i_tx < i_len) && ((uint16_t)(i_tx - i_rx) < 2U) &&
+         ((gps_spi->STATUS & USART_STATUS_TXBL) != 0U))
+      {
+        /* Write data or dummy byte. */
+        if(pc_dataWrite != NULL)
+        {
+          gps_spi->TXDATA = *pc_dataWrite++;
+        }
+        else
+        {
+          gps_spi->TXDATA = 0x00;
+        } /* if ... else */
+        i_tx++;
+      } /* if */
+
+      if((gps_spi->STATUS & USART_STATUS_RXDATAV) != 0U)
       {
-        gps_spi->TXDATA = *pc_dataWrite++;
+        /* Reads the value from RX buffer. */
+        c_data = gps_spi->RXDATA;
+        if(pc_dataRead != NULL)
+        {
+          *pc_dataRead++ = c_data;
+        }
+        else
+        {
+          c_status = c_data;
+        } /* if ... else */
+        i_rx++;
+        gi_spi_isr_wtd = 0x00;
       }
       else
       {
-    	  gps_spi->TXDATA = 0x00;
-      }
-      while( (gps_spi->STATUS & USART_STATUS_TXC) == 0 );
-
-      /* Reads the value from RX buffer. */
-      while( (gps_spi->STATUS & USART_STATUS_RXDATAV) == 0) 
-      { 
         gi_spi_isr_wtd += 0x01U;
         if(gi_spi_isr_wtd == SPI_ISR_TIMEOUT){  return (FALSE); }
-      }
-      *pc_dataRead++ = gps_spi->RXDATA;
-    } /* for */
+      } /* if ... else */
+    } /* while */
   }
   else
   {
     /* Do nothing */
-  } /* if ... else if ... else */
+  } /* if ... else */
 
   /* Clear all Interrupts */
    gps_spi->IFC  = 0xFFFFFFFF;
 
+  #if SF_HAL_SPI_CTS_STATS_NUM
+  if(i_len > 0U)
+  {
+    loc_spi_ctsRead(pc_read);
+  } /* if */
+  #endif /* SF_HAL_SPI_CTS_STATS_NUM */
+
   return c_status;
 } /* sf_spi_xferBlock() */
 
+/*============================================================================*/
+/* sf_hal_spi_ctsTimeout() */
+/*============================================================================*/
+void sf_hal_spi_ctsTimeout(void)
+{
+  #if SF_HAL_SPI_CTS_STATS_NUM
+  if(gps_spi_ctsCmd != NULL)
+  {
+    gps_spi_ctsCmd->i_timeouts++;
+    gps_spi_ctsCmd = NULL;
+  } /* if */
+  gb_spi_ctsPoll = FALSE;
+  #endif /* SF_HAL_SPI_CTS_STATS_NUM */
+} /* sf_hal_spi_ctsTimeout() */
+
+/*============================================================================*/
+/* sf_hal_spi_isBusy() */
+/*============================================================================*/
+bool_t sf_hal_spi_isBusy(void)
+{
+  bool_t b_busy;
+
+  #if SPI_DMA_ENABLED
+  b_busy = (bool_t)(gs_spi_dma.c_pending > 0U);
+  #else
+  b_busy = (bool_t)(gs_spi_rx_tx.pc_data != NULL);
+  #endif /* SPI_DMA_ENABLED */
+
+  if((b_busy == FALSE) && (gps_spi != NULL))
+  {
+    /* The Tx callback of a write is called once the last byte has been
+       moved to the Tx buffer, it may still be in the shift register. */
+    b_busy = (bool_t)((gps_spi->STATUS & USART_STATUS_TXC) == 0U);
+  } /* if */
+
+  return b_busy;
+} /* sf_hal_spi_isBusy() */
+
+/*============================================================================*/
+/* sf_hal_spi_getCtsStats() */
+/*============================================================================*/
+bool_t sf_hal_spi_getCtsStats(uint8_t c_idx, s_sf_hal_spi_ctsStats_t *ps_stats)
+{
+  #if SF_HAL_SPI_CTS_STATS_NUM
+  if(c_idx < gc_spi_ctsNum)
+  {
+    *ps_stats = gas_spi_ctsStats[c_idx];
+    return TRUE;
+  } /* if */
+  #endif /* SF_HAL_SPI_CTS_STATS_NUM */
+
+  (void) c_idx;
+  (void) ps_stats;
+
+  return FALSE;
+} /* sf_hal_spi_getCtsStats() */
+
 /*==============================================================================
                             INTERRUPTS
 ==============================================================================*/
+#if !SPI_DMA_ENABLED
 
 /*============================================================================*/
 /* Rx SPI_USART_RXIRQ_HANDLER_FNC handler() */
@@ -424,6 +938,7 @@ void SPI_USART_TXIRQ_HANDLER_FNC( void )
 
   return;
 }/* SPI_USART_TXIRQ_HANDLER_FNC() */
+#endif /* !SPI_DMA_ENABLED */
 
 
 /**@}*/
@@ -19,14 +19,53 @@ extern "C" {
                             INCLUDE FILES
 ==============================================================================*/
 #include "inc\pub\utils\wmbus_typedefs.h"
+#include "inc\pub\utils\wmbus_timer_api.h"
 #include "inc\pub\hal\wmbus_hal_tmr.h"
 
+#include "sf_hal_tmr.h"
+#include "sf_hal_spi.h"
+
 #include "em_cmu.h"
+#include "em_emu.h"
+#include "em_rtc.h"
 #include "em_timer.h"
 
 /*==============================================================================
                             DEFINES
 ==============================================================================*/
+#ifndef TMR_RTC_ENABLED
+/*! Generates the timer ticks by the RTC running from the LFXO instead of
+    TIMER1. The RTC keeps on counting in EM2, which allows sf_hal_tmr_sleep()
+    to suspend the ticks until the next timer of the stack expires. */
+#define TMR_RTC_ENABLED                     TRUE
+#endif /* TMR_RTC_ENABLED */
+
+#if (TMR_RTC_ENABLED == TRUE)
+/*! Mask of the RTC counter. All the compare values wrap around with it. */
+#define TMR_RTC_CNT_MASK                    (_RTC_CNT_MASK)
+/*! Compare values ahead of the counter by more than the half of its range
+    are considered to be in the past. This limits the sleep duration to
+    256s at 32768Hz. */
+#define TMR_RTC_CNT_HALF                    (TMR_RTC_CNT_MASK >> 1U)
+/*! Entering EM2 is not worth it if the next timer expires within this number
+    of ticks. It covers the synchronisation of the compare register to the
+    low frequency domain as well. */
+#define TMR_RTC_SLEEP_MIN_TICKS             (4U)
+
+#ifndef TMR_RTC_SLEEP_PERIOD_MS
+/*! The clock of the stack polls its timeout from the run function and
+    restarts it relative to the time it noticed the expiry. Thus the sleep
+    ends on a grid of this period at the latest, which keeps the clock in
+    step once it expired on a wake up. Set to 0 if no clock is used. */
+#define TMR_RTC_SLEEP_PERIOD_MS             (1000U)
+#endif /* TMR_RTC_SLEEP_PERIOD_MS */
+
+/*! Compare channel generating the ticks. */
+#define TMR_RTC_COMP                        (0U)
+/*! Interrupt flag of the compare channel. */
+#define TMR_RTC_IF                          RTC_IF_COMP0
+
+#else
 /** Timer settings required for the stack. @warning As the timer is very
     important to the stack, do not changes these settings unless you know what
     you're doing. */
@@ -61,15 +100,339 @@ extern "C" {
     false                   /* Not started/stopped/reloaded by other timers. */         \
 }
 #endif
+#endif /* TMR_RTC_ENABLED */
 
 /*==============================================================================
                             VARIABLES
 ==============================================================================*/
+/*! Context of the timer module of the stack. It holds the tick counter and
+    the list of the running timers sorted by their expiry. */
+extern s_tmr_ctx_t* gps_tmr_ctx_ptr;
+
+#if (TMR_RTC_ENABLED == TRUE)
+static fp_hal_tmr_cb gfp_tmr_tick = NULL;
+
+/*! Number of ticks per second requested by the stack. */
+static uint32_t gl_tmr_ticksPerSecond;
+/*! Integral part of the RTC counts per tick. */
+static uint32_t gl_tmr_cntPerTick;
+/*! Fractional part of the RTC counts per tick, in units of
+    1/gl_tmr_ticksPerSecond counts. */
+static uint32_t gl_tmr_cntPerTickFrac;
+/*! Maximum number of ticks sf_hal_tmr_sleep() may suspend. */
+static uint32_t gl_tmr_sleepMaxTicks;
+/*! Period of the grid the sleep ends on in ticks, 0 if not used. */
+static uint32_t gl_tmr_sleepPeriodTicks;
+
+/*! RTC counter value of the next tick. */
+static uint32_t gl_tmr_nextCnt;
+/*! Accumulated fractional part of gl_tmr_nextCnt. */
+static uint32_t gl_tmr_nextCntFrac;
+/*! Number of RTC counter overflows, extends the counter for the
+    timestamps. */
+static uint32_t gl_tmr_cntOverflows;
+#else
 static fp_hal_tmr_cb gfp_tmr1_tick = NULL;
+/*! Number of ticks per second requested by the stack. */
+static uint32_t gl_tmr1_ticksPerSecond;
+#endif /* TMR_RTC_ENABLED */
+
+/*==============================================================================
+                            LOCAL FUNCTIONS
+==============================================================================*/
+/*============================================================================*/
+/* loc_tmr_tickCntAdd() */
+/*============================================================================*/
+static void loc_tmr_tickCntAdd(uint32_t l_ticks)
+{
+  uint32_t l_primask = __get_PRIMASK();
+
+  /* The tick interrupt increments the counter as well. */
+  __disable_irq();
+  gps_tmr_ctx_ptr->gl_tmr_tickCnt += l_ticks;
+  __set_PRIMASK(l_primask);
+} /* loc_tmr_tickCntAdd() */
+
+#if (TMR_RTC_ENABLED == TRUE)
+/*============================================================================*/
+/* loc_tmr_advance() */
+/*============================================================================*/
+static void loc_tmr_advance(uint32_t l_ticks)
+{
+  uint32_t l_frac;
+
+  /* The RTC counts per tick are not an integer in general, e.g. 16.384 for
+     2000 ticks per second. The fractional part is accumulated separately,
+     so the ticks do not drift against the LFXO. */
+  l_frac = gl_tmr_nextCntFrac + (l_ticks * gl_tmr_cntPerTickFrac);
+  gl_tmr_nextCnt += (l_ticks * gl_tmr_cntPerTick) +
+                    (l_frac / gl_tmr_ticksPerSecond);
+  gl_tmr_nextCnt &= TMR_RTC_CNT_MASK;
+  gl_tmr_nextCntFrac = l_frac % gl_tmr_ticksPerSecond;
+} /* loc_tmr_advance() */
+
+/*============================================================================*/
+/* loc_tmr_isDue() */
+/*============================================================================*/
+static bool_t loc_tmr_isDue(uint32_t l_cnt)
+{
+  /* Due as soon as the counter reached the value, up to half of its range
+     behind it. */
+  return ((((RTC_CounterGet() - l_cnt) & TMR_RTC_CNT_MASK) <= TMR_RTC_CNT_HALF)
+          ? TRUE : FALSE);
+} /* loc_tmr_isDue() */
+
+/*============================================================================*/
+/* loc_tmr_catchUp() */
+/*============================================================================*/
+static uint32_t loc_tmr_catchUp(void)
+{
+  uint32_t l_elapsed;
+  uint32_t l_rtcFreq;
+  uint32_t l_ticks = 0U;
+
+  if(loc_tmr_isDue(gl_tmr_nextCnt))
+  {
+    /* Skip most of the elapsed ticks at once. The estimate is kept below
+       the exact value, the remaining ticks are counted one by one. */
+    l_elapsed = (RTC_CounterGet() - gl_tmr_nextCnt) & TMR_RTC_CNT_MASK;
+    l_rtcFreq = (gl_tmr_cntPerTick * gl_tmr_ticksPerSecond) +
+                gl_tmr_cntPerTickFrac;
+    l_ticks = ((l_elapsed / l_rtcFreq) * gl_tmr_ticksPerSecond) +
+              (((l_elapsed % l_rtcFreq) * gl_tmr_ticksPerSecond) / l_rtcFreq);
+    if(l_ticks > 0U)
+    {
+      l_ticks--;
+    } /* if */
+    loc_tmr_advance(l_ticks);
+
+    while(loc_tmr_isDue(gl_tmr_nextCnt))
+    {
+      loc_tmr_advance(1U);
+      l_ticks++;
+    } /* while */
+  } /* if */
+
+  return l_ticks;
+} /* loc_tmr_catchUp() */
+
+/*============================================================================*/
+/* loc_tmr_ticksToNextTimer() */
+/*============================================================================*/
+static uint32_t loc_tmr_ticksToNextTimer(void)
+{
+  s_tmr_t* ps_tmr;
+  sint32_t sl_ticks;
+  uint32_t l_ret = gl_tmr_sleepMaxTicks;
+
+  if(gl_tmr_sleepPeriodTicks > 0U)
+  {
+    l_ret = gl_tmr_sleepPeriodTicks -
+            (gps_tmr_ctx_ptr->gl_tmr_tickCnt % gl_tmr_sleepPeriodTicks);
+  } /* if */
+
+  /* The timers are sorted by their expiry, the first one expires next. */
+  ps_tmr = gps_tmr_ctx_ptr->ps_tmrFirst;
+  if(ps_tmr != NULL)
+  {
+    sl_ticks = (sint32_t)(ps_tmr->l_ticks - gps_tmr_ctx_ptr->gl_tmr_tickCnt);
+    if(sl_ticks <= 0)
+    {
+      l_ret = 0U;
+    }
+    else if((uint32_t)sl_ticks < l_ret)
+    {
+      l_ret = (uint32_t)sl_ticks;
+    } /* if ... else if */
+  } /* if */
+
+  return l_ret;
+} /* loc_tmr_ticksToNextTimer() */
+#endif /* TMR_RTC_ENABLED */
 
 /*==============================================================================
                             FUNCTIONS
 ==============================================================================*/
+#if (TMR_RTC_ENABLED == TRUE)
+/*============================================================================*/
+/* wmbus_hal_tmr_init() */
+/*============================================================================*/
+bool_t wmbus_hal_tmr_init(uint16_t i_ticksPerSecond)
+{
+  RTC_Init_TypeDef s_rtcInit = RTC_INIT_DEFAULT;
+  uint32_t l_rtcFreq;
+
+  /* Initialize callback function. */
+  gfp_tmr_tick = NULL;
+
+  /* Run the RTC from the LFXO. */
+  CMU_ClockEnable(cmuClock_CORELE, true);
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFXO);
+  CMU_ClockDivSet(cmuClock_RTC, cmuClkDiv_1);
+  CMU_ClockEnable(cmuClock_RTC, true);
+
+  l_rtcFreq = CMU_ClockFreqGet(cmuClock_RTC);
+  gl_tmr_ticksPerSecond = i_ticksPerSecond;
+  gl_tmr_cntPerTick = l_rtcFreq / gl_tmr_ticksPerSecond;
+  gl_tmr_cntPerTickFrac = l_rtcFreq % gl_tmr_ticksPerSecond;
+  gl_tmr_sleepMaxTicks = (TMR_RTC_CNT_HALF / l_rtcFreq) *
+                         gl_tmr_ticksPerSecond;
+  gl_tmr_sleepPeriodTicks = (TMR_RTC_SLEEP_PERIOD_MS *
+                             gl_tmr_ticksPerSecond) / 1000U;
+  if(gl_tmr_sleepPeriodTicks > gl_tmr_sleepMaxTicks)
+  {
+    gl_tmr_sleepPeriodTicks = gl_tmr_sleepMaxTicks;
+  } /* if */
+
+  /* The counter runs over its full range, the ticks are generated by moving
+     the compare value ahead. */
+  s_rtcInit.enable = false;
+  s_rtcInit.comp0Top = false;
+  RTC_Init(&s_rtcInit);
+  RTC_CounterReset();
+
+  gl_tmr_nextCnt = 0U;
+  gl_tmr_nextCntFrac = 0U;
+  gl_tmr_cntOverflows = 0U;
+  loc_tmr_advance(1U);
+  RTC_CompareSet(TMR_RTC_COMP, gl_tmr_nextCnt);
+  RTC_IntClear(TMR_RTC_IF | RTC_IF_OF);
+  /* The overflows extend the counter for the timestamps. */
+  RTC_IntEnable(RTC_IF_OF);
+  RTC_Enable(true);
+
+  return TRUE;
+} /* wmbus_hal_tmr_init() */
+
+/*============================================================================*/
+/* wmbus_hal_tmr_deinit() */
+/*============================================================================*/
+bool_t wmbus_hal_tmr_deinit(void)
+{
+  return FALSE;
+} /* wmbus_hal_tmr_deinit() */
+
+/*============================================================================*/
+/* wmbus_hal_tmr_setCallback() */
+/*============================================================================*/
+bool_t wmbus_hal_tmr_setCallback(fp_hal_tmr_cb fp_tmr)
+{
+  bool_t b_ret = FALSE;
+
+  if(fp_tmr)
+  {
+    gfp_tmr_tick = fp_tmr;
+
+    /* Enable compare interrupt */
+    RTC_IntEnable(TMR_RTC_IF);
+    /* Enable RTC interrupt vector in NVIC */
+    NVIC_EnableIRQ(RTC_IRQn);
+    b_ret = TRUE;
+  }
+  return b_ret;
+} /* wmbus_hal_tmr_setCallback() */
+
+/*============================================================================*/
+/* wmbus_hal_tmr_enable() */
+/*============================================================================*/
+void wmbus_hal_tmr_enable(void)
+{
+  /* The counter was stopped, continue with the tick it stopped at. */
+  RTC_Enable(true);
+  /* Enable RTC interrupt vector in NVIC */
+  NVIC_EnableIRQ(RTC_IRQn);
+} /* wmbus_hal_tmr_enable() */
+
+/*============================================================================*/
+/* wmbus_hal_tmr_disable() */
+/*============================================================================*/
+void wmbus_hal_tmr_disable(void)
+{
+  /* Disable RTC interrupt vector in NVIC */
+  NVIC_DisableIRQ(RTC_IRQn);
+  /* Stop the counter. The low energy clocks are kept, as they are shared
+     with the LEUART. */
+  RTC_Enable(false);
+} /* wmbus_hal_tmr_disable() */
+
+/*============================================================================*/
+/* sf_hal_tmr_sleep() */
+/*============================================================================*/
+void sf_hal_tmr_sleep(void)
+{
+  uint32_t l_ticks;
+  uint32_t l_nextCnt;
+  uint32_t l_nextCntFrac;
+
+  /* Interrupts stay pending while disabled, but still wake up the core.
+     Thus no event can get lost between checking the timers and entering
+     the sleep mode. */
+  __disable_irq();
+
+  l_ticks = loc_tmr_ticksToNextTimer();
+  if((l_ticks > TMR_RTC_SLEEP_MIN_TICKS) && (gfp_tmr_tick != NULL) &&
+     (sf_hal_spi_isBusy() == FALSE))
+  {
+    /* Move the compare value to the tick the next timer expires at. The
+       ticks in between are not signalled. */
+    l_nextCnt = gl_tmr_nextCnt;
+    l_nextCntFrac = gl_tmr_nextCntFrac;
+    loc_tmr_advance(l_ticks - 1U);
+    RTC_CompareSet(TMR_RTC_COMP, gl_tmr_nextCnt);
+    gl_tmr_nextCnt = l_nextCnt;
+    gl_tmr_nextCntFrac = l_nextCntFrac;
+
+    EMU_EnterEM2(true);
+
+    /* Woken up either by the compare match or any other interrupt. Correct
+       the tick counter by the ticks elapsed in the meantime and continue
+       with the regular ticks. */
+    gps_tmr_ctx_ptr->gl_tmr_tickCnt += loc_tmr_catchUp();
+    RTC_CompareSet(TMR_RTC_COMP, gl_tmr_nextCnt);
+    RTC_IntClear(TMR_RTC_IF);
+    NVIC_ClearPendingIRQ(RTC_IRQn);
+    if(loc_tmr_isDue(gl_tmr_nextCnt))
+    {
+      /* The next tick passed while setting the compare value. */
+      NVIC_SetPendingIRQ(RTC_IRQn);
+    } /* if */
+  }
+  else if(l_ticks > 0U)
+  {
+    /* The ticks have to continue or a SPI transfer has to complete, wait
+       for any interrupt in EM1. */
+    EMU_EnterEM1();
+  } /* if ... else if */
+
+  __enable_irq();
+} /* sf_hal_tmr_sleep() */
+
+/*============================================================================*/
+/* sf_hal_tmr_getTimestamp() */
+/*============================================================================*/
+uint32_t sf_hal_tmr_getTimestamp(void)
+{
+  uint32_t l_primask = __get_PRIMASK();
+  uint32_t l_cnt;
+  uint32_t l_overflows;
+
+  /* May be called with the interrupts disabled, their state is restored. */
+  __disable_irq();
+  l_overflows = gl_tmr_cntOverflows;
+  l_cnt = RTC_CounterGet();
+  if(RTC_IntGet() & RTC_IF_OF)
+  {
+    /* The counter overflowed, but the interrupt did not count it yet. It is
+       read again, as the overflow may have occurred after reading it. */
+    l_cnt = RTC_CounterGet();
+    l_overflows++;
+  } /* if */
+  __set_PRIMASK(l_primask);
+
+  return (l_overflows * (TMR_RTC_CNT_MASK + 1U)) + l_cnt;
+} /* sf_hal_tmr_getTimestamp() */
+
+#else
 /*============================================================================*/
 /* wmbus_hal_tmr_init() */
 /*============================================================================*/
@@ -79,6 +442,7 @@ bool_t wmbus_hal_tmr_init(uint16_t i_ticksPerSecond)
 
   /* Initialize callback function. */
   gfp_tmr1_tick = NULL;
+  gl_tmr1_ticksPerSecond = i_ticksPerSecond;
 
   /* Enable clock for TIMER1 module */
   CMU_ClockEnable(cmuClock_TIMER1, true);
@@ -147,11 +511,34 @@ void wmbus_hal_tmr_disable(void)
   CMU_ClockEnable(cmuClock_TIMER1, false);
 } /* wmbus_hal_tmr_disable() */
 
+/*============================================================================*/
+/* sf_hal_tmr_sleep() */
+/*============================================================================*/
+void sf_hal_tmr_sleep(void)
+{
+  /* TIMER1 stops in EM2, the next tick wakes up the core from EM1. */
+  EMU_EnterEM1();
+} /* sf_hal_tmr_sleep() */
+
+/*============================================================================*/
+/* sf_hal_tmr_getTimestamp() */
+/*============================================================================*/
+uint32_t sf_hal_tmr_getTimestamp(void)
+{
+  /* TIMER1 is reloaded on every tick, thus the timestamp is derived from the
+     tick counter. */
+  return (uint32_t)(((uint64_t)gps_tmr_ctx_ptr->gl_tmr_tickCnt *
+                     SF_HAL_TMR_TIMESTAMP_FREQ) / gl_tmr1_ticksPerSecond);
+} /* sf_hal_tmr_getTimestamp() */
+#endif /* TMR_RTC_ENABLED */
+
 /*============================================================================*/
 /* wmbus_hal_tmr_set() */
 /*============================================================================*/
 bool_t wmbus_hal_tmr_set(uint16_t ui_counterValue)
 {
+  /* Not supported. The expiry of the running timers is kept as absolute
+     values of the 32 bit tick counter, which a 16 bit value would corrupt. */
   return FALSE;
 } /* wmbus_hal_tmr_set() */
 
@@ -160,13 +547,48 @@ bool_t wmbus_hal_tmr_set(uint16_t ui_counterValue)
 /*============================================================================*/
 bool_t wmbus_hal_tmr_offset(sint16_t si_offset)
 {
-  return FALSE;
+  /* Adding the two's complement subtracts negative offsets. */
+  loc_tmr_tickCntAdd((uint32_t)((sint32_t)si_offset));
+
+  return TRUE;
 } /* wmbus_hal_tmr_offset() */
 
 
 /*==============================================================================
                             INTERRUPTS
 ==============================================================================*/
+#if (TMR_RTC_ENABLED == TRUE)
+/*========================= RTC ISR =========================================*/
+void RTC_IRQHandler(void)
+{
+  if(RTC_IntGet() & RTC_IF_OF)
+  {
+    RTC_IntClear(RTC_IF_OF);
+    gl_tmr_cntOverflows++;
+  } /* if */
+
+  /* The flag has been cleared already if the tick was counted on wake up. */
+  if(RTC_IntGet() & TMR_RTC_IF)
+  {
+    RTC_IntClear(TMR_RTC_IF);
+
+    /* Signal every tick that passed, usually a single one. The compare value
+       is checked again after writing it, since the counter might have
+       passed it already. */
+    do
+    {
+      loc_tmr_advance(1U);
+      RTC_CompareSet(TMR_RTC_COMP, gl_tmr_nextCnt);
+
+      if(gfp_tmr_tick)
+      {
+        /* Call callback function. */
+        gfp_tmr_tick();
+      } /* if */
+    } while(loc_tmr_isDue(gl_tmr_nextCnt));
+  } /* if */
+} /* RTC_IRQHandler() */
+#else
 /*========================= TIMER 1 ISR =====================================*/
 void TIMER1_IRQHandler(void)
 {
@@ -179,6 +601,7 @@ void TIMER1_IRQHandler(void)
     gfp_tmr1_tick();
   } /* if */
 } /* TIMER1_IRQHandler() */
+#endif /* TMR_RTC_ENABLED */
 
 /**@}*/
 #ifdef __cplusplus
@@ -0,0 +1,57 @@
+#ifndef __SF_HAL_TMR_H__
+#define __SF_HAL_TMR_H__
+
+/**
+  @file       sf_hal_tmr.h
+  @copyright  STACKFORCE GmbH, Heitersheim, Germany, http://www.stackforce.de
+  @author     STACKFORCE
+  @brief      Target specific extensions of the timer HAL.
+
+  @addtogroup WMBUS_HAL_TMR
+
+  By default the timer ticks are generated by the RTC, which keeps on running
+  in EM2. While the application is idle, sf_hal_tmr_sleep() suspends the
+  ticks until the next timer of the stack expires and corrects the tick
+  counter on wake up.
+
+  sf_hal_tmr_getTimestamp() provides a free running timestamp with a higher
+  resolution than the ticks, e.g. to timestamp the reception of telegrams.
+*/
+/**@{*/
+
+/*==============================================================================
+                            DEFINES
+==============================================================================*/
+/*! Frequency of the timestamps returned by sf_hal_tmr_getTimestamp(). */
+#define SF_HAL_TMR_TIMESTAMP_FREQ            (32768U)
+
+/*==============================================================================
+                         FUNCTION PROTOTYPES OF THE API
+==============================================================================*/
+
+/**
+  @brief  Puts the MCU to sleep until the next event.
+          Enters EM2 until the next timer of the stack expires or any other
+          interrupt occurs. Falls back to EM1 if a timer is about to expire,
+          a SPI transfer to the radio is in progress or the ticks are
+          generated by TIMER1. Returns immediately if a timer already
+          expired.
+          To be called from the main loop of the application only, once all
+          the pending work has been done. Peripherals not operating in EM2,
+          e.g. the USB, must not be in use.
+*/
+void sf_hal_tmr_sleep(void);
+
+/**
+  @brief  Returns the value of a free running timestamp.
+          The timestamp counts at SF_HAL_TMR_TIMESTAMP_FREQ and wraps around
+          after 2^32 counts, i.e. after about 36 hours. It is taken from the
+          RTC counter, thus it keeps on counting during sf_hal_tmr_sleep().
+          If the ticks are generated by TIMER1, the timestamp only has the
+          resolution of a tick. May be called from interrupts.
+  @return Current timestamp.
+*/
+uint32_t sf_hal_tmr_getTimestamp(void);
+
+/**@}*/
+#endif /* __SF_HAL_TMR_H__ */
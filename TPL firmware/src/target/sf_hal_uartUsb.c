@@ -31,6 +31,7 @@ extern "C" {
 #include "em_gpio.h"
 #include "em_usart.h"
 #include "em_usb.h"
+#include "em_int.h"
 /*==============================================================================
                             CONFIGURATION
 ==============================================================================*/
@@ -38,11 +39,21 @@ extern "C" {
 #define USB_RX_BUF_SIZ               USB_FS_BULK_EP_MAXSIZE
 #define USB_TX_BUF_SIZ               USB_BUFFER_TX_LEN
 
-/*! Sets the length of the Rx ringbuffer. */
+#ifndef UART_BUFFER_RX_LEN
+/*! Sets the length of the Rx ringbuffer. The host is only allowed to send
+    the next packet if there is space for a whole packet. */
 #define UART_BUFFER_RX_LEN           300U
-/*! Sets the length of the Tx ringbuffer. */
-#define USB_BUFFER_TX_LEN            300U
+#endif /* UART_BUFFER_RX_LEN */
 
+#ifndef USB_BUFFER_TX_LEN
+/*! Sets the length of each of the two Tx buffers. While one of them is
+    transferred to the host, the serial layer writes into the other one. */
+#define USB_BUFFER_TX_LEN            512U
+#endif /* USB_BUFFER_TX_LEN */
+
+#if (UART_BUFFER_RX_LEN < (2U * USB_RX_BUF_SIZ))
+#error: UART_BUFFER_RX_LEN has to hold at least two USB packets.
+#endif
 
 /*==============================================================================
                             FUNCTION PROTOTYPES
@@ -55,6 +66,11 @@ static void loc_StateChange(USBD_State_TypeDef oldState,
                         USBD_State_TypeDef newState);
 static int  loc_UsbDataReceived(USB_Status_TypeDef status, uint32_t xferred,
                             uint32_t remaining);
+static int  loc_UsbDataSent(USB_Status_TypeDef status, uint32_t xferred,
+                            uint32_t remaining);
+static void loc_usb_rxStart(void);
+static void loc_usb_txStart(void);
+static void loc_usb_txKick(void);
 
 /*==============================================================================
                           TYPEDEFS
@@ -76,27 +92,46 @@ EFM32_PACK_END()
                             VARIABLES
 ==============================================================================*/
 /*! Input ring buffer. */
-volatile uint8_t gc_uart_bufferRx[UART_BUFFER_RX_LEN];
-/*! Pointer to the Rx ring buffer's current write position */
-volatile uint8_t *gpc_uart_bufferRxWrite;
-/*! Pointer to the Rx ring buffer's current read position */
-volatile uint8_t *gpc_uart_bufferRxRead;
+static uint8_t gc_uart_bufferRx[UART_BUFFER_RX_LEN];
+/*! Index of the Rx ring buffer's current write position */
+static uint16_t gi_uart_bufferRxWrite;
+/*! Index of the Rx ring buffer's current read position */
+static uint16_t gi_uart_bufferRxRead;
 /*! Number of bytes in the input buffer. */
-volatile uint16_t gi_uart_bufferRxLen;
-
-/*! Input ring buffer. */
-volatile uint8_t gc_uart_bufferTx[USB_BUFFER_TX_LEN];
-/*! Pointer to the Tx ring buffer's current write position */
-volatile uint8_t *gpc_uart_bufferTxWrite;
-/*! Pointer to the Tx ring buffer's current read position */
-volatile uint8_t *gpc_uart_bufferTxRead;
-/*! Number of bytes in the input buffer. */
-volatile uint16_t gi_uart_bufferTxLen;
+static volatile uint16_t gi_uart_bufferRxLen;
+/*! Set if reading from the host is paused due to a full input buffer. */
+static volatile bool_t gb_usb_rxPaused;
 
 /*! USB Rx buffers */
-STATIC_UBUF(usbRxBuffer, USB_RX_BUF_SIZ);    /* USB receive buffers.   */
+STATIC_UBUF(gc_usb_rxBuffer0, USB_RX_BUF_SIZ);    /* USB receive buffers.   */
+STATIC_UBUF(gc_usb_rxBuffer1, USB_RX_BUF_SIZ);
+/*! USB Rx buffers used alternately. */
+static uint8_t* const gapc_usb_rxBuffer[2U] =
+{
+  gc_usb_rxBuffer0, gc_usb_rxBuffer1
+};
+/*! Index of the USB Rx buffer being read into. */
+static uint8_t gc_usb_rxIdx;
+
 /*! USB Tx buffers */
-STATIC_UBUF(gc_usb_Txbuffer, USB_TX_BUF_SIZ);    /* USB transmit buffers.   */
+STATIC_UBUF(gc_usb_txBuffer0, USB_TX_BUF_SIZ);    /* USB transmit buffers.   */
+STATIC_UBUF(gc_usb_txBuffer1, USB_TX_BUF_SIZ);
+/*! USB Tx buffers used alternately. The serial layer writes straight into
+    one of them while the other one is transferred. */
+static uint8_t* const gapc_usb_txBuffer[2U] =
+{
+  gc_usb_txBuffer0, gc_usb_txBuffer1
+};
+/*! Number of bytes within each of the USB Tx buffers. */
+static volatile uint16_t gai_usb_txLen[2U];
+/*! Index of the USB Tx buffer being written by the serial layer. */
+static volatile uint8_t gc_usb_txFill;
+/*! Set while the other USB Tx buffer is transferred. */
+static volatile bool_t gb_usb_txBusy;
+/*! Set if the written data shall be sent as soon as possible. */
+static volatile bool_t gb_usb_txFlush;
+/*! Set while wmbus_hal_uart_write() is writing into the USB Tx buffer. */
+static volatile bool_t gb_usb_txWriting;
 
 /*
  * The LineCoding variable must be 4-byte aligned as it is used as USB
@@ -293,8 +328,15 @@ static void loc_StateChange(USBD_State_TypeDef oldState,
     }
 
     /* Start receiving data from USB host. */
-    USBD_Read(CDC_EP_DATA_OUT, (void*) usbRxBuffer,
-              USB_RX_BUF_SIZ, loc_UsbDataReceived);
+    if((UART_BUFFER_RX_LEN - gi_uart_bufferRxLen) >= USB_RX_BUF_SIZ)
+    {
+      gb_usb_rxPaused = FALSE;
+      loc_usb_rxStart();
+    }
+    else
+    {
+      gb_usb_rxPaused = TRUE;
+    } /* if ... else */
   }
 
   else if ((oldState == USBD_STATE_CONFIGURED) &&
@@ -326,31 +368,137 @@ static int loc_UsbDataReceived(USB_Status_TypeDef status,
                            uint32_t xferred,
                            uint32_t remaining)
 {
+  uint8_t *pc_data;
+  uint16_t i;
+
   (void) remaining;            /* Unused parameter */
-  uint8_t i = 0;
 
-  if ((status == USB_STATUS_OK) && (xferred > 0))
+  /* An aborted read is restarted as soon as the device is configured. */
+  if (status == USB_STATUS_OK)
   {
-    /* We received data successfully */
-    for(i=0; i < xferred; ++i)
+    pc_data = gapc_usb_rxBuffer[gc_usb_rxIdx];
+    gc_usb_rxIdx ^= 1U;
+
+    /* The next packet is received into the other buffer meanwhile, as long
+       as it fits into the input buffer. Otherwise the host is stopped until
+       wmbus_hal_uart_read() has made enough space. */
+    if((UART_BUFFER_RX_LEN - gi_uart_bufferRxLen - xferred) >= USB_RX_BUF_SIZ)
+    {
+      loc_usb_rxStart();
+    }
+    else
     {
-      /* Read data from aligned USB buffer to local buffer */
-      *gpc_uart_bufferRxWrite++ = usbRxBuffer[i];
+      gb_usb_rxPaused = TRUE;
+    } /* if ... else */
 
-      /*! Check for an overflow of the read pointer and adjust if required. */
-      if(gpc_uart_bufferRxWrite == &gc_uart_bufferRx[UART_BUFFER_RX_LEN])
+    for(i = 0U; i < xferred; i++)
+    {
+      gc_uart_bufferRx[gi_uart_bufferRxWrite++] = pc_data[i];
+      if(gi_uart_bufferRxWrite == UART_BUFFER_RX_LEN)
       {
-        gpc_uart_bufferRxWrite = gc_uart_bufferRx;
+        gi_uart_bufferRxWrite = 0U;
       } /* if */
-    }/* for() */
+    } /* for */
+    gi_uart_bufferRxLen += (uint16_t) xferred;
+  } /* if */
+
+  return USB_STATUS_OK;
+}
+
+/*******************************************************************************
+ * @brief Callback function called whenever a transfer to the host has
+ *        completed or has been aborted.
+ *
+ * @param[in] status    Transfer status code.
+ * @param[in] xferred   Number of bytes transferred.
+ * @param[in] remaining Number of bytes not transferred.
+ *
+ * @return USB_STATUS_OK.
+ *****************************************************************************/
+static int loc_UsbDataSent(USB_Status_TypeDef status,
+                           uint32_t xferred,
+                           uint32_t remaining)
+{
+  (void) status;               /* Unused parameter */
+  (void) xferred;              /* Unused parameter */
+  (void) remaining;            /* Unused parameter */
+
+  /* Release the transferred buffer. */
+  gai_usb_txLen[gc_usb_txFill ^ 1U] = 0U;
+  gb_usb_txBusy = FALSE;
+
+  /* If the serial layer is just writing, it sends the data itself. */
+  if(gb_usb_txWriting == FALSE)
+  {
+    loc_usb_txKick();
+  } /* if */
 
-    /* Toogle to next aligned Rx buffer */
-    USBD_Read(CDC_EP_DATA_OUT, (void*) usbRxBuffer,
-              USB_RX_BUF_SIZ, loc_UsbDataReceived);
-  }
   return USB_STATUS_OK;
 }
 
+/*============================================================================*/
+/**
+  @brief  Starts reading the next packet from the host into the next USB Rx
+          buffer.
+*/
+/*============================================================================*/
+static void loc_usb_rxStart(void)
+{
+  USBD_Read(CDC_EP_DATA_OUT, (void*) gapc_usb_rxBuffer[gc_usb_rxIdx],
+            USB_RX_BUF_SIZ, loc_UsbDataReceived);
+  return;
+} /* loc_usb_rxStart() */
+
+/*============================================================================*/
+/**
+  @brief  Starts transferring the USB Tx buffer written by the serial layer.
+          Afterwards the serial layer writes into the other buffer. Does
+          nothing as long as the previous transfer is running. If the device
+          is not configured, the data is discarded.
+          Must be called with the USB interrupt disabled.
+*/
+/*============================================================================*/
+static void loc_usb_txStart(void)
+{
+  uint8_t c_fill = gc_usb_txFill;
+
+  if((gb_usb_txBusy == FALSE) && (gai_usb_txLen[c_fill] > 0U))
+  {
+    if(USBD_Write(CDC_EP_DATA_IN, (void*) gapc_usb_txBuffer[c_fill],
+                  gai_usb_txLen[c_fill], loc_UsbDataSent) == USB_STATUS_OK)
+    {
+      gb_usb_txBusy = TRUE;
+      gc_usb_txFill = (c_fill ^ 1U);
+    }
+    else
+    {
+      gai_usb_txLen[c_fill] = 0U;
+    } /* if ... else */
+    gb_usb_txFlush = FALSE;
+  } /* if */
+
+  return;
+} /* loc_usb_txStart() */
+
+/*============================================================================*/
+/**
+  @brief  Starts the next transfer if the data is to be flushed or the USB Tx
+          buffer is full. Otherwise the data is collected to send larger
+          transfers.
+          Must be called with the USB interrupt disabled.
+*/
+/*============================================================================*/
+static void loc_usb_txKick(void)
+{
+  if((gb_usb_txFlush == TRUE) ||
+     (gai_usb_txLen[gc_usb_txFill] == USB_TX_BUF_SIZ))
+  {
+    loc_usb_txStart();
+  } /* if */
+
+  return;
+} /* loc_usb_txKick() */
+
 
 /*==============================================================================
                             FUNCTIONS
@@ -361,11 +509,19 @@ static int loc_UsbDataReceived(USB_Status_TypeDef status,
 bool_t wmbus_hal_uart_init(void)
 {
   /*! Init the Tx-buffer variables. */
-  gpc_uart_bufferTxWrite = gc_uart_bufferTx;
-  gpc_uart_bufferTxRead = gc_uart_bufferTx;
-
-  gpc_uart_bufferRxRead = gc_uart_bufferRx;
-  gpc_uart_bufferRxWrite = gc_uart_bufferRx;
+  gai_usb_txLen[0U] = 0U;
+  gai_usb_txLen[1U] = 0U;
+  gc_usb_txFill = 0U;
+  gb_usb_txBusy = FALSE;
+  gb_usb_txFlush = FALSE;
+  gb_usb_txWriting = FALSE;
+
+  /*! Init the Rx-buffer variables. */
+  gi_uart_bufferRxRead = 0U;
+  gi_uart_bufferRxWrite = 0U;
+  gi_uart_bufferRxLen = 0U;
+  gb_usb_rxPaused = FALSE;
+  gc_usb_rxIdx = 0U;
 
   USBD_Init(&InitStruct);
 
@@ -378,24 +534,49 @@ bool_t wmbus_hal_uart_init(void)
 /*============================================================================*/
 uint16_t wmbus_hal_uart_write(uint8_t *pc_data, uint16_t i_len)
 {
-  uint16_t i;
+  uint16_t i = 0U;
+  uint16_t i_chunk;
+  uint8_t c_fill;
 
-  /*! Write to Tx-ringbuffer until i_len or USB_BUFFER_TX_LEN is reached. */
-  for(i = 0U; (i < i_len) && (USB_BUFFER_TX_LEN > gi_uart_bufferTxLen); i++)
+  /*! The data is written straight into the USB Tx buffer. Meanwhile the
+      completion of a transfer must not start the next one. */
+  gb_usb_txWriting = TRUE;
+
+  while(i < i_len)
   {
-    /*! Write current byte to the write pointers address within the ringbuffer
-        and increase the pointer. */
-    *gpc_uart_bufferTxWrite++ = pc_data[i];
-    /*! Increase the number of bytes in ringbuffer. */
-    gi_uart_bufferTxLen++;
-
-    /*! Check for an overflow of the write pointer and adjust if required. */
-    if(gpc_uart_bufferTxWrite == &gc_uart_bufferTx[USB_BUFFER_TX_LEN])
+    c_fill = gc_usb_txFill;
+    i_chunk = (USB_TX_BUF_SIZ - gai_usb_txLen[c_fill]);
+    if(i_chunk > (i_len - i))
     {
-      gpc_uart_bufferTxWrite = gc_uart_bufferTx;
+      i_chunk = (i_len - i);
     } /* if */
 
-  } /* for */
+    if(i_chunk == 0U)
+    {
+      /*! The buffer is full, continue with the other one if available. */
+      INT_Disable();
+      loc_usb_txStart();
+      INT_Enable();
+      if(gc_usb_txFill == c_fill)
+      {
+        break;
+      } /* if */
+    }
+    else
+    {
+      MEMCPY(&gapc_usb_txBuffer[c_fill][gai_usb_txLen[c_fill]],
+             &pc_data[i], i_chunk);
+      gai_usb_txLen[c_fill] += i_chunk;
+      i += i_chunk;
+    } /* if ... else */
+  } /* while */
+
+  gb_usb_txWriting = FALSE;
+
+  /*! A transfer may have completed while writing. */
+  INT_Disable();
+  loc_usb_txKick();
+  INT_Enable();
 
   return i;
 } /* sf_hal_uart_write() */
@@ -405,32 +586,29 @@ uint16_t wmbus_hal_uart_write(uint8_t *pc_data, uint16_t i_len)
 /*============================================================================*/
 uint16_t wmbus_hal_uart_read(uint8_t *pc_data, uint16_t i_len)
 {
-  uint16_t i = 0x00;
+  uint16_t i;
 
-  if (i_len < UART_BUFFER_RX_LEN)
+  /*! Read from Rx-ringbuffer until i_len or all received bytes are read. */
+  for(i = 0U; (i < i_len) && (i < gi_uart_bufferRxLen); i++)
   {
-    if (i_len <= wmbus_hal_uart_cntRxBytes())
-    {
-      /*! Read from Rx-ringbuffer until i_len or UART_BUFFER_RX_LEN is reached. */
-      for(i = 0U; (i < i_len) ; i++)
-      {
-        /*! Write to the specified data pointer and increase the read pointer. */
-        pc_data[i] = *gpc_uart_bufferRxRead;
-        *gpc_uart_bufferRxRead = 0xff;
-        gpc_uart_bufferRxRead++;
-
-        /*! Check for an overflow of the read pointer and adjust if required. */
-        if(gpc_uart_bufferRxRead == &gc_uart_bufferRx[UART_BUFFER_RX_LEN])
-        {
-          gpc_uart_bufferRxRead = gc_uart_bufferRx;
-        } /* if(gpc_uart_bufferRxRead == &gc_uart_bufferRx[UART_BUFFER_RX_LEN])*/
-      } /* for() */
-    } /* if (i_len <= (stzedn_uart_cntRxBytes()) */
-    else
+    pc_data[i] = gc_uart_bufferRx[gi_uart_bufferRxRead++];
+    if(gi_uart_bufferRxRead == UART_BUFFER_RX_LEN)
     {
-      i = 0x00;
-    }
-  } /* if (i_len < UART_BUFFER_RX_LEN) */
+      gi_uart_bufferRxRead = 0U;
+    } /* if */
+  } /* for */
+
+  INT_Disable();
+  gi_uart_bufferRxLen -= i;
+  /*! Continue reading from the host as soon as a packet fits again. */
+  if((gb_usb_rxPaused == TRUE) &&
+     ((UART_BUFFER_RX_LEN - gi_uart_bufferRxLen) >= USB_RX_BUF_SIZ))
+  {
+    gb_usb_rxPaused = FALSE;
+    loc_usb_rxStart();
+  } /* if */
+  INT_Enable();
+
   return i;
 } /* sf_hal_uart_read() */
 
@@ -439,21 +617,7 @@ uint16_t wmbus_hal_uart_read(uint8_t *pc_data, uint16_t i_len)
 /*============================================================================*/
 uint16_t wmbus_hal_uart_cntRxBytes(void)
 {
-  uint16_t i_cnt;
-
-  if (gpc_uart_bufferRxWrite > gpc_uart_bufferRxRead)
-    i_cnt = gpc_uart_bufferRxWrite - gpc_uart_bufferRxRead;
-  else if(gpc_uart_bufferRxWrite < gpc_uart_bufferRxRead)
-  {
-    i_cnt = &gc_uart_bufferRx[UART_BUFFER_RX_LEN] - gpc_uart_bufferRxRead;
-    i_cnt +=  gpc_uart_bufferRxWrite - gc_uart_bufferRx;
-  }
-  else
-  {
-    i_cnt = 0x00;
-  }
-
-  return i_cnt;
+  return gi_uart_bufferRxLen;
 } /* sf_hal_uart_cntRxBytes() */
 
 /*============================================================================*/
@@ -461,8 +625,18 @@ uint16_t wmbus_hal_uart_cntRxBytes(void)
 /*============================================================================*/
 uint16_t wmbus_hal_uart_cntTxBytes(void)
 {
-  /* Not needed for the usb interface */
-  return 0x00;
+  uint16_t i_cnt;
+
+  INT_Disable();
+  i_cnt = (USB_TX_BUF_SIZ - gai_usb_txLen[gc_usb_txFill]);
+  /* The other buffer is empty if it is not transferred. */
+  if(gb_usb_txBusy == FALSE)
+  {
+    i_cnt += USB_TX_BUF_SIZ;
+  } /* if */
+  INT_Enable();
+
+  return i_cnt;
 } /* wmbus_hal_uart_cntTxBytes() */
 
 /*============================================================================*/
@@ -471,7 +645,7 @@ uint16_t wmbus_hal_uart_cntTxBytes(void)
 bool_t wmbus_hal_uart_isRxOverflow(void)
 {
   bool_t b_return = FALSE;
-  /* Not needed for the usb interface */
+  /* The host is stopped if the input buffer is full, there is no overflow. */
   return b_return;
 } /* wmbus_hal_uart_isRxOverflow() */
 
@@ -480,25 +654,12 @@ bool_t wmbus_hal_uart_isRxOverflow(void)
 /*============================================================================*/
 void wmbus_hal_uart_com_TxFinish(void)
 {
-  uint16_t i = 0x00U;
-
-  for(i=0; gi_uart_bufferTxLen > 0; ++i)
-  {
-    /* Write Tx data to an aligned buffer to send it out via USB */
-    gc_usb_Txbuffer[i] = *gpc_uart_bufferTxRead;
-    gpc_uart_bufferTxRead++;
-    /*! Decrease the number of bytes in ringbuffer. */
-    gi_uart_bufferTxLen--;
-
-    /*! Check for an overflow of the write pointer and adjust if required. */
-    if(gpc_uart_bufferTxRead == &gc_uart_bufferTx[USB_BUFFER_TX_LEN])
-    {
-      gpc_uart_bufferTxRead = gc_uart_bufferTx;
-    } /* if */
-  }/* for() */
-
-  /* Send out all pending data */
-  USBD_Write(CDC_EP_DATA_IN, (void*) gc_usb_Txbuffer, i, NULL);
+  /* Send out all pending data. If a transfer is running, the data is sent
+     as soon as it has completed. */
+  INT_Disable();
+  gb_usb_txFlush = TRUE;
+  loc_usb_txStart();
+  INT_Enable();
 
 } /* sf_hal_uart_com_TxFinish() */
 